@@ -3,6 +3,7 @@
 #include "Fingerprint.hpp"
 #include "../config/ConfigManager.hpp"
 #include "../core/hyprlock.hpp"
+#include "../core/StateEvents.hpp"
 #include "src/helpers/Log.hpp"
 
 #include <hyprlang.hpp>
@@ -81,13 +82,14 @@ static void unlockCallback(ASP<CTimer> self, void* data) {
 }
 
 void CAuth::enqueueUnlock() {
-    g_pHyprlock->addTimer(std::chrono::milliseconds(0), unlockCallback, nullptr);
+    g_pHyprlock->addTimer(std::chrono::milliseconds(0), unlockCallback, nullptr, false, TIMER_OWNER_AUTH);
 }
 
 static void passwordFailCallback(ASP<CTimer> self, void* data) {
     g_pAuth->m_bDisplayFailText = true;
 
-    g_pHyprlock->enqueueForceUpdateTimers();
+    g_pStateEvents->publish(STATE_EVENT_ATTEMPTS);
+    g_pStateEvents->publish(STATE_EVENT_FAIL);
 
     g_pHyprlock->renderAllOutputs();
 }
@@ -113,8 +115,8 @@ void CAuth::enqueueFail(const std::string& failText, eAuthImplementations implTy
         m_resetDisplayFailTimer.reset();
     }
 
-    g_pHyprlock->addTimer(std::chrono::milliseconds(0), passwordFailCallback, nullptr);
-    m_resetDisplayFailTimer = g_pHyprlock->addTimer(std::chrono::milliseconds(*FAILTIMEOUT), displayFailTimeoutCallback, nullptr);
+    g_pHyprlock->addTimer(std::chrono::milliseconds(0), passwordFailCallback, nullptr, false, TIMER_OWNER_AUTH);
+    m_resetDisplayFailTimer = g_pHyprlock->addTimer(std::chrono::milliseconds(*FAILTIMEOUT), displayFailTimeoutCallback, nullptr, false, TIMER_OWNER_AUTH);
 }
 
 void CAuth::resetDisplayFail() {
@@ -1,5 +1,6 @@
 #include "Fingerprint.hpp"
 #include "../core/hyprlock.hpp"
+#include "../core/StateEvents.hpp"
 #include "../helpers/Log.hpp"
 #include "../config/ConfigManager.hpp"
 
@@ -134,7 +135,7 @@ bool CFingerprint::createDeviceProxy() {
                 if (!isPresent)
                     return;
                 m_sPrompt = m_sFingerprintPresent;
-                g_pHyprlock->enqueueForceUpdateTimers();
+                g_pStateEvents->publish(STATE_EVENT_FPRINT_PROMPT);
             } catch (std::out_of_range& e) {}
         });
 
@@ -160,7 +161,8 @@ void CFingerprint::handleVerifyStatus(const std::string& result, bool done) {
             } else {
                 done                         = false;
                 static const auto RETRYDELAY = g_pConfigManager->getValue<Hyprlang::INT>("auth:fingerprint:retry_delay");
-                g_pHyprlock->addTimer(std::chrono::milliseconds(*RETRYDELAY), [](ASP<CTimer> self, void* data) { ((CFingerprint*)data)->startVerify(true); }, this);
+                g_pHyprlock->addTimer(std::chrono::milliseconds(*RETRYDELAY), [](ASP<CTimer> self, void* data) { ((CFingerprint*)data)->startVerify(true); }, this,
+                                      false, TIMER_OWNER_AUTH);
                 m_sFailureReason = "Fingerprint did not match";
             }
             break;
@@ -198,7 +200,7 @@ void CFingerprint::handleVerifyStatus(const std::string& result, bool done) {
     if (!authenticated && !retry)
         g_pAuth->enqueueFail(m_sFailureReason, AUTH_IMPL_FINGERPRINT);
     else if (retry)
-        g_pHyprlock->enqueueForceUpdateTimers();
+        g_pStateEvents->publish(STATE_EVENT_FPRINT_PROMPT);
 
     if (done || m_sDBUSState.abort)
         m_sDBUSState.done = true;
@@ -240,7 +242,8 @@ void CFingerprint::startVerify(bool isRetry) {
             } else
                 m_sPrompt = m_sFingerprintReady;
         }
-        g_pHyprlock->enqueueForceUpdateTimers();
+        g_pStateEvents->publish(STATE_EVENT_FPRINT_PROMPT);
+        g_pStateEvents->publish(STATE_EVENT_FAIL);
     });
 }
 
@@ -1,6 +1,7 @@
 #include "Pam.hpp"
 #include "../config/ConfigManager.hpp"
 #include "../core/hyprlock.hpp"
+#include "../core/StateEvents.hpp"
 #include "../helpers/Log.hpp"
 #include "../helpers/MiscFunctions.hpp"
 
@@ -31,7 +32,7 @@ int conv(int num_msg, const struct pam_message** msg, struct pam_response** resp
                 // When the prompt is the same as the last one, I guess our answer can be the same.
                 if (initialPrompt || PROMPTCHANGED) {
                     CONVERSATIONSTATE->prompt = PROMPT;
-                    g_pHyprlock->enqueueForceUpdateTimers();
+                    g_pStateEvents->publish(STATE_EVENT_PAM_PROMPT);
 
                     CONVERSATIONSTATE->waitForInput();
                 }
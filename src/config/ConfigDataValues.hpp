@@ -45,13 +45,17 @@ class CLayoutValueData : public ICustomConfigValueData {
         return P;
     }
 
-    Hyprutils::Math::Vector2D getAbsolute(const Hyprutils::Math::Vector2D& viewport) {
+    Hyprutils::Math::Vector2D getAbsolute(const Hyprutils::Math::Vector2D& viewport) const {
         return {
             (m_sIsRelative.x ? (m_vValues.x / 100) * viewport.x : m_vValues.x),
             (m_sIsRelative.y ? (m_vValues.y / 100) * viewport.y : m_vValues.y),
         };
     }
 
+    bool operator==(const CLayoutValueData& other) const {
+        return m_vValues == other.m_vValues && m_sIsRelative.x == other.m_sIsRelative.x && m_sIsRelative.y == other.m_sIsRelative.y;
+    }
+
     Hyprutils::Math::Vector2D m_vValues;
     struct {
         bool x = false;
@@ -6,6 +6,7 @@
 #include <hyprlang.hpp>
 #include <hyprutils/string/String.hpp>
 #include <hyprutils/path/Path.hpp>
+#include <algorithm>
 #include <filesystem>
 #include <glob.h>
 #include <cstring>
@@ -241,12 +242,18 @@ void CConfigManager::init() {
 #define CLICKABLE(name) m_config.addSpecialConfigValue(name, "onclick", Hyprlang::STRING{""});
 
     m_config.addConfigValue("general:text_trim", Hyprlang::INT{1});
+    m_config.addConfigValue("general:cmd_timeout", Hyprlang::INT{10000});
     m_config.addConfigValue("general:hide_cursor", Hyprlang::INT{0});
     m_config.addConfigValue("general:ignore_empty_input", Hyprlang::INT{0});
     m_config.addConfigValue("general:immediate_render", Hyprlang::INT{0});
     m_config.addConfigValue("general:fractional_scaling", Hyprlang::INT{2});
     m_config.addConfigValue("general:screencopy_mode", Hyprlang::INT{0});
+    m_config.addConfigValue("general:screencopy_scale", Hyprlang::FLOAT{0.5});
     m_config.addConfigValue("general:fail_timeout", Hyprlang::INT{2000});
+    m_config.addConfigValue("general:image_cache_size", Hyprlang::INT{256});
+    m_config.addConfigValue("general:vram_budget", Hyprlang::INT{256});
+    m_config.addConfigValue("general:frame_timeout", Hyprlang::INT{5000});
+    m_config.addConfigValue("general:auto_reload", Hyprlang::INT{1});
 
     m_config.addConfigValue("auth:pam:enabled", Hyprlang::INT{1});
     m_config.addConfigValue("auth:pam:module", Hyprlang::STRING{"hyprlock"});
@@ -384,173 +391,276 @@ void CConfigManager::init() {
 
     m_config.commence();
 
+    parse(true);
+
+#undef SHADOWABLE
+#undef CLICKABLE
+}
+
+bool CConfigManager::parse(bool tolerateErrors) {
+    const auto PREVIOUSPATHS = m_configPaths;
+    m_configPaths            = {m_configCurrentPath};
+
     auto result = m_config.parse();
 
-    if (result.error)
+    if (result.error) {
+        if (!tolerateErrors) {
+            Log::logger->log(Log::ERR, "Config has errors:\n{}\nKeeping the widgets of the last config that parsed", result.getError());
+            m_configPaths = PREVIOUSPATHS;
+            return false;
+        }
+
         Log::logger->log(Log::ERR, "Config has errors:\n{}\nProceeding ignoring faulty entries", result.getError());
+    }
 
-#undef SHADOWABLE
-#undef CLICKABLE
+    rebuildWidgetConfigs();
+    return true;
 }
 
-std::vector<CConfigManager::SWidgetConfig> CConfigManager::getWidgetConfigs() {
-    std::vector<CConfigManager::SWidgetConfig> result;
+bool CConfigManager::reload() {
+    // Usually the moment between an editor removing the file and writing the new one.
+    if (!std::filesystem::exists(m_configCurrentPath)) {
+        Log::logger->log(Log::WARN, "Config {} is gone, keeping the current one", m_configCurrentPath);
+        return false;
+    }
 
-#define SHADOWABLE(name)                                                                                                                                                           \
-    {"shadow_size", m_config.getSpecialConfigValue(name, "shadow_size", k.c_str())}, {"shadow_passes", m_config.getSpecialConfigValue(name, "shadow_passes", k.c_str())},          \
-        {"shadow_color", m_config.getSpecialConfigValue(name, "shadow_color", k.c_str())}, {"shadow_boost", m_config.getSpecialConfigValue(name, "shadow_boost", k.c_str())}
+    Log::logger->log(Log::INFO, "Reloading config {}", m_configCurrentPath);
+    // A half saved or broken edit must not take the input field off a locked screen.
+    return parse(false);
+}
 
-#define CLICKABLE(name)                                                                                                                                                            \
-    { "onclick", m_config.getSpecialConfigValue(name, "onclick", k.c_str()) }
+const std::vector<std::string>& CConfigManager::getConfigPaths() const {
+    return m_configPaths;
+}
 
-    //
-    auto keys = m_config.listKeysForSpecialCategory("background");
-    result.reserve(keys.size());
-    for (auto& k : keys) {
-        // clang-format off
-        result.push_back(CConfigManager::SWidgetConfig{
-            .type = "background",
-            .monitor = std::any_cast<Hyprlang::STRING>(m_config.getSpecialConfigValue("background", "monitor", k.c_str())),
-            .values = {
-                {"path", m_config.getSpecialConfigValue("background", "path", k.c_str())},
-                {"color", m_config.getSpecialConfigValue("background", "color", k.c_str())},
-                {"blur_size", m_config.getSpecialConfigValue("background", "blur_size", k.c_str())},
-                {"blur_passes", m_config.getSpecialConfigValue("background", "blur_passes", k.c_str())},
-                {"noise", m_config.getSpecialConfigValue("background", "noise", k.c_str())},
-                {"contrast", m_config.getSpecialConfigValue("background", "contrast", k.c_str())},
-                {"vibrancy", m_config.getSpecialConfigValue("background", "vibrancy", k.c_str())},
-                {"brightness", m_config.getSpecialConfigValue("background", "brightness", k.c_str())},
-                {"vibrancy_darkness", m_config.getSpecialConfigValue("background", "vibrancy_darkness", k.c_str())},
-                {"zindex", m_config.getSpecialConfigValue("background", "zindex", k.c_str())},
-                {"reload_time", m_config.getSpecialConfigValue("background", "reload_time", k.c_str())},
-                {"reload_cmd", m_config.getSpecialConfigValue("background", "reload_cmd", k.c_str())},
-                {"crossfade_time", m_config.getSpecialConfigValue("background", "crossfade_time", k.c_str())},
-            }
-        });
-        // clang-format on
+// Invalid values are logged and treated like none.
+static eHAlign parseHAlign(const std::string& halign) {
+    if (halign == "center")
+        return HALIGN_CENTER;
+    if (halign == "left")
+        return HALIGN_LEFT;
+    if (halign == "right")
+        return HALIGN_RIGHT;
+    if (halign != "none")
+        Log::logger->log(Log::ERR, "Config: invalid halign {}", halign);
+
+    return HALIGN_NONE;
+}
+
+static eVAlign parseVAlign(const std::string& valign) {
+    if (valign == "center")
+        return VALIGN_CENTER;
+    if (valign == "top")
+        return VALIGN_TOP;
+    if (valign == "bottom")
+        return VALIGN_BOTTOM;
+    if (valign != "none")
+        Log::logger->log(Log::ERR, "Config: invalid valign {}", valign);
+
+    return VALIGN_NONE;
+}
+
+static Hyprgraphics::CTextResource::eTextAlignmentMode parseTextAlign(const std::string& alignment) {
+    if (alignment == "center")
+        return Hyprgraphics::CTextResource::TEXT_ALIGN_CENTER;
+    if (alignment == "right")
+        return Hyprgraphics::CTextResource::TEXT_ALIGN_RIGHT;
+
+    return Hyprgraphics::CTextResource::TEXT_ALIGN_LEFT;
+}
+
+// Typed lookups of the values in one widget section.
+struct SSectionReader {
+    Hyprlang::CConfig& config;
+    const char*        category;
+    const std::string& key;
+
+    std::any           raw(const char* name) const {
+        return config.getSpecialConfigValue(category, name, key.c_str());
     }
 
-    //
-    keys = m_config.listKeysForSpecialCategory("shape");
-    for (auto& k : keys) {
-        // clang-format off
-        result.push_back(CConfigManager::SWidgetConfig{
-            .type = "shape",
-            .monitor = std::any_cast<Hyprlang::STRING>(m_config.getSpecialConfigValue("shape", "monitor", k.c_str())),
-            .values = {
-                {"size", m_config.getSpecialConfigValue("shape", "size", k.c_str())},
-                {"rounding", m_config.getSpecialConfigValue("shape", "rounding", k.c_str())},
-                {"border_size", m_config.getSpecialConfigValue("shape", "border_size", k.c_str())},
-                {"border_color", m_config.getSpecialConfigValue("shape", "border_color", k.c_str())},
-                {"color", m_config.getSpecialConfigValue("shape", "color", k.c_str())},
-                {"position", m_config.getSpecialConfigValue("shape", "position", k.c_str())},
-                {"halign", m_config.getSpecialConfigValue("shape", "halign", k.c_str())},
-                {"valign", m_config.getSpecialConfigValue("shape", "valign", k.c_str())},
-                {"rotate", m_config.getSpecialConfigValue("shape", "rotate", k.c_str())},
-                {"xray", m_config.getSpecialConfigValue("shape", "xray", k.c_str())},
-                {"zindex", m_config.getSpecialConfigValue("shape", "zindex", k.c_str())},
-                SHADOWABLE("shape"),
-                CLICKABLE("shape"),
-            }
-        });
-        // clang-format on
+    Hyprlang::INT integer(const char* name) const {
+        return std::any_cast<Hyprlang::INT>(raw(name));
     }
 
-    //
-    keys = m_config.listKeysForSpecialCategory("image");
-    for (auto& k : keys) {
-        // clang-format off
-        result.push_back(CConfigManager::SWidgetConfig{
-            .type = "image",
-            .monitor = std::any_cast<Hyprlang::STRING>(m_config.getSpecialConfigValue("image", "monitor", k.c_str())),
-            .values = {
-                {"path", m_config.getSpecialConfigValue("image", "path", k.c_str())},
-                {"size", m_config.getSpecialConfigValue("image", "size", k.c_str())},
-                {"rounding", m_config.getSpecialConfigValue("image", "rounding", k.c_str())},
-                {"border_size", m_config.getSpecialConfigValue("image", "border_size", k.c_str())},
-                {"border_color", m_config.getSpecialConfigValue("image", "border_color", k.c_str())},
-                {"position", m_config.getSpecialConfigValue("image", "position", k.c_str())},
-                {"halign", m_config.getSpecialConfigValue("image", "halign", k.c_str())},
-                {"valign", m_config.getSpecialConfigValue("image", "valign", k.c_str())},
-                {"rotate", m_config.getSpecialConfigValue("image", "rotate", k.c_str())},
-                {"reload_time", m_config.getSpecialConfigValue("image", "reload_time", k.c_str())},
-                {"reload_cmd", m_config.getSpecialConfigValue("image", "reload_cmd", k.c_str())},
-                {"zindex", m_config.getSpecialConfigValue("image", "zindex", k.c_str())},
-                SHADOWABLE("image"),
-                CLICKABLE("image"),
-            }
-        });
-        // clang-format on
+    float number(const char* name) const {
+        return std::any_cast<Hyprlang::FLOAT>(raw(name));
     }
 
-    keys = m_config.listKeysForSpecialCategory("input-field");
-    for (auto& k : keys) {
-        // clang-format off
-        result.push_back(CConfigManager::SWidgetConfig{
-            .type = "input-field",
-            .monitor = std::any_cast<Hyprlang::STRING>(m_config.getSpecialConfigValue("input-field", "monitor", k.c_str())),
-            .values = {
-                {"size", m_config.getSpecialConfigValue("input-field", "size", k.c_str())},
-                {"inner_color", m_config.getSpecialConfigValue("input-field", "inner_color", k.c_str())},
-                {"outer_color", m_config.getSpecialConfigValue("input-field", "outer_color", k.c_str())},
-                {"outline_thickness", m_config.getSpecialConfigValue("input-field", "outline_thickness", k.c_str())},
-                {"dots_size", m_config.getSpecialConfigValue("input-field", "dots_size", k.c_str())},
-                {"dots_spacing", m_config.getSpecialConfigValue("input-field", "dots_spacing", k.c_str())},
-                {"dots_center", m_config.getSpecialConfigValue("input-field", "dots_center", k.c_str())},
-                {"dots_rounding", m_config.getSpecialConfigValue("input-field", "dots_rounding", k.c_str())},
-                {"dots_text_format", m_config.getSpecialConfigValue("input-field", "dots_text_format", k.c_str())},
-                {"fade_on_empty", m_config.getSpecialConfigValue("input-field", "fade_on_empty", k.c_str())},
-                {"fade_timeout", m_config.getSpecialConfigValue("input-field", "fade_timeout", k.c_str())},
-                {"font_color", m_config.getSpecialConfigValue("input-field", "font_color", k.c_str())},
-                {"font_family", m_config.getSpecialConfigValue("input-field", "font_family", k.c_str())},
-                {"halign", m_config.getSpecialConfigValue("input-field", "halign", k.c_str())},
-                {"valign", m_config.getSpecialConfigValue("input-field", "valign", k.c_str())},
-                {"position", m_config.getSpecialConfigValue("input-field", "position", k.c_str())},
-                {"placeholder_text", m_config.getSpecialConfigValue("input-field", "placeholder_text", k.c_str())},
-                {"hide_input", m_config.getSpecialConfigValue("input-field", "hide_input", k.c_str())},
-                {"hide_input_base_color", m_config.getSpecialConfigValue("input-field", "hide_input_base_color", k.c_str())},
-                {"rounding", m_config.getSpecialConfigValue("input-field", "rounding", k.c_str())},
-                {"check_color", m_config.getSpecialConfigValue("input-field", "check_color", k.c_str())},
-                {"fail_color", m_config.getSpecialConfigValue("input-field", "fail_color", k.c_str())},
-                {"fail_text", m_config.getSpecialConfigValue("input-field", "fail_text", k.c_str())},
-                {"check_text", m_config.getSpecialConfigValue("input-field", "check_text", k.c_str())},
-                {"capslock_color", m_config.getSpecialConfigValue("input-field", "capslock_color", k.c_str())},
-                {"numlock_color", m_config.getSpecialConfigValue("input-field", "numlock_color", k.c_str())},
-                {"bothlock_color", m_config.getSpecialConfigValue("input-field", "bothlock_color", k.c_str())},
-                {"invert_numlock", m_config.getSpecialConfigValue("input-field", "invert_numlock", k.c_str())},
-                {"swap_font_color", m_config.getSpecialConfigValue("input-field", "swap_font_color", k.c_str())},
-                {"zindex", m_config.getSpecialConfigValue("input-field", "zindex", k.c_str())},
-                SHADOWABLE("input-field"),
-            }
-        });
-        // clang-format on
+    std::string string(const char* name) const {
+        return std::any_cast<Hyprlang::STRING>(raw(name));
     }
 
-    keys = m_config.listKeysForSpecialCategory("label");
-    for (auto& k : keys) {
-        // clang-format off
-        result.push_back(CConfigManager::SWidgetConfig{
-            .type = "label",
-            .monitor = std::any_cast<Hyprlang::STRING>(m_config.getSpecialConfigValue("label", "monitor", k.c_str())),
-            .values = {
-                {"position", m_config.getSpecialConfigValue("label", "position", k.c_str())},
-                {"color", m_config.getSpecialConfigValue("label", "color", k.c_str())},
-                {"font_size", m_config.getSpecialConfigValue("label", "font_size", k.c_str())},
-                {"font_family", m_config.getSpecialConfigValue("label", "font_family", k.c_str())},
-                {"text", m_config.getSpecialConfigValue("label", "text", k.c_str())},
-                {"halign", m_config.getSpecialConfigValue("label", "halign", k.c_str())},
-                {"valign", m_config.getSpecialConfigValue("label", "valign", k.c_str())},
-                {"rotate", m_config.getSpecialConfigValue("label", "rotate", k.c_str())},
-                {"text_align", m_config.getSpecialConfigValue("label", "text_align", k.c_str())},
-                {"zindex", m_config.getSpecialConfigValue("label", "zindex", k.c_str())},
-                SHADOWABLE("label"),
-                CLICKABLE("label"),
-            }
-        });
-        // clang-format on
+    CLayoutValueData layout(const char* name) const {
+        return *CLayoutValueData::fromAnyPv(raw(name));
     }
 
-    return result;
+    CGradientValueData gradient(const char* name) const {
+        return *CGradientValueData::fromAnyPv(raw(name));
+    }
+
+    SShadowConfig shadow() const {
+        return SShadowConfig{
+            .size   = (int)integer("shadow_size"),
+            .passes = (int)integer("shadow_passes"),
+            .color  = integer("shadow_color"),
+            .boost  = number("shadow_boost"),
+        };
+    }
+};
+
+const std::vector<SWidgetConfig>& CConfigManager::getWidgetConfigs() const {
+    return m_widgetConfigs;
+}
+
+void CConfigManager::rebuildWidgetConfigs() {
+    m_widgetConfigs.clear();
+
+    try {
+        for (const auto& k : m_config.listKeysForSpecialCategory("background")) {
+            const SSectionReader IN{.config = m_config, .category = "background", .key = k};
+            // clang-format off
+            m_widgetConfigs.push_back(SWidgetConfig{
+                .monitor = IN.string("monitor"),
+                .zindex = IN.integer("zindex"),
+                .values = SBackgroundConfig{
+                    .path = IN.string("path"),
+                    .color = IN.integer("color"),
+                    .blurSize = (int)IN.integer("blur_size"),
+                    .blurPasses = (int)IN.integer("blur_passes"),
+                    .noise = IN.number("noise"),
+                    .contrast = IN.number("contrast"),
+                    .brightness = IN.number("brightness"),
+                    .vibrancy = IN.number("vibrancy"),
+                    .vibrancyDarkness = IN.number("vibrancy_darkness"),
+                    .reloadTime = (int)IN.integer("reload_time"),
+                    .reloadCommand = IN.string("reload_cmd"),
+                    .crossfadeTime = IN.number("crossfade_time"),
+                },
+            });
+            // clang-format on
+        }
+
+        for (const auto& k : m_config.listKeysForSpecialCategory("shape")) {
+            const SSectionReader IN{.config = m_config, .category = "shape", .key = k};
+            // clang-format off
+            m_widgetConfigs.push_back(SWidgetConfig{
+                .monitor = IN.string("monitor"),
+                .zindex = IN.integer("zindex"),
+                .values = SShapeConfig{
+                    .size = IN.layout("size"),
+                    .rounding = (int)IN.integer("rounding"),
+                    .border = (int)IN.integer("border_size"),
+                    .borderColor = IN.gradient("border_color"),
+                    .color = IN.integer("color"),
+                    .position = IN.layout("position"),
+                    .halign = parseHAlign(IN.string("halign")),
+                    .valign = parseVAlign(IN.string("valign")),
+                    .rotate = IN.number("rotate"),
+                    .xray = IN.integer("xray") != 0,
+                    .shadow = IN.shadow(),
+                    .onclick = IN.string("onclick"),
+                },
+            });
+            // clang-format on
+        }
+
+        for (const auto& k : m_config.listKeysForSpecialCategory("image")) {
+            const SSectionReader IN{.config = m_config, .category = "image", .key = k};
+            // clang-format off
+            m_widgetConfigs.push_back(SWidgetConfig{
+                .monitor = IN.string("monitor"),
+                .zindex = IN.integer("zindex"),
+                .values = SImageConfig{
+                    .path = IN.string("path"),
+                    .size = (int)IN.integer("size"),
+                    .rounding = (int)IN.integer("rounding"),
+                    .border = (int)IN.integer("border_size"),
+                    .borderColor = IN.gradient("border_color"),
+                    .position = IN.layout("position"),
+                    .halign = parseHAlign(IN.string("halign")),
+                    .valign = parseVAlign(IN.string("valign")),
+                    .rotate = IN.number("rotate"),
+                    .reloadTime = (int)IN.integer("reload_time"),
+                    .reloadCommand = IN.string("reload_cmd"),
+                    .shadow = IN.shadow(),
+                    .onclick = IN.string("onclick"),
+                },
+            });
+            // clang-format on
+        }
+
+        for (const auto& k : m_config.listKeysForSpecialCategory("input-field")) {
+            const SSectionReader IN{.config = m_config, .category = "input-field", .key = k};
+            // clang-format off
+            m_widgetConfigs.push_back(SWidgetConfig{
+                .monitor = IN.string("monitor"),
+                .zindex = IN.integer("zindex"),
+                .values = SInputFieldConfig{
+                    .size = IN.layout("size"),
+                    .innerColor = IN.integer("inner_color"),
+                    .outerColor = IN.gradient("outer_color"),
+                    .outlineThickness = (int)IN.integer("outline_thickness"),
+                    .dotsSize = IN.number("dots_size"),
+                    .dotsSpacing = IN.number("dots_spacing"),
+                    .dotsCenter = IN.integer("dots_center") != 0,
+                    .dotsRounding = (int)IN.integer("dots_rounding"),
+                    .dotsTextFormat = IN.string("dots_text_format"),
+                    .fadeOnEmpty = IN.integer("fade_on_empty") != 0,
+                    .fadeTimeout = (int)IN.integer("fade_timeout"),
+                    .fontColor = IN.integer("font_color"),
+                    .fontFamily = IN.string("font_family"),
+                    .halign = parseHAlign(IN.string("halign")),
+                    .valign = parseVAlign(IN.string("valign")),
+                    .position = IN.layout("position"),
+                    .placeholderText = IN.string("placeholder_text"),
+                    .hideInput = IN.integer("hide_input") != 0,
+                    .hideInputBaseColor = IN.integer("hide_input_base_color"),
+                    .rounding = (int)IN.integer("rounding"),
+                    .checkColor = IN.gradient("check_color"),
+                    .failColor = IN.gradient("fail_color"),
+                    .failText = IN.string("fail_text"),
+                    .checkText = IN.string("check_text"),
+                    .capslockColor = IN.gradient("capslock_color"),
+                    .numlockColor = IN.gradient("numlock_color"),
+                    .bothlockColor = IN.gradient("bothlock_color"),
+                    .invertNumlock = IN.integer("invert_numlock") != 0,
+                    .swapFontColor = IN.integer("swap_font_color") != 0,
+                    .shadow = IN.shadow(),
+                },
+            });
+            // clang-format on
+        }
+
+        for (const auto& k : m_config.listKeysForSpecialCategory("label")) {
+            const SSectionReader IN{.config = m_config, .category = "label", .key = k};
+            const auto           TEXTALIGN = IN.string("text_align");
+            // clang-format off
+            m_widgetConfigs.push_back(SWidgetConfig{
+                .monitor = IN.string("monitor"),
+                .zindex = IN.integer("zindex"),
+                .values = SLabelConfig{
+                    .position = IN.layout("position"),
+                    .color = IN.integer("color"),
+                    .fontSize = (int)IN.integer("font_size"),
+                    .fontFamily = IN.string("font_family"),
+                    .text = IN.string("text"),
+                    .halign = parseHAlign(IN.string("halign")),
+                    .valign = parseVAlign(IN.string("valign")),
+                    .rotate = IN.number("rotate"),
+                    .textAlign = TEXTALIGN.empty() ? std::nullopt : std::optional{parseTextAlign(TEXTALIGN)},
+                    .shadow = IN.shadow(),
+                    .onclick = IN.string("onclick"),
+                },
+            });
+            // clang-format on
+        }
+    } catch (const std::bad_any_cast& e) {
+        RASSERT(false, "Failed to parse widget configs: {}", e.what()); //
+    }
+
+    // Drawn in this order, a stable sort keeps the order of the config within a layer.
+    std::ranges::stable_sort(m_widgetConfigs, [](const SWidgetConfig& a, const SWidgetConfig& b) { return a.zindex < b.zindex; });
 }
 
 std::optional<std::string> CConfigManager::handleSource(const std::string& command, const std::string& rawpath) {
@@ -587,6 +697,8 @@ std::optional<std::string> CConfigManager::handleSource(const std::string& comma
             return "source file " + PATH + " doesn't exist!";
         }
 
+        m_configPaths.emplace_back(PATH);
+
         // allow for nested config parsing
         auto backupConfigPath = m_configCurrentPath;
         m_configCurrentPath   = PATH;
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "../defines.hpp"
+#include "WidgetConfig.hpp"
 
 class CConfigManager {
   public:
@@ -22,14 +23,13 @@ class CConfigManager {
         return Hyprlang::CSimpleConfigValue<T>(&m_config, name.c_str());
     }
 
-    struct SWidgetConfig {
-        std::string                               type;
-        std::string                               monitor;
+    // Parses the config files again. False if the config is gone or has errors, the current widgets stay then.
+    bool                                       reload();
+    // The config and every file it sourced in the last parse.
+    const std::vector<std::string>&            getConfigPaths() const;
 
-        std::unordered_map<std::string, std::any> values;
-    };
-
-    std::vector<SWidgetConfig>                 getWidgetConfigs();
+    // Parsed once per config load, ordered by zindex.
+    const std::vector<SWidgetConfig>&          getWidgetConfigs() const;
 
     std::optional<std::string>                 handleSource(const std::string&, const std::string&);
     std::optional<std::string>                 handleBezier(const std::string&, const std::string&);
@@ -40,7 +40,13 @@ class CConfigManager {
     Hyprutils::Animation::CAnimationConfigTree m_AnimationTree;
 
   private:
-    Hyprlang::CConfig m_config;
+    // Faulty entries are skipped with tolerateErrors, otherwise a config with errors leaves the widget configs alone and returns false.
+    bool                       parse(bool tolerateErrors);
+    void                       rebuildWidgetConfigs();
+
+    Hyprlang::CConfig          m_config;
+    std::vector<std::string>   m_configPaths;
+    std::vector<SWidgetConfig> m_widgetConfigs;
 };
 
 inline UP<CConfigManager> g_pConfigManager;
@@ -0,0 +1,97 @@
+#include "ConfigWatcher.hpp"
+#include "../helpers/Log.hpp"
+#include "../core/hyprlock.hpp"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+using namespace Hyprutils::OS;
+
+// Editors write a file in several steps, the reload waits for them to finish.
+static const auto RELOADDELAY = std::chrono::milliseconds(200);
+
+CConfigWatcher::CConfigWatcher() {
+    m_inotify = CFileDescriptor{inotify_init1(IN_CLOEXEC | IN_NONBLOCK)};
+    if (!m_inotify.isValid())
+        Log::logger->log(Log::ERR, "Failed to create an inotify fd, config changes won't be reloaded");
+}
+
+CConfigWatcher::~CConfigWatcher() {
+    if (m_reloadTimer)
+        m_reloadTimer->cancel();
+}
+
+void CConfigWatcher::setPaths(const std::vector<std::string>& paths) {
+    if (!m_inotify.isValid())
+        return;
+
+    m_files.clear();
+
+    std::unordered_map<int, std::filesystem::path> dirs;
+    for (const auto& path : paths) {
+        // A symlinked config changes where the link points to.
+        std::error_code ec;
+        for (const auto& file : {std::filesystem::path{path}.lexically_normal(), std::filesystem::weakly_canonical(path, ec)}) {
+            if (file.empty())
+                continue;
+
+            m_files.emplace(file.string());
+
+            // Adding a directory again returns the descriptor it already has.
+            const int WD = inotify_add_watch(m_inotify.get(), file.parent_path().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (WD < 0) {
+                Log::logger->log(Log::WARN, "Failed to watch {} for config changes", file.parent_path().string());
+                continue;
+            }
+
+            dirs.emplace(WD, file.parent_path());
+        }
+    }
+
+    for (const auto& [wd, dir] : m_dirs) {
+        if (!dirs.contains(wd))
+            inotify_rm_watch(m_inotify.get(), wd);
+    }
+
+    m_dirs = std::move(dirs);
+}
+
+int CConfigWatcher::getFD() const {
+    return m_inotify.get();
+}
+
+void CConfigWatcher::dispatch() {
+    alignas(inotify_event) char buf[4096];
+    bool                        changed = false;
+
+    while (true) {
+        const auto LEN = ::read(m_inotify.get(), buf, sizeof(buf));
+        if (LEN <= 0)
+            break;
+
+        for (ssize_t off = 0; off < LEN;) {
+            const auto* EVENT = reinterpret_cast<const inotify_event*>(buf + off);
+            off += sizeof(inotify_event) + EVENT->len;
+
+            const auto IT = m_dirs.find(EVENT->wd);
+            if (IT == m_dirs.end() || EVENT->len == 0)
+                continue;
+
+            changed = changed || m_files.contains((IT->second / EVENT->name).string());
+        }
+    }
+
+    if (!changed)
+        return;
+
+    if (m_reloadTimer)
+        m_reloadTimer->cancel();
+
+    m_reloadTimer = g_pHyprlock->addTimer(
+        RELOADDELAY,
+        [](auto, auto) {
+            if (g_pHyprlock)
+                g_pHyprlock->reloadConfig();
+        },
+        nullptr);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "../core/Timer.hpp"
+
+#include <hyprutils/os/FileDescriptor.hpp>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Reloads the config when it or a file it sources changes.
+// The directories are watched, editors often replace a file instead of writing to it.
+class CConfigWatcher {
+  public:
+    CConfigWatcher();
+    ~CConfigWatcher();
+
+    // Replaces the watched files.
+    void setPaths(const std::vector<std::string>& paths);
+
+    // Readable when something changed in a watched directory. Part of the main poll set.
+    int  getFD() const;
+    // Reads the pending events without blocking and plans a reload if a watched file changed.
+    void dispatch();
+
+  private:
+    Hyprutils::OS::CFileDescriptor                 m_inotify;
+    std::unordered_map<int, std::filesystem::path> m_dirs; // by watch descriptor
+    std::unordered_set<std::string>                m_files;
+    ASP<CTimer>                                    m_reloadTimer;
+};
+
+inline UP<CConfigWatcher> g_pConfigWatcher;
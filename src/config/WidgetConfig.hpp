@@ -0,0 +1,146 @@
+#pragma once
+
+#include "ConfigDataValues.hpp"
+#include "../helpers/Color.hpp"
+
+#include <hyprgraphics/resource/resources/TextResource.hpp>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <variant>
+
+enum eHAlign : uint8_t {
+    HALIGN_CENTER = 0,
+    HALIGN_LEFT,
+    HALIGN_RIGHT,
+    HALIGN_NONE,
+};
+
+enum eVAlign : uint8_t {
+    VALIGN_CENTER = 0,
+    VALIGN_TOP,
+    VALIGN_BOTTOM,
+    VALIGN_NONE,
+};
+
+struct SShadowConfig {
+    int        size   = 0;
+    int        passes = 0;
+    CHyprColor color;
+    float      boost = 1.0;
+
+    bool       operator==(const SShadowConfig&) const = default;
+};
+
+struct SBackgroundConfig {
+    std::string path;
+    CHyprColor  color;
+    int         blurSize         = 0;
+    int         blurPasses       = 0;
+    float       noise            = 0;
+    float       contrast         = 0;
+    float       brightness       = 0;
+    float       vibrancy         = 0;
+    float       vibrancyDarkness = 0;
+    int         reloadTime       = -1;
+    std::string reloadCommand;
+    float       crossfadeTime = -1;
+
+    bool        operator==(const SBackgroundConfig&) const = default;
+};
+
+struct SShapeConfig {
+    CLayoutValueData   size;
+    int                rounding = 0;
+    int                border   = 0;
+    CGradientValueData borderColor;
+    CHyprColor         color;
+    CLayoutValueData   position;
+    eHAlign            halign = HALIGN_CENTER;
+    eVAlign            valign = VALIGN_CENTER;
+    float              rotate = 0; // degrees
+    bool               xray   = false;
+    SShadowConfig      shadow;
+    std::string        onclick;
+
+    bool               operator==(const SShapeConfig&) const = default;
+};
+
+struct SImageConfig {
+    std::string        path;
+    int                size     = 0;
+    int                rounding = -1;
+    int                border   = 0;
+    CGradientValueData borderColor;
+    CLayoutValueData   position;
+    eHAlign            halign     = HALIGN_CENTER;
+    eVAlign            valign     = VALIGN_CENTER;
+    float              rotate     = 0; // degrees
+    int                reloadTime = -1;
+    std::string        reloadCommand;
+    SShadowConfig      shadow;
+    std::string        onclick;
+
+    bool               operator==(const SImageConfig&) const = default;
+};
+
+struct SInputFieldConfig {
+    CLayoutValueData   size;
+    CHyprColor         innerColor;
+    CGradientValueData outerColor;
+    int                outlineThickness = 0;
+    float              dotsSize         = 0;
+    float              dotsSpacing      = 0;
+    bool               dotsCenter       = false;
+    int                dotsRounding     = -1;
+    std::string        dotsTextFormat;
+    bool               fadeOnEmpty = false;
+    int                fadeTimeout = 0;
+    CHyprColor         fontColor;
+    std::string        fontFamily;
+    eHAlign            halign = HALIGN_CENTER;
+    eVAlign            valign = VALIGN_CENTER;
+    CLayoutValueData   position;
+    std::string        placeholderText;
+    bool               hideInput = false;
+    CHyprColor         hideInputBaseColor;
+    int                rounding = -1;
+    CGradientValueData checkColor;
+    CGradientValueData failColor;
+    std::string        failText;
+    std::string        checkText;
+    CGradientValueData capslockColor;
+    CGradientValueData numlockColor;
+    CGradientValueData bothlockColor;
+    bool               invertNumlock = false;
+    bool               swapFontColor = false;
+    SShadowConfig      shadow;
+
+    bool               operator==(const SInputFieldConfig&) const = default;
+};
+
+struct SLabelConfig {
+    CLayoutValueData                                               position;
+    CHyprColor                                                     color;
+    int                                                            fontSize = 16;
+    std::string                                                    fontFamily;
+    std::string                                                    text;
+    eHAlign                                                        halign = HALIGN_CENTER;
+    eVAlign                                                        valign = VALIGN_CENTER;
+    float                                                          rotate = 0; // degrees
+    std::optional<Hyprgraphics::CTextResource::eTextAlignmentMode> textAlign;  // unset leaves the default of the text resource
+    SShadowConfig                                                  shadow;
+    std::string                                                    onclick;
+
+    bool                                                           operator==(const SLabelConfig&) const = default;
+};
+
+// One widget section of the config, parsed once per config load.
+struct SWidgetConfig {
+    std::string                                                                                  monitor;
+    int64_t                                                                                      zindex = 0;
+
+    std::variant<SBackgroundConfig, SShapeConfig, SImageConfig, SInputFieldConfig, SLabelConfig> values;
+
+    bool                                                                                         operator==(const SWidgetConfig&) const = default;
+};
@@ -115,6 +115,14 @@ EGLSurface CEGL::createPlatformWindowSurfaceEXT(wl_egl_window* eglWindow) {
     return eglSurface;
 }
 
+EGLContext CEGL::createSharedContext() {
+    EGLContext ctx = eglCreateContext(eglDisplay, eglConfig, eglContext, context_attribs);
+    if (ctx == EGL_NO_CONTEXT)
+        Log::logger->log(Log::ERR, "Failed to create a shared egl context, error: {}", eglErrorToString(eglGetError()));
+
+    return ctx;
+}
+
 void CEGL::makeCurrent(EGLSurface surf) {
     if (eglMakeCurrent(eglDisplay, surf, surf, eglContext) == EGL_FALSE)
         Log::logger->log(Log::ERR, "Failed to eglMakeCurrent, error:  {}", eglErrorToString(eglGetError()));
@@ -17,6 +17,8 @@ class CEGL {
 
     EGLSurface createPlatformWindowSurfaceEXT(wl_egl_window* eglWindow);
     void       makeCurrent(EGLSurface surf);
+    // Creates a context in the same share group as eglContext. Returns EGL_NO_CONTEXT on failure.
+    EGLContext createSharedContext();
     bool       swapBuffers(EGLSurface surf);
 
     bool       m_isNvidia = false;
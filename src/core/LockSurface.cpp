@@ -143,6 +143,7 @@ void CSessionLockSurface::render() {
 
         m_frames++;
 
+        g_pHyprlock->onFrameDone();
         onCallback();
     });
 
@@ -152,6 +153,9 @@ void CSessionLockSurface::render() {
         return;
     }
 
+    frameRequested = std::chrono::steady_clock::now();
+    g_pHyprlock->onFrameRequested();
+
     needsFrame = FEEDBACK.needsFrame || g_pAnimationManager->shouldTickForNext();
 }
 
@@ -167,3 +171,10 @@ void CSessionLockSurface::onCallback() {
 SP<CCWlSurface> CSessionLockSurface::getWlSurface() {
     return surface;
 }
+
+std::optional<std::chrono::steady_clock::time_point> CSessionLockSurface::frameRequestedAt() const {
+    if (!frameCallback)
+        return std::nullopt;
+
+    return frameRequested;
+}
@@ -8,6 +8,8 @@
 #include "../helpers/Math.hpp"
 #include <wayland-egl.h>
 #include <EGL/egl.h>
+#include <chrono>
+#include <optional>
 
 class COutput;
 class CRenderer;
@@ -28,6 +30,9 @@ class CSessionLockSurface {
     void            onScaleUpdate();
     SP<CCWlSurface> getWlSurface();
 
+    // When the pending frame callback was requested. Empty if there is none.
+    std::optional<std::chrono::steady_clock::time_point> frameRequestedAt() const;
+
   private:
     WP<COutput>                   m_outputRef;
     OUTPUTID                      m_outputID = OUTPUT_INVALID;
@@ -49,7 +54,8 @@ class CSessionLockSurface {
     uint32_t                      m_frames        = 0;
 
     // wayland callbacks
-    SP<CCWlCallback> frameCallback = nullptr;
+    SP<CCWlCallback>                      frameCallback = nullptr;
+    std::chrono::steady_clock::time_point frameRequested; // when frameCallback was requested
 
     friend class CRenderer;
     friend class COutput;
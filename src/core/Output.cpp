@@ -67,3 +67,7 @@ void COutput::createSessionLockSurface() {
 Vector2D COutput::getViewport() const {
     return (m_sessionLockSurface) ? m_sessionLockSurface->size : size;
 }
+
+bool COutput::matchesMonitor(const std::string& monitor) const {
+    return monitor.empty() || monitor == stringPort || stringDesc.starts_with(monitor) || ("desc:" + stringDesc).starts_with(monitor);
+}
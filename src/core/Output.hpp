@@ -30,4 +30,6 @@ class COutput {
     void                    createSessionLockSurface();
 
     Vector2D                getViewport() const;
+    // Whether a widget's monitor config value (port, description or "desc:" prefix) selects this output
+    bool                    matchesMonitor(const std::string& monitor) const;
 };
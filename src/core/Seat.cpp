@@ -1,5 +1,6 @@
 #include "Seat.hpp"
 #include "hyprlock.hpp"
+#include "StateEvents.hpp"
 #include "../helpers/Log.hpp"
 #include "../config/ConfigManager.hpp"
 #include <chrono>
@@ -141,12 +142,7 @@ void CSeatManager::registerSeat(SP<CCWlSeat> seat) {
 
                 if (group != g_pHyprlock->m_uiActiveLayout) {
                     g_pHyprlock->m_uiActiveLayout = group;
-                    for (auto& t : g_pHyprlock->getTimers()) {
-                        if (t->canForceUpdate()) {
-                            t->call(t);
-                            t->cancel();
-                        }
-                    }
+                    g_pStateEvents->publish(STATE_EVENT_LAYOUT);
                 }
 
                 xkb_state_update_mask(m_pXKBState, mods_depressed, mods_latched, mods_locked, 0, 0, group);
@@ -0,0 +1,52 @@
+#include "StateEvents.hpp"
+#include "hyprlock.hpp"
+
+#include <vector>
+
+uint64_t CStateEvents::subscribe(uint32_t events, callback_t cb) {
+    const auto TOKEN = ++m_lastToken;
+    m_subscribers.emplace(TOKEN, SSubscriber{.events = events, .cb = std::move(cb)});
+    return TOKEN;
+}
+
+void CStateEvents::unsubscribe(uint64_t token) {
+    m_subscribers.erase(token);
+}
+
+void CStateEvents::publish(eStateEvent event) {
+    std::lock_guard<std::mutex> lg(m_mutex);
+    m_pending |= 1 << event;
+
+    if (m_scheduled)
+        return;
+
+    m_scheduled = true;
+    g_pHyprlock->addTimer(
+        std::chrono::milliseconds(0),
+        [](auto, auto) {
+            if (g_pStateEvents)
+                g_pStateEvents->dispatch();
+        },
+        nullptr, false, TIMER_OWNER_LABEL);
+}
+
+void CStateEvents::dispatch() {
+    uint32_t pending = 0;
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        pending     = m_pending;
+        m_pending   = 0;
+        m_scheduled = false;
+    }
+
+    // Copied, subscribers may come and go while being called.
+    std::vector<callback_t> callbacks;
+    for (const auto& [token, subscriber] : m_subscribers) {
+        if (subscriber.events & pending)
+            callbacks.emplace_back(subscriber.cb);
+    }
+
+    for (const auto& cb : callbacks) {
+        cb();
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../defines.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+// Auth and seat state that label texts show.
+enum eStateEvent : uint8_t {
+    STATE_EVENT_ATTEMPTS = 0,  // $ATTEMPTS
+    STATE_EVENT_FAIL,          // $FAIL, $PAMFAIL, $FPRINTFAIL
+    STATE_EVENT_PAM_PROMPT,    // $PAMPROMPT
+    STATE_EVENT_FPRINT_PROMPT, // $FPRINTPROMPT
+    STATE_EVENT_LAYOUT,        // $LAYOUT
+};
+
+// Widgets subscribe to the state they show, the code that changes it publishes an event.
+class CStateEvents {
+  public:
+    typedef std::function<void()> callback_t;
+
+    // events is a mask of 1 << eStateEvent.
+    uint64_t subscribe(uint32_t events, callback_t cb);
+    void     unsubscribe(uint64_t token);
+
+    // Thread safe. Subscribers are called from the main loop, once for all events published until then.
+    void     publish(eStateEvent event);
+
+  private:
+    struct SSubscriber {
+        uint32_t   events = 0;
+        callback_t cb;
+    };
+
+    void                                      dispatch();
+
+    std::mutex                                m_mutex;
+    uint32_t                                  m_pending   = 0;
+    bool                                      m_scheduled = false;
+    std::unordered_map<uint64_t, SSubscriber> m_subscribers;
+    uint64_t                                  m_lastToken = 0;
+};
+
+inline UP<CStateEvents> g_pStateEvents = makeUnique<CStateEvents>();
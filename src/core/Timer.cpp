@@ -1,12 +1,12 @@
 #include "Timer.hpp"
 
-CTimer::CTimer(std::chrono::system_clock::duration timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data_, bool force) :
-    cb(cb_), data(data_), allowForceUpdate(force) {
-    expires = std::chrono::system_clock::now() + timeout;
+CTimer::CTimer(std::chrono::steady_clock::duration timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data_, bool force, eTimerOwner owner_) :
+    cb(cb_), data(data_), allowForceUpdate(force), timerOwner(owner_) {
+    expires = std::chrono::steady_clock::now() + timeout;
 }
 
 bool CTimer::passed() {
-    return std::chrono::system_clock::now() > expires;
+    return std::chrono::steady_clock::now() >= expires;
 }
 
 void CTimer::cancel() {
@@ -22,9 +22,17 @@ void CTimer::call(ASP<CTimer> self) {
 }
 
 float CTimer::leftMs() {
-    return std::chrono::duration_cast<std::chrono::milliseconds>(expires - std::chrono::system_clock::now()).count();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(expires - std::chrono::steady_clock::now()).count();
+}
+
+std::chrono::steady_clock::time_point CTimer::expiresAt() const {
+    return expires;
 }
 
 bool CTimer::canForceUpdate() {
     return allowForceUpdate;
 }
+
+eTimerOwner CTimer::owner() const {
+    return timerOwner;
+}
@@ -4,23 +4,40 @@
 #include <functional>
 #include "../defines.hpp"
 
+// What a timer is for, only used to account its callbacks in the event loop stats.
+enum eTimerOwner : uint8_t {
+    TIMER_OWNER_OTHER = 0,
+    TIMER_OWNER_LABEL,
+    TIMER_OWNER_IMAGE,
+    TIMER_OWNER_BACKGROUND,
+    TIMER_OWNER_KEYREPEAT,
+    TIMER_OWNER_AUTH,
+    TIMER_OWNER_RESOURCES, // results posted by the resource, upload and gl workers
+    TIMER_OWNER_STREAMS,
+    TIMER_OWNER_COUNT,
+};
+
+// Timers run on the monotonic clock. Wall clock changes, like NTP adjustments, don't move them.
 class CTimer {
   public:
-    CTimer(std::chrono::system_clock::duration timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data_, bool force);
+    CTimer(std::chrono::steady_clock::duration timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data_, bool force, eTimerOwner owner_ = TIMER_OWNER_OTHER);
 
-    void  cancel();
-    bool  passed();
-    bool  canForceUpdate();
+    void                                  cancel();
+    bool                                  passed();
+    bool                                  canForceUpdate();
+    eTimerOwner                           owner() const;
 
-    float leftMs();
+    float                                 leftMs();
+    std::chrono::steady_clock::time_point expiresAt() const;
 
-    bool  cancelled();
-    void  call(ASP<CTimer> self);
+    bool                                  cancelled();
+    void                                  call(ASP<CTimer> self);
 
   private:
     std::function<void(ASP<CTimer> self, void* data)> cb;
     void*                                             data = nullptr;
-    std::chrono::system_clock::time_point             expires;
+    std::chrono::steady_clock::time_point             expires;
     bool                                              wasCancelled     = false;
     bool                                              allowForceUpdate = false;
+    eTimerOwner                                       timerOwner       = TIMER_OWNER_OTHER;
 };
@@ -1,8 +1,13 @@
 #include "hyprlock.hpp"
 #include "../helpers/Log.hpp"
 #include "../config/ConfigManager.hpp"
+#include "../config/ConfigWatcher.hpp"
 #include "../renderer/Renderer.hpp"
 #include "../renderer/AsyncResourceManager.hpp"
+#include "../renderer/GLWorker.hpp"
+#include "../renderer/ImageCache.hpp"
+#include "../renderer/ScreencopyBufferPool.hpp"
+#include "../helpers/CommandStreams.hpp"
 #include "../auth/Auth.hpp"
 #include "../auth/Fingerprint.hpp"
 #include "./Egl.hpp"
@@ -10,7 +15,10 @@
 #include <chrono>
 #include <hyprutils/memory/UniquePtr.hpp>
 #include <sys/wait.h>
-#include <sys/poll.h>
+#include <sys/timerfd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <csignal>
@@ -25,6 +33,21 @@
 
 using namespace Hyprutils::OS;
 
+static constexpr std::array<const char*, LOOP_SOURCE_COUNT> LOOPSOURCENAMES = {"wayland", "timerfd", "wake", "signals", "stream commands", "dbus", "config watch"};
+static constexpr std::array<const char*, TIMER_OWNER_COUNT> TIMEROWNERNAMES = {"other", "label", "image", "background", "key repeat", "auth", "resources", "stream commands"};
+
+// Timers that only refresh what is shown. Paused while no output shows anything.
+static bool isPausedWhileAsleep(eTimerOwner owner) {
+    return owner == TIMER_OWNER_LABEL || owner == TIMER_OWNER_IMAGE || owner == TIMER_OWNER_BACKGROUND;
+}
+
+// Cpu time of the main thread, so that time spent blocked in the loop doesn't count.
+static std::chrono::nanoseconds threadCpuTime() {
+    timespec ts = {};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
 static void setMallocThreshold() {
 #ifdef M_TRIM_THRESHOLD
     // The default is 128 pages,
@@ -49,15 +72,34 @@ static bool screencopyRequired() {
         return true;
 
     const auto BGSCREENSHOT = std::ranges::any_of(g_pConfigManager->getWidgetConfigs(), [](const auto& w) { //
-        return w.type == "background" && std::string{std::any_cast<Hyprlang::STRING>(w.values.at("path"))} == "screenshot";
+        const auto* BACKGROUND = std::get_if<SBackgroundConfig>(&w.values);
+        return BACKGROUND && BACKGROUND->path == "screenshot";
     });
 
     return BGSCREENSHOT;
 }
 
+// Spawned processes should not inherit the blocked signals.
+static void unblockSignalsInChild() {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    sigaddset(&signals, SIGUSR2);
+    pthread_sigmask(SIG_UNBLOCK, &signals, nullptr);
+}
+
 CHyprlock::CHyprlock(std::string_view wlDisplay, const bool immediateRender, const int graceSeconds) : m_screencopyRequired(screencopyRequired()) {
     setMallocThreshold();
 
+    // The main loop reads SIGUSR1 and SIGUSR2 from a signalfd. That requires them to be blocked in every thread, before any thread starts.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    sigaddset(&signals, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    pthread_atfork(nullptr, nullptr, unblockSignalsInChild);
+    m_sLoopState.signalFd = CFileDescriptor{signalfd(-1, &signals, SFD_CLOEXEC | SFD_NONBLOCK)};
+
     m_sWaylandState.display = wl_display_connect(wlDisplay.empty() ? nullptr : std::string{wlDisplay}.c_str());
     RASSERT(m_sWaylandState.display, "Couldn't connect to a wayland compositor");
 
@@ -74,6 +116,10 @@ CHyprlock::CHyprlock(std::string_view wlDisplay, const bool immediateRender, con
     const auto CURRENTDESKTOP = getenv("XDG_CURRENT_DESKTOP");
     const auto SZCURRENTD     = std::string{CURRENTDESKTOP ? CURRENTDESKTOP : ""};
     m_sCurrentDesktop         = SZCURRENTD;
+
+    m_sLoopState.timerFd = CFileDescriptor{timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK)};
+    m_sLoopState.wakeFd  = CFileDescriptor{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
+    RASSERT(m_sLoopState.timerFd.isValid() && m_sLoopState.wakeFd.isValid(), "Couldn't create the event loop fds");
 }
 
 CHyprlock::~CHyprlock() {
@@ -81,36 +127,17 @@ CHyprlock::~CHyprlock() {
         gbm_device_destroy(dma.gbmDevice);
 }
 
-static void registerSignalAction(int sig, void (*handler)(int), int sa_flags = 0) {
-    struct sigaction sa;
-    sa.sa_handler = handler;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = sa_flags;
-    sigaction(sig, &sa, nullptr);
-}
-
-static void handleUnlockSignal(int sig) {
-    if (sig == SIGUSR1) {
-        Log::logger->log(Log::INFO, "Unlocking with a SIGUSR1");
-        g_pAuth->enqueueUnlock();
+void CHyprlock::handleSignals() {
+    signalfd_siginfo info;
+    while (read(m_sLoopState.signalFd.get(), &info, sizeof(info)) == sizeof(info)) {
+        if (info.ssi_signo == SIGUSR1) {
+            Log::logger->log(Log::INFO, "Unlocking with a SIGUSR1");
+            g_pAuth->enqueueUnlock();
+        } else if (info.ssi_signo == SIGUSR2)
+            enqueueForceUpdateTimers();
     }
 }
 
-static void handleForceUpdateSignal(int sig) {
-    if (sig == SIGUSR2) {
-        for (auto& t : g_pHyprlock->getTimers()) {
-            if (t->canForceUpdate()) {
-                t->call(t);
-                t->cancel();
-            }
-        }
-    }
-}
-
-static void handlePollTerminate(int sig) {
-    ;
-}
-
 static char* gbm_find_render_node(drmDevice* device) {
     drmDevice* devices[64];
     char*      render_node = nullptr;
@@ -348,10 +375,20 @@ void CHyprlock::run() {
     wl_display_roundtrip(m_sWaylandState.display);
 
     g_pRenderer            = makeUnique<CRenderer>();
+    g_pGLWorker            = makeUnique<CGLWorker>();
+    g_pImageCache          = makeUnique<CImageCache>();
+    g_pSCBufferPool        = makeUnique<CSCBufferPool>();
     g_asyncResourceManager = makeUnique<CAsyncResourceManager>();
+    g_pCommandStreams      = makeUnique<CCommandStreams>();
     g_pAuth                = makeUnique<CAuth>();
     g_pAuth->start();
 
+    static const auto AUTORELOAD = g_pConfigManager->getValue<Hyprlang::INT>("general:auto_reload");
+    if (*AUTORELOAD) {
+        g_pConfigWatcher = makeUnique<CConfigWatcher>();
+        g_pConfigWatcher->setPaths(g_pConfigManager->getConfigPaths());
+    }
+
     Log::logger->log(Log::INFO, "Running on {}", m_sCurrentDesktop);
 
     g_asyncResourceManager->enqueueStaticAssets();
@@ -368,8 +405,6 @@ void CHyprlock::run() {
 
     // Failed to lock the session
     if (!acquireSessionLock()) {
-        m_sLoopState.timerEvent = true;
-        m_sLoopState.timerCV.notify_all();
         g_pAuth->terminate();
         exit(1);
     }
@@ -377,133 +412,132 @@ void CHyprlock::run() {
     const auto fingerprintAuth = g_pAuth->getImpl(AUTH_IMPL_FINGERPRINT);
     const auto dbusConn        = (fingerprintAuth) ? ((CFingerprint*)fingerprintAuth.get())->getConnection() : nullptr;
 
-    registerSignalAction(SIGUSR1, handleUnlockSignal, SA_RESTART);
-    registerSignalAction(SIGUSR2, handleForceUpdateSignal);
-    registerSignalAction(SIGRTMIN, handlePollTerminate);
-
-    pollfd pollfds[2];
-    pollfds[0] = {
-        .fd     = wl_display_get_fd(m_sWaylandState.display),
-        .events = POLLIN,
-    };
-    if (dbusConn) {
-        pollfds[1] = {
-            .fd     = dbusConn->getEventLoopPollData().fd,
-            .events = POLLIN,
-        };
-    }
-    size_t      fdcount = dbusConn ? 2 : 1;
+    const auto DPY = m_sWaylandState.display;
 
-    std::thread pollThr([this, &pollfds, fdcount]() {
-        while (!m_bTerminate) {
-            bool preparedToRead = wl_display_prepare_read(m_sWaylandState.display) == 0;
+    const auto watch = [this](int fd, eLoopSource source) {
+        if (fd < 0)
+            return;
 
-            int  events = 0;
-            if (preparedToRead) {
-                events = poll(pollfds, fdcount, 5000);
+        epoll_event event = {.events = EPOLLIN, .data = {.u32 = source}};
+        RASSERT(epoll_ctl(m_sLoopState.epollFd.get(), EPOLL_CTL_ADD, fd, &event) == 0, "[core] Couldn't watch fd {} in the event loop", fd);
+    };
 
-                if (events < 0) {
-                    RASSERT(errno == EINTR, "[core] Polling fds failed with {}", errno);
-                    wl_display_cancel_read(m_sWaylandState.display);
-                    continue;
-                }
+    m_sLoopState.epollFd = CFileDescriptor{epoll_create1(EPOLL_CLOEXEC)};
+    RASSERT(m_sLoopState.epollFd.isValid(), "[core] Couldn't create the epoll fd");
 
-                for (size_t i = 0; i < fdcount; ++i) {
-                    RASSERT(!(pollfds[i].revents & POLLHUP), "[core] Disconnected from pollfd id {}", i);
-                }
+    watch(wl_display_get_fd(DPY), LOOP_SOURCE_WAYLAND);
+    watch(m_sLoopState.timerFd.get(), LOOP_SOURCE_TIMER);
+    watch(m_sLoopState.wakeFd.get(), LOOP_SOURCE_WAKE);
+    watch(m_sLoopState.signalFd.get(), LOOP_SOURCE_SIGNAL);
+    watch(g_pCommandStreams->getFD(), LOOP_SOURCE_STREAMS);
+    if (dbusConn)
+        watch(dbusConn->getEventLoopPollData().fd, LOOP_SOURCE_DBUS);
+    if (g_pConfigWatcher)
+        watch(g_pConfigWatcher->getFD(), LOOP_SOURCE_CONFIG);
 
-                wl_display_read_events(m_sWaylandState.display);
-                m_sLoopState.wlDispatched = false;
-            }
+    g_pRenderer->startFadeIn();
 
-            if (events > 0 || !preparedToRead) {
-                Log::logger->log(Log::TRACE, "[core] got poll event");
-                std::unique_lock lk(m_sLoopState.eventLoopMutex);
-                m_sLoopState.event = true;
-                m_sLoopState.loopCV.notify_all();
+    m_loopStarted = std::chrono::steady_clock::now();
 
-                m_sLoopState.wlDispatchCV.wait_for(lk, std::chrono::milliseconds(100), [this] { return m_sLoopState.wlDispatched; });
-            }
+    while (!m_bTerminate) {
+        // Queued events have to be dispatched before waiting for new ones.
+        auto cpu = threadCpuTime();
+        while (wl_display_prepare_read(DPY) != 0) {
+            wl_display_dispatch_pending(DPY);
         }
-    });
+        wl_display_flush(DPY);
+        m_sourceStats[LOOP_SOURCE_WAYLAND].cpu += threadCpuTime() - cpu;
 
-    std::thread timersThr([this]() {
-        while (!m_bTerminate) {
-            // calc nearest thing
-            m_sLoopState.timersMutex.lock();
-
-            float least = 10000;
-            for (auto& t : m_vTimers) {
-                const auto TIME = std::clamp(t->leftMs(), 1.f, INFINITY);
-                least           = std::min(TIME, least);
-            }
-
-            m_sLoopState.timersMutex.unlock();
-
-            std::unique_lock lk(m_sLoopState.timerRequestMutex);
-            m_sLoopState.timerCV.wait_for(lk, std::chrono::milliseconds((int)least + 1), [this] { return m_sLoopState.timerEvent; });
-            m_sLoopState.timerEvent = false;
-
-            // notify main
-            std::lock_guard<std::mutex> lg2(m_sLoopState.eventLoopMutex);
-            Log::logger->log(Log::TRACE, "timer thread firing");
-            m_sLoopState.event = true;
-            m_sLoopState.loopCV.notify_all();
+        if (m_bTerminate) {
+            wl_display_cancel_read(DPY);
+            break;
         }
-    });
 
-    m_sLoopState.event = true; // let it process once
-    g_pRenderer->startFadeIn();
-
-    while (!m_bTerminate) {
-        std::unique_lock lk(m_sLoopState.eventRequestMutex);
-        if (!m_sLoopState.event)
-            m_sLoopState.loopCV.wait_for(lk, std::chrono::milliseconds(5000), [this] { return m_sLoopState.event; });
+        // Everything that needs the loop has an fd, it only wakes up for events.
+        epoll_event events[8];
+        const int   COUNT = epoll_wait(m_sLoopState.epollFd.get(), events, 8, -1);
 
-        if (m_bTerminate)
-            break;
+        if (COUNT < 0) {
+            wl_display_cancel_read(DPY);
+            RASSERT(errno == EINTR, "[core] Polling fds failed with {}", errno);
+            continue;
+        }
 
-        std::lock_guard<std::mutex> lg(m_sLoopState.eventLoopMutex);
+        if (COUNT > 0)
+            m_loopWakeups++;
 
-        m_sLoopState.event = false;
+        // Charges the cpu time since the last call to source.
+        cpu                = threadCpuTime();
+        const auto account = [this, &cpu](uint32_t source) {
+            const auto NOW = threadCpuTime();
+            m_sourceStats[source].events++;
+            m_sourceStats[source].cpu += NOW - cpu;
+            cpu = NOW;
+        };
 
-        wl_display_dispatch_pending(m_sWaylandState.display);
-        wl_display_flush(m_sWaylandState.display);
+        bool waylandReadable = false;
+        for (int i = 0; i < COUNT; ++i) {
+            RASSERT(!(events[i].events & EPOLLHUP), "[core] Disconnected from event source {}", events[i].data.u32);
+            waylandReadable = waylandReadable || events[i].data.u32 == LOOP_SOURCE_WAYLAND;
+        }
 
-        m_sLoopState.wlDispatched = true;
-        m_sLoopState.wlDispatchCV.notify_all();
+        if (waylandReadable)
+            wl_display_read_events(DPY);
+        else
+            wl_display_cancel_read(DPY);
 
-        if (pollfds[1].revents & POLLIN /* dbus */) {
-            while (dbusConn && dbusConn->processPendingEvent()) {
-                ;
+        // Frame callbacks and thus rendering happen in here.
+        wl_display_dispatch_pending(DPY);
+        if (waylandReadable)
+            account(LOOP_SOURCE_WAYLAND);
+        else
+            m_sourceStats[LOOP_SOURCE_WAYLAND].cpu += threadCpuTime() - cpu;
+
+        for (int i = 0; i < COUNT; ++i) {
+            cpu = threadCpuTime();
+            switch (events[i].data.u32) {
+                case LOOP_SOURCE_WAKE: {
+                    eventfd_t value = 0;
+                    eventfd_read(m_sLoopState.wakeFd.get(), &value);
+                    break;
+                }
+                case LOOP_SOURCE_SIGNAL: handleSignals(); break;
+                case LOOP_SOURCE_STREAMS: g_pCommandStreams->dispatch(); break;
+                case LOOP_SOURCE_CONFIG: g_pConfigWatcher->dispatch(); break;
+                case LOOP_SOURCE_DBUS:
+                    while (dbusConn->processPendingEvent()) {
+                        ;
+                    }
+                    break;
+                default: break; // wayland is dispatched above, timers below
             }
+
+            // Timer callbacks are accounted by owner in processTimers.
+            if (events[i].data.u32 != LOOP_SOURCE_WAYLAND && events[i].data.u32 < LOOP_SOURCE_COUNT)
+                account(events[i].data.u32);
         }
 
         processTimers();
     }
 
-    const auto DPY = m_sWaylandState.display;
-
-    // Wake threads so they observe m_bTerminate and exit; pending timers are dropped
-    m_sLoopState.timerEvent = true;
-    m_sLoopState.timerCV.notify_all();
-
-    pthread_kill(pollThr.native_handle(), SIGRTMIN);
-
+    // Pending timers are dropped, timer callbacks only run in the loop above.
     g_pAuth->terminate();
 
-    // Wait for threads to exit before destroying globals to prevent
-    // use-after-free in timer callbacks referencing g_asyncResourceManager
-    pollThr.join();
-    timersThr.join();
-
-    // Now safe to destroy globals — no more timer callbacks can fire
     m_sWaylandState = {};
     dma             = {};
 
+    logLoopStats();
+    g_asyncResourceManager->logStats();
+    g_pCommandStreams->logStats();
     m_vOutputs.clear();
     g_pSeatManager.reset();
+    g_pGLWorker.reset();
     g_asyncResourceManager.reset();
+    g_pCommandStreams.reset();
+    g_pConfigWatcher.reset();
+    g_pSCBufferPool.reset();
+    g_pImageCache->logStats();
+    g_pImageCache.reset();
     g_pRenderer.reset();
     g_pEGL.reset();
 
@@ -581,7 +615,8 @@ void CHyprlock::startKeyRepeat(xkb_keysym_t sym) {
     if (m_iKeebRepeatDelay <= 0)
         return;
 
-    m_pKeyRepeatTimer = addTimer(std::chrono::milliseconds(m_iKeebRepeatDelay), [sym](ASP<CTimer> self, void* data) { g_pHyprlock->repeatKey(sym); }, nullptr);
+    m_pKeyRepeatTimer = addTimer(std::chrono::milliseconds(m_iKeebRepeatDelay), [sym](ASP<CTimer> self, void* data) { g_pHyprlock->repeatKey(sym); }, nullptr, false,
+                                 TIMER_OWNER_KEYREPEAT);
 }
 
 void CHyprlock::repeatKey(xkb_keysym_t sym) {
@@ -592,7 +627,8 @@ void CHyprlock::repeatKey(xkb_keysym_t sym) {
 
     // This condition is for backspace and delete keys, but should also be ok for other keysyms since our buffer won't be empty anyways
     if (bool CONTINUE = m_sPasswordState.passBuffer.length() > 0; CONTINUE)
-        m_pKeyRepeatTimer = addTimer(std::chrono::milliseconds(m_iKeebRepeatRate), [sym](ASP<CTimer> self, void* data) { g_pHyprlock->repeatKey(sym); }, nullptr);
+        m_pKeyRepeatTimer = addTimer(std::chrono::milliseconds(m_iKeebRepeatRate), [sym](ASP<CTimer> self, void* data) { g_pHyprlock->repeatKey(sym); }, nullptr, false,
+                                     TIMER_OWNER_KEYREPEAT);
 
     renderAllOutputs();
 }
@@ -875,41 +911,210 @@ size_t CHyprlock::getPasswordBufferDisplayLen() {
     return std::count_if(m_sPasswordState.passBuffer.begin(), m_sPasswordState.passBuffer.end(), [](char c) { return (c & 0xc0) != 0x80; });
 }
 
-ASP<CTimer> CHyprlock::addTimer(const std::chrono::system_clock::duration& timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data, bool force) {
+// std::push_heap builds a max heap, so the later entry compares smaller.
+static const auto timerEntryLater = [](const auto& a, const auto& b) { return a.expires != b.expires ? a.expires > b.expires : a.seq > b.seq; };
+
+ASP<CTimer> CHyprlock::addTimer(const std::chrono::steady_clock::duration& timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data, bool force,
+                                eTimerOwner owner) {
     std::lock_guard<std::mutex> lg(m_sLoopState.timersMutex);
-    const auto                  T = m_vTimers.emplace_back(makeAtomicShared<CTimer>(timeout, cb_, data, force));
-    m_sLoopState.timerEvent       = true;
-    m_sLoopState.timerCV.notify_all();
+    const auto                  T = makeAtomicShared<CTimer>(timeout, cb_, data, force, owner);
+
+    m_vTimers.emplace_back(STimerEntry{.expires = T->expiresAt(), .seq = m_timerSeq++, .timer = T});
+    std::ranges::push_heap(m_vTimers, timerEntryLater);
+
+    // Already due, wake the loop without moving the timerfd. Fires before everything else, move the timerfd.
+    if (timeout.count() <= 0)
+        eventfd_write(m_sLoopState.wakeFd.get(), 1);
+    else if (m_vTimers.front().timer == T)
+        armTimerFd();
+
     return T;
 }
 
+void CHyprlock::armTimerFd() {
+    if (!m_sLoopState.timerFd.isValid())
+        return;
+
+    // A zero it_value disarms the timerfd.
+    itimerspec spec = {};
+    if (!m_vTimers.empty()) {
+        const auto NS         = std::chrono::duration_cast<std::chrono::nanoseconds>(m_vTimers.front().expires.time_since_epoch()).count();
+        spec.it_value.tv_sec  = NS / 1000000000;
+        spec.it_value.tv_nsec = std::max<long>(NS % 1000000000, spec.it_value.tv_sec == 0 ? 1 : 0);
+    }
+
+    timerfd_settime(m_sLoopState.timerFd.get(), TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
 void CHyprlock::processTimers() {
-    // do timers
+    uint64_t expirations = 0;
+    read(m_sLoopState.timerFd.get(), &expirations, sizeof(expirations));
+
+    const auto               NOW = std::chrono::steady_clock::now();
+    std::vector<ASP<CTimer>> passed;
+
     m_sLoopState.timersMutex.lock();
-    auto timerscpy = m_vTimers;
+    while (!m_vTimers.empty() && m_vTimers.front().expires <= NOW) {
+        std::ranges::pop_heap(m_vTimers, timerEntryLater);
+        passed.emplace_back(std::move(m_vTimers.back().timer));
+        m_vTimers.pop_back();
+    }
     m_sLoopState.timersMutex.unlock();
 
-    std::vector<ASP<CTimer>> passed;
+    // Without the lock, callbacks add timers.
+    for (auto& t : passed) {
+        if (t->cancelled())
+            continue;
 
-    for (auto& t : timerscpy) {
-        if (t->passed() && !t->cancelled()) {
-            t->call(t);
-            passed.push_back(t);
+        if (m_outputsAsleep && isPausedWhileAsleep(t->owner())) {
+            m_vPausedTimers.emplace_back(std::move(t));
+            continue;
         }
 
-        if (t->cancelled())
-            passed.push_back(t);
+        callTimer(t);
     }
 
-    m_sLoopState.timersMutex.lock();
-    std::erase_if(m_vTimers, [passed](const auto& timer) { return std::find(passed.begin(), passed.end(), timer) != passed.end(); });
-    m_sLoopState.timersMutex.unlock();
+    std::lock_guard<std::mutex> lg(m_sLoopState.timersMutex);
+
+    // Drop cancelled timers once they make up a good part of the heap.
+    if (m_vTimers.size() > m_timersCompactAt) {
+        std::erase_if(m_vTimers, [](const auto& e) { return e.timer->cancelled(); });
+        std::ranges::make_heap(m_vTimers, timerEntryLater);
+        m_timersCompactAt = std::max<size_t>(64, m_vTimers.size() * 2);
+    }
+
+    armTimerFd();
+}
+
+void CHyprlock::callTimer(const ASP<CTimer>& timer) {
+    const auto CPU = threadCpuTime();
+    timer->call(timer);
+
+    auto& stats = m_timerStats[timer->owner()];
+    stats.events++;
+    stats.cpu += threadCpuTime() - CPU;
+}
+
+bool CHyprlock::outputsAsleep() {
+    return m_outputsAsleep;
+}
 
-    passed.clear();
+void CHyprlock::onFrameRequested() {
+    static const auto FRAMETIMEOUT = g_pConfigManager->getValue<Hyprlang::INT>("general:frame_timeout");
+
+    if (m_frameWatchdog || m_outputsAsleep || *FRAMETIMEOUT <= 0)
+        return;
+
+    m_frameWatchdog = addTimer(std::chrono::milliseconds(*FRAMETIMEOUT), [](auto, auto) { g_pHyprlock->checkFrameStarvation(); }, nullptr);
+}
+
+void CHyprlock::checkFrameStarvation() {
+    static const auto FRAMETIMEOUT = g_pConfigManager->getValue<Hyprlang::INT>("general:frame_timeout");
+
+    m_frameWatchdog.reset();
+    if (m_outputsAsleep || *FRAMETIMEOUT <= 0)
+        return;
+
+    const auto NOW     = std::chrono::steady_clock::now();
+    const auto TIMEOUT = std::chrono::milliseconds(*FRAMETIMEOUT);
+    auto       recheck = NOW;
+    bool       starved = false;
+
+    for (const auto& o : m_vOutputs) {
+        if (!o->m_sessionLockSurface || !o->m_sessionLockSurface->readyForFrame)
+            continue;
+
+        const auto REQUESTED = o->m_sessionLockSurface->frameRequestedAt();
+        // Answered its last frame, so it is on.
+        if (!REQUESTED)
+            return;
+
+        if (NOW - *REQUESTED >= TIMEOUT)
+            starved = true;
+        else
+            recheck = std::max(recheck, *REQUESTED + TIMEOUT);
+    }
+
+    if (recheck > NOW) {
+        m_frameWatchdog = addTimer(recheck - NOW, [](auto, auto) { g_pHyprlock->checkFrameStarvation(); }, nullptr);
+        return;
+    }
+
+    if (!starved)
+        return;
+
+    Log::logger->log(Log::INFO, "No frame callbacks for {}ms, outputs are probably off. Pausing widget updates", *FRAMETIMEOUT);
+    m_outputsAsleep = true;
+    m_asleepSince   = NOW;
+    m_sleeps++;
+}
+
+void CHyprlock::onFrameDone() {
+    if (!m_outputsAsleep)
+        return;
+
+    m_outputsAsleep = false;
+    m_timeAsleep += std::chrono::steady_clock::now() - m_asleepSince;
+
+    // Not from within the frame callback, the paused timers render.
+    addTimer(std::chrono::milliseconds(0), [](auto, auto) { g_pHyprlock->resumeAfterSleep(); }, nullptr);
+}
+
+void CHyprlock::resumeAfterSleep() {
+    Log::logger->log(Log::INFO, "Outputs are back after {}s, resuming {} paused timers",
+                     std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - m_asleepSince).count(), m_vPausedTimers.size());
+
+    // Moved out, the callbacks plant new timers.
+    const auto PAUSED = std::move(m_vPausedTimers);
+    m_vPausedTimers.clear();
+
+    for (const auto& t : PAUSED) {
+        if (!t->cancelled())
+            callTimer(t);
+    }
+
+    g_pCommandStreams->resume();
+    renderAllOutputs();
+}
+
+void CHyprlock::logLoopStats() {
+    const auto SECONDS = std::max<double>(std::chrono::duration<double>(std::chrono::steady_clock::now() - m_loopStarted).count(), 1);
+    const auto toMs    = [](std::chrono::nanoseconds ns) { return std::chrono::duration<double, std::milli>(ns).count(); };
+
+    Log::logger->log(Log::INFO, "Event loop: {} wakeups in {:.0f}s, {:.2f}/s", m_loopWakeups, SECONDS, m_loopWakeups / SECONDS);
+
+    for (size_t i = 0; i < LOOP_SOURCE_COUNT; i++) {
+        const auto& stats = m_sourceStats[i];
+        if (stats.events > 0 || stats.cpu.count() > 0)
+            Log::logger->log(Log::INFO, "Event loop source {}: {} events, {:.2f}/s, {:.1f}ms cpu", LOOPSOURCENAMES[i], stats.events, stats.events / SECONDS, toMs(stats.cpu));
+    }
+
+    for (size_t i = 0; i < TIMER_OWNER_COUNT; i++) {
+        const auto& stats = m_timerStats[i];
+        if (stats.events > 0)
+            Log::logger->log(Log::INFO, "Timer callbacks for {}: {} calls, {:.2f}/s, {:.1f}ms cpu", TIMEROWNERNAMES[i], stats.events, stats.events / SECONDS, toMs(stats.cpu));
+    }
+
+    if (m_sleeps > 0)
+        Log::logger->log(Log::INFO, "Outputs were asleep {} times, {}s in total", m_sleeps, std::chrono::duration_cast<std::chrono::seconds>(m_timeAsleep).count());
 }
 
 std::vector<ASP<CTimer>> CHyprlock::getTimers() {
-    return m_vTimers;
+    std::lock_guard<std::mutex> lg(m_sLoopState.timersMutex);
+
+    std::vector<ASP<CTimer>> timers;
+    timers.reserve(m_vTimers.size());
+    for (const auto& e : m_vTimers) {
+        if (!e.timer->cancelled())
+            timers.emplace_back(e.timer);
+    }
+
+    for (const auto& t : m_vPausedTimers) {
+        if (!t->cancelled())
+            timers.emplace_back(t);
+    }
+
+    return timers;
 }
 
 void CHyprlock::enqueueForceUpdateTimers() {
@@ -926,6 +1131,18 @@ void CHyprlock::enqueueForceUpdateTimers() {
         nullptr, false);
 }
 
+void CHyprlock::reloadConfig() {
+    if (isFadingOutOrTerminating() || !g_pConfigManager->reload())
+        return;
+
+    // A source= may have been added or removed.
+    if (g_pConfigWatcher)
+        g_pConfigWatcher->setPaths(g_pConfigManager->getConfigPaths());
+
+    g_pRenderer->updateWidgets();
+    renderAllOutputs();
+}
+
 SP<CCZwlrScreencopyManagerV1> CHyprlock::getScreencopy() {
     return m_sWaylandState.screencopy;
 }
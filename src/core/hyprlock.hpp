@@ -9,6 +9,8 @@
 #include "viewporter.hpp"
 #include "Output.hpp"
 #include "Timer.hpp"
+#include <hyprutils/os/FileDescriptor.hpp>
+#include <array>
 #include <vector>
 #include <condition_variable>
 #include <optional>
@@ -25,6 +27,18 @@ struct SDMABUFModifier {
     uint64_t mod    = 0;
 };
 
+// What woke the main loop, stored in the epoll event data.
+enum eLoopSource : uint32_t {
+    LOOP_SOURCE_WAYLAND = 0,
+    LOOP_SOURCE_TIMER,
+    LOOP_SOURCE_WAKE,
+    LOOP_SOURCE_SIGNAL,
+    LOOP_SOURCE_STREAMS,
+    LOOP_SOURCE_DBUS,
+    LOOP_SOURCE_CONFIG,
+    LOOP_SOURCE_COUNT,
+};
+
 class CHyprlock {
   public:
     CHyprlock(std::string_view wlDisplay, const bool immediateRender, const int gracePeriod);
@@ -38,11 +52,26 @@ class CHyprlock {
     bool                       isTerminating();
     bool                       isLockAquired();
 
-    ASP<CTimer>                addTimer(const std::chrono::system_clock::duration& timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data, bool force = false);
+    // Thread safe. The callback is called from the main loop.
+    ASP<CTimer>                addTimer(const std::chrono::steady_clock::duration& timeout, std::function<void(ASP<CTimer> self, void* data)> cb_, void* data, bool force = false,
+                                        eTimerOwner owner = TIMER_OWNER_OTHER);
     void                       processTimers();
 
+    // Wakeups and cpu time of the main loop by event source, and of timer callbacks by owner.
+    void                       logLoopStats();
+
+    // No output answered a frame callback within general:frame_timeout, they are probably powered off.
+    // Label, image and background timers are held back until a frame callback arrives again.
+    bool                       outputsAsleep();
+    // From the lock surfaces.
+    void                       onFrameRequested();
+    void                       onFrameDone();
+
     void                       enqueueForceUpdateTimers();
 
+    // Parses the config again and updates the widgets that changed.
+    void                       reloadConfig();
+
     void                       onLockLocked();
     void                       onLockFinished();
 
@@ -147,23 +176,55 @@ class CHyprlock {
     } m_sPasswordState;
 
     struct {
-        std::mutex              timersMutex;
-        std::mutex              eventRequestMutex;
-        std::mutex              eventLoopMutex;
-        std::condition_variable loopCV;
-        bool                    event = false;
-
-        std::condition_variable wlDispatchCV;
-        bool                    wlDispatched = false;
-
-        std::condition_variable timerCV;
-        std::mutex              timerRequestMutex;
-        bool                    timerEvent = false;
+        std::mutex                     timersMutex;
+
+        // Everything the main loop waits for, watched by epollFd.
+        Hyprutils::OS::CFileDescriptor epollFd;
+        // Armed for the earliest timer.
+        Hyprutils::OS::CFileDescriptor timerFd;
+        // Written when a timer is added that is already due, mostly worker threads posting their results.
+        Hyprutils::OS::CFileDescriptor wakeFd;
+        // SIGUSR1 and SIGUSR2
+        Hyprutils::OS::CFileDescriptor signalFd;
     } m_sLoopState;
 
-    std::vector<ASP<CTimer>> m_vTimers;
+    struct STimerEntry {
+        std::chrono::steady_clock::time_point expires;
+        uint64_t                              seq = 0; // timers with the same expiry fire in the order they were added
+        ASP<CTimer>                           timer;
+    };
+
+    // Min heap on expires. Cancelled timers stay in until they expire or the heap is compacted.
+    std::vector<STimerEntry> m_vTimers;
+    uint64_t                 m_timerSeq        = 0;
+    size_t                   m_timersCompactAt = 64;
 
     std::vector<uint32_t>    m_vPressedKeys;
+
+    struct SLoopStats {
+        size_t                   events = 0;
+        std::chrono::nanoseconds cpu{0};
+    };
+
+    std::chrono::steady_clock::time_point     m_loopStarted;
+    size_t                                    m_loopWakeups = 0;
+    std::array<SLoopStats, LOOP_SOURCE_COUNT> m_sourceStats;
+    std::array<SLoopStats, TIMER_OWNER_COUNT> m_timerStats;
+
+    // See outputsAsleep(). Paused timers are called when the outputs wake up.
+    bool                                  m_outputsAsleep = false;
+    ASP<CTimer>                           m_frameWatchdog;
+    std::vector<ASP<CTimer>>              m_vPausedTimers;
+    std::chrono::steady_clock::time_point m_asleepSince;
+    size_t                                m_sleeps = 0;
+    std::chrono::steady_clock::duration   m_timeAsleep{0};
+
+    // Needs timersMutex.
+    void armTimerFd();
+    void handleSignals();
+    void callTimer(const ASP<CTimer>& timer);
+    void checkFrameStarvation();
+    void resumeAfterSleep();
 };
 
 inline UP<CHyprlock> g_pHyprlock;
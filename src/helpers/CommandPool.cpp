@@ -0,0 +1,282 @@
+#include "CommandPool.hpp"
+#include "Log.hpp"
+
+#include <hyprutils/os/FileDescriptor.hpp>
+#include <algorithm>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <span>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Hyprutils::OS;
+
+// Upper bound for commands running at the same time.
+static const size_t MAXPROCESSES = 4;
+// Output beyond this is dropped, a label can't show it anyway.
+static const size_t MAXOUTPUT = 1024 * 1024;
+
+CCommandPool::CCommandPool() {
+    m_running.resize(MAXPROCESSES);
+
+    for (size_t slot = 0; slot < MAXPROCESSES; slot++) {
+        m_threads.emplace_back([this, slot]() { workerThread(slot); });
+    }
+}
+
+CCommandPool::~CCommandPool() {
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_exit = true;
+        m_jobs.clear();
+
+        // Also the jobs that did not fork yet, they check for it right after.
+        for (auto& r : m_running) {
+            r.cancelled = true;
+            if (r.pid > 0)
+                kill(-r.pid, SIGKILL);
+        }
+    }
+    m_cv.notify_all();
+
+    for (auto& t : m_threads) {
+        if (t.joinable())
+            t.join();
+    }
+}
+
+void CCommandPool::run(uint64_t token, const std::string& cmd, std::chrono::milliseconds timeout, doneFn_t done) {
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_jobs.emplace_back(SJob{.token = token, .cmd = cmd, .timeout = timeout, .done = std::move(done)});
+    }
+    m_cv.notify_one();
+}
+
+void CCommandPool::cancel(uint64_t token) {
+    std::lock_guard<std::mutex> lg(m_mutex);
+
+    for (const auto& job : m_jobs) {
+        if (job.token == token)
+            m_stats[job.cmd].cancelled++;
+    }
+
+    if (std::erase_if(m_jobs, [token](const auto& job) { return job.token == token; }) > 0)
+        return;
+
+    for (auto& r : m_running) {
+        if (r.token != token)
+            continue;
+
+        // Without a pid the job is about to fork and kills the command itself.
+        r.cancelled = true;
+        if (r.pid > 0)
+            kill(-r.pid, SIGKILL);
+    }
+}
+
+void CCommandPool::workerThread(size_t slot) {
+    while (true) {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_cv.wait(lk, [this] { return m_exit || !m_jobs.empty(); });
+
+        if (m_exit)
+            return;
+
+        const auto JOB = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        // Claimed together with the pop, so that cancel() always finds the job.
+        m_running[slot] = SRunning{.token = JOB.token};
+        lk.unlock();
+
+        const auto RESULT = execute(JOB, slot);
+
+        lk.lock();
+        m_running[slot] = {};
+
+        auto& stats = m_stats[JOB.cmd];
+        stats.runs++;
+        stats.total += RESULT.runtime;
+        if (RESULT.runtime > stats.max)
+            stats.max = RESULT.runtime;
+
+        if (RESULT.timedOut)
+            stats.timeouts++;
+        else if (RESULT.cancelled)
+            stats.cancelled++;
+        else if (!RESULT.ok() || RESULT.exitStatus != 0)
+            stats.failures++;
+        lk.unlock();
+
+        if (!RESULT.spawned)
+            Log::logger->log(Log::ERR, "Failed to run \"{}\"", JOB.cmd);
+        else if (RESULT.timedOut)
+            Log::logger->log(Log::WARN, "Shell command \"{}\" did not finish within {}ms, killed it", JOB.cmd, JOB.timeout.count());
+        else if (!RESULT.err.empty())
+            Log::logger->log(Log::ERR, "Shell command \"{}\" STDERR:\n{}", JOB.cmd, RESULT.err);
+
+        JOB.done(RESULT);
+    }
+}
+
+SCommandResult CCommandPool::execute(const SJob& job, size_t slot) {
+    SCommandResult result;
+    const auto     START    = std::chrono::steady_clock::now();
+    const auto     DEADLINE = START + job.timeout;
+
+    int            outPipe[2] = {-1, -1};
+    int            errPipe[2] = {-1, -1};
+    if (pipe2(outPipe, O_CLOEXEC) != 0)
+        return result;
+
+    if (pipe2(errPipe, O_CLOEXEC) != 0) {
+        close(outPipe[0]);
+        close(outPipe[1]);
+        return result;
+    }
+
+    const char* CMD = job.cmd.c_str();
+    const pid_t PID = fork();
+    if (PID < 0) {
+        for (int fd : {outPipe[0], outPipe[1], errPipe[0], errPipe[1]}) {
+            close(fd);
+        }
+        return result;
+    }
+
+    if (PID == 0) {
+        // Only async signal safe calls in the child. Its own process group, so that a timeout kills everything it started.
+        setpgid(0, 0);
+
+        sigset_t set;
+        sigemptyset(&set);
+        sigprocmask(SIG_SETMASK, &set, nullptr);
+
+        const int DEVNULL = open("/dev/null", O_RDONLY);
+        if (DEVNULL >= 0)
+            dup2(DEVNULL, STDIN_FILENO);
+        dup2(outPipe[1], STDOUT_FILENO);
+        dup2(errPipe[1], STDERR_FILENO);
+
+        execl("/bin/sh", "sh", "-c", CMD, nullptr);
+        _exit(127);
+    }
+
+    // Also from the parent, the child might not have gotten to it before a kill.
+    setpgid(PID, PID);
+    close(outPipe[1]);
+    close(errPipe[1]);
+
+    CFileDescriptor outFd{outPipe[0]};
+    CFileDescriptor errFd{errPipe[0]};
+    // Readable once the command exits, which includes being killed by cancel(). Needs Linux 5.3.
+    CFileDescriptor pidFd{(int)syscall(SYS_pidfd_open, PID, 0)};
+    result.spawned = true;
+
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_running[slot].pid = PID;
+
+        // Cancelled while forking.
+        if (m_running[slot].cancelled)
+            kill(-PID, SIGKILL);
+    }
+
+    pollfd pollfds[3] = {
+        {.fd = outFd.get(), .events = POLLIN},
+        {.fd = errFd.get(), .events = POLLIN},
+        {.fd = pidFd.isValid() ? pidFd.get() : -1, .events = POLLIN},
+    };
+
+    int  openFds = 2;
+    bool exited  = false;
+    char buf[4096];
+    while (true) {
+        const auto REMAINING = std::chrono::duration_cast<std::chrono::milliseconds>(DEADLINE - std::chrono::steady_clock::now());
+        if (REMAINING.count() <= 0) {
+            result.timedOut = true;
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            if (m_running[slot].cancelled)
+                break;
+        }
+
+        // Not reaped yet, so the pid can't be reused while cancel() might still kill it.
+        if (!exited) {
+            siginfo_t info = {};
+            exited         = waitid(P_PID, PID, &info, WEXITED | WNOHANG | WNOWAIT) == 0 && info.si_pid == PID;
+            if (exited)
+                pollfds[2].fd = -1;
+        }
+
+        if (exited && openFds == 0)
+            break;
+
+        // Without a pidfd, wake up now and then to notice cancellation and the exit.
+        int timeout = std::min<int64_t>(REMAINING.count(), INT32_MAX);
+        if (exited)
+            timeout = 0;
+        else if (!pidFd.isValid())
+            timeout = std::min(timeout, 100);
+
+        const int READY = poll(pollfds, 3, timeout);
+        if (READY < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        // Exited and drained. Something it left running in the background keeps the pipes open.
+        if (READY == 0 && exited)
+            break;
+
+        for (auto& pfd : std::span{pollfds, 2}) {
+            if (pfd.fd < 0 || !(pfd.revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+
+            const auto LEN = read(pfd.fd, buf, sizeof(buf));
+            if (LEN > 0) {
+                auto& target = pfd.fd == outFd.get() ? result.out : result.err;
+                if (target.size() < MAXOUTPUT)
+                    target.append(buf, std::min<size_t>(LEN, MAXOUTPUT - target.size()));
+            } else if (LEN == 0 || (errno != EINTR && errno != EAGAIN)) {
+                pfd.fd = -1;
+                openFds--;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        result.cancelled = m_running[slot].cancelled;
+    }
+
+    if (result.timedOut || result.cancelled || !exited)
+        kill(-PID, SIGKILL);
+
+    int status = 0;
+    while (waitpid(PID, &status, 0) < 0 && errno == EINTR) {
+        ;
+    }
+
+    if (!result.timedOut && !result.cancelled && WIFEXITED(status))
+        result.exitStatus = WEXITSTATUS(status);
+
+    result.runtime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - START);
+
+    return result;
+}
+
+void CCommandPool::logStats() {
+    std::lock_guard<std::mutex> lg(m_mutex);
+
+    for (const auto& [cmd, stats] : m_stats) {
+        Log::logger->log(Log::INFO, "Shell command \"{}\": {} runs, {} failed, {} timed out, {} cancelled, average {}ms, max {}ms", cmd, stats.runs, stats.failures,
+                         stats.timeouts, stats.cancelled, stats.runs ? stats.total.count() / stats.runs : 0, stats.max.count());
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct SCommandResult {
+    bool                      timedOut   = false;
+    bool                      cancelled  = false;
+    bool                      spawned    = false;
+    int                       exitStatus = -1; // -1 if the command did not exit on its own
+    std::string               out;
+    std::string               err;
+    std::chrono::milliseconds runtime{0};
+
+    // Exited on its own, no matter with which status.
+    bool ok() const {
+        return spawned && !timedOut && !cancelled && exitStatus >= 0;
+    }
+};
+
+// Runs shell commands for cmd[] labels, so that they never block the resource workers.
+// At most a fixed number of commands run at the same time, the rest waits in a queue.
+// Commands that run longer than their timeout are killed together with their process group.
+class CCommandPool {
+  public:
+    typedef std::function<void(const SCommandResult& result)> doneFn_t;
+
+    CCommandPool();
+    ~CCommandPool();
+
+    // Runs sh -c cmd. done is called from a pool thread, but not for jobs that were cancelled while queued.
+    void run(uint64_t token, const std::string& cmd, std::chrono::milliseconds timeout, doneFn_t done);
+    // Drops the queued job or kills the running command for token. done still runs for a killed command, with cancelled set.
+    void cancel(uint64_t token);
+
+    void logStats();
+
+  private:
+    struct SJob {
+        uint64_t                  token = 0;
+        std::string               cmd;
+        std::chrono::milliseconds timeout{0};
+        doneFn_t                  done;
+    };
+
+    // Claimed when a job is taken from the queue, the pid is set once it forked.
+    struct SRunning {
+        uint64_t token     = 0;
+        pid_t    pid       = -1;
+        bool     cancelled = false;
+    };
+
+    struct SCommandStats {
+        size_t                    runs      = 0;
+        size_t                    failures  = 0; // non zero exit status or failed to spawn
+        size_t                    timeouts  = 0;
+        size_t                    cancelled = 0;
+        std::chrono::milliseconds total{0};
+        std::chrono::milliseconds max{0};
+    };
+
+    void                                           workerThread(size_t slot);
+    SCommandResult                                 execute(const SJob& job, size_t slot);
+
+    // shared between threads
+    std::mutex                                     m_mutex;
+    std::condition_variable                        m_cv;
+    std::deque<SJob>                               m_jobs;
+    std::vector<SRunning>                          m_running; // one per thread
+    std::unordered_map<std::string, SCommandStats> m_stats;
+    bool                                           m_exit = false;
+
+    std::vector<std::thread>                       m_threads;
+};
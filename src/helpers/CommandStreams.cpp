@@ -0,0 +1,308 @@
+#include "CommandStreams.hpp"
+#include "Log.hpp"
+#include "../core/hyprlock.hpp"
+
+#include <algorithm>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace Hyprutils::OS;
+
+// A line longer than this is dropped, a label can't show it anyway.
+static const size_t MAXLINE = 64 * 1024;
+// Reads per command and dispatch, so that a command that prints without pause can't stall the main loop.
+static const size_t MAXREADS = 16;
+// A command that ran at least this long before exiting starts over with the shortest restart delay.
+static const auto   HEALTHYRUN = std::chrono::seconds(30);
+static const auto   MAXBACKOFF = std::chrono::seconds(60);
+
+CCommandStreams::CCommandStreams() {
+    m_epoll = CFileDescriptor{epoll_create1(EPOLL_CLOEXEC)};
+    if (!m_epoll.isValid())
+        Log::logger->log(Log::ERR, "Failed to create an epoll fd for stream commands, cmd[stream] labels won't update");
+}
+
+CCommandStreams::~CCommandStreams() {
+    for (auto& [cmd, stream] : m_streams) {
+        stop(*stream);
+    }
+}
+
+uint64_t CCommandStreams::subscribe(const std::string& cmd, lineFn_t onLine) {
+    auto& stream = m_streams[cmd];
+    if (!stream) {
+        stream      = makeUnique<SStream>();
+        stream->cmd = cmd;
+        if (!spawn(*stream))
+            scheduleRestart(*stream);
+    }
+
+    const auto TOKEN = ++m_lastToken;
+    stream->subscribers.emplace(TOKEN, std::move(onLine));
+    m_subscriptions.emplace(TOKEN, stream.get());
+
+    // Another label already runs it, don't wait for the next line.
+    if (!stream->lastLine.empty()) {
+        g_pHyprlock->addTimer(
+            std::chrono::milliseconds(0),
+            [TOKEN](auto, auto) {
+                if (!g_pCommandStreams)
+                    return;
+
+                const auto IT = g_pCommandStreams->m_subscriptions.find(TOKEN);
+                if (IT == g_pCommandStreams->m_subscriptions.end())
+                    return;
+
+                const auto LINE = IT->second->lastLine;
+                IT->second->subscribers.at(TOKEN)(LINE);
+            },
+            nullptr, false, TIMER_OWNER_STREAMS);
+    }
+
+    return TOKEN;
+}
+
+void CCommandStreams::unsubscribe(uint64_t token) {
+    const auto IT = m_subscriptions.find(token);
+    if (IT == m_subscriptions.end())
+        return;
+
+    auto* stream = IT->second;
+    m_subscriptions.erase(IT);
+    stream->subscribers.erase(token);
+
+    if (!stream->subscribers.empty())
+        return;
+
+    Log::logger->log(Log::TRACE, "Stopping stream command \"{}\" after {} lines and {} restarts", stream->cmd, stream->lines, stream->restarts);
+    stop(*stream);
+    m_streams.erase(stream->cmd);
+}
+
+int CCommandStreams::getFD() const {
+    return m_epoll.get();
+}
+
+void CCommandStreams::dispatch() {
+    if (!m_epoll.isValid())
+        return;
+
+    epoll_event events[16];
+    const int   COUNT = epoll_wait(m_epoll.get(), events, 16, 0);
+
+    for (int i = 0; i < COUNT; i++) {
+        // Looked up by fd, a subscriber might have stopped a command while lines were passed on.
+        const auto IT = std::ranges::find_if(m_streams, [fd = events[i].data.fd](const auto& s) { return s.second->out.isValid() && s.second->out.get() == fd; });
+        if (IT != m_streams.end())
+            read(*IT->second);
+    }
+}
+
+void CCommandStreams::resume() {
+    std::vector<std::string> held;
+    for (const auto& [cmd, stream] : m_streams) {
+        if (stream->held)
+            held.emplace_back(cmd);
+    }
+
+    // By command, a subscriber might stop another one.
+    for (const auto& cmd : held) {
+        const auto IT = m_streams.find(cmd);
+        if (IT != m_streams.end() && IT->second->held)
+            deliver(*IT->second, std::string{IT->second->lastLine});
+    }
+}
+
+bool CCommandStreams::spawn(SStream& stream) {
+    int outPipe[2] = {-1, -1};
+    if (!m_epoll.isValid() || pipe2(outPipe, O_CLOEXEC) != 0)
+        return false;
+
+    const char* CMD = stream.cmd.c_str();
+    const pid_t PID = fork();
+    if (PID < 0) {
+        close(outPipe[0]);
+        close(outPipe[1]);
+        return false;
+    }
+
+    if (PID == 0) {
+        // Own process group, so that stopping it also stops what it started.
+        setpgid(0, 0);
+
+        sigset_t set;
+        sigemptyset(&set);
+        sigprocmask(SIG_SETMASK, &set, nullptr);
+
+        const int DEVNULL = open("/dev/null", O_RDONLY);
+        if (DEVNULL >= 0)
+            dup2(DEVNULL, STDIN_FILENO);
+        dup2(outPipe[1], STDOUT_FILENO);
+
+        execl("/bin/sh", "sh", "-c", CMD, nullptr);
+        _exit(127);
+    }
+
+    setpgid(PID, PID);
+    close(outPipe[1]);
+    fcntl(outPipe[0], F_SETFL, fcntl(outPipe[0], F_GETFL) | O_NONBLOCK);
+
+    stream.pid     = PID;
+    stream.out     = CFileDescriptor{outPipe[0]};
+    stream.started = std::chrono::steady_clock::now();
+    stream.buffer.clear();
+
+    epoll_event event = {.events = EPOLLIN, .data = {.fd = stream.out.get()}};
+    if (epoll_ctl(m_epoll.get(), EPOLL_CTL_ADD, stream.out.get(), &event) != 0) {
+        stop(stream);
+        return false;
+    }
+
+    Log::logger->log(Log::TRACE, "Started stream command \"{}\" (pid {})", stream.cmd, PID);
+    return true;
+}
+
+void CCommandStreams::read(SStream& stream) {
+    bool exited = false;
+    char buf[4096];
+
+    for (size_t i = 0; i < MAXREADS; i++) {
+        const auto LEN = ::read(stream.out.get(), buf, sizeof(buf));
+        if (LEN > 0) {
+            stream.buffer.append(buf, LEN);
+            continue;
+        }
+
+        if (LEN < 0 && errno == EINTR)
+            continue;
+
+        exited = LEN == 0 || errno != EAGAIN;
+        break;
+    }
+
+    // Only the newest complete line is shown, the ones before it would be replaced right away.
+    std::string newest;
+    bool        complete = false;
+    if (const auto LAST = stream.buffer.rfind('\n'); LAST != std::string::npos) {
+        const auto LINES = stream.buffer.substr(0, LAST);
+        const auto START = LINES.rfind('\n');
+        newest           = START == std::string::npos ? LINES : LINES.substr(START + 1);
+        complete         = true;
+        stream.lines += std::ranges::count(stream.buffer, '\n');
+        stream.buffer.erase(0, LAST + 1);
+    }
+
+    if (exited && !stream.buffer.empty()) {
+        newest   = std::move(stream.buffer);
+        complete = true;
+        stream.lines++;
+        stream.buffer.clear();
+    }
+
+    if (stream.buffer.size() > MAXLINE) {
+        Log::logger->log(Log::WARN, "Stream command \"{}\" printed more than {} bytes without a newline, dropping them", stream.cmd, MAXLINE);
+        stream.buffer.clear();
+    }
+
+    if (exited)
+        onExit(stream);
+
+    // Last, a subscriber might stop the command.
+    if (complete) {
+        if (newest.ends_with('\r'))
+            newest.pop_back();
+
+        deliver(stream, newest);
+    }
+}
+
+void CCommandStreams::deliver(SStream& stream, const std::string& line) {
+    stream.lastLine = line;
+
+    // Nobody sees the labels, keep only the newest line until the outputs wake up.
+    stream.held = g_pHyprlock->outputsAsleep();
+    if (stream.held)
+        return;
+
+    // Copied, subscribers may come and go while being called.
+    std::vector<lineFn_t> callbacks;
+    for (const auto& [token, fn] : stream.subscribers) {
+        callbacks.emplace_back(fn);
+    }
+
+    for (const auto& fn : callbacks) {
+        fn(line);
+    }
+}
+
+void CCommandStreams::onExit(SStream& stream) {
+    const auto PID = stream.pid;
+    stop(stream);
+
+    Log::logger->log(Log::WARN, "Stream command \"{}\" (pid {}) exited after {}s", stream.cmd, PID,
+                     std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - stream.started).count());
+
+    if (std::chrono::steady_clock::now() - stream.started >= HEALTHYRUN)
+        stream.failures = 0;
+
+    scheduleRestart(stream);
+}
+
+void CCommandStreams::scheduleRestart(SStream& stream) {
+    const auto DELAY = std::min<std::chrono::milliseconds>(std::chrono::seconds(1) * (1 << std::min<size_t>(stream.failures, 6)), MAXBACKOFF);
+    stream.failures++;
+
+    Log::logger->log(Log::INFO, "Restarting stream command \"{}\" in {}ms", stream.cmd, DELAY.count());
+
+    stream.restartTimer = g_pHyprlock->addTimer(
+        DELAY,
+        [CMD = stream.cmd](auto, auto) {
+            if (!g_pCommandStreams)
+                return;
+
+            const auto IT = g_pCommandStreams->m_streams.find(CMD);
+            if (IT == g_pCommandStreams->m_streams.end() || IT->second->pid > 0)
+                return;
+
+            auto& stream = *IT->second;
+            stream.restartTimer.reset();
+            stream.restarts++;
+            if (!g_pCommandStreams->spawn(stream))
+                g_pCommandStreams->scheduleRestart(stream);
+        },
+        nullptr, false, TIMER_OWNER_STREAMS);
+}
+
+void CCommandStreams::stop(SStream& stream) {
+    if (stream.restartTimer) {
+        stream.restartTimer->cancel();
+        stream.restartTimer.reset();
+    }
+
+    if (stream.out.isValid()) {
+        if (m_epoll.isValid())
+            epoll_ctl(m_epoll.get(), EPOLL_CTL_DEL, stream.out.get(), nullptr);
+        stream.out.reset();
+    }
+
+    if (stream.pid <= 0)
+        return;
+
+    // Not reaped yet, so the process group can't belong to anyone else.
+    kill(-stream.pid, SIGKILL);
+    while (waitpid(stream.pid, nullptr, 0) < 0 && errno == EINTR) {
+        ;
+    }
+
+    stream.pid = -1;
+}
+
+void CCommandStreams::logStats() {
+    for (const auto& [cmd, stream] : m_streams) {
+        Log::logger->log(Log::INFO, "Stream command \"{}\": {} lines, {} restarts, {} labels", cmd, stream->lines, stream->restarts, stream->subscribers.size());
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "../core/Timer.hpp"
+
+#include <hyprutils/os/FileDescriptor.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <sys/types.h>
+#include <unordered_map>
+
+// Long running commands for cmd[stream] labels.
+// Every line a command prints replaces the text of the labels subscribed to it. Labels with the same command share one process.
+// Commands that exit are restarted, with a delay that doubles every time they exit shortly after starting.
+class CCommandStreams {
+  public:
+    typedef std::function<void(const std::string& line)> lineFn_t;
+
+    CCommandStreams();
+    ~CCommandStreams();
+
+    // Starts cmd unless it already runs. onLine is called from the main loop, also with the last line cmd printed before subscribing.
+    uint64_t subscribe(const std::string& cmd, lineFn_t onLine);
+    // The command is stopped when its last subscriber leaves.
+    void     unsubscribe(uint64_t token);
+
+    // Readable when a command printed something or exited. Part of the main poll set.
+    int      getFD() const;
+    // Reads the output of all commands without blocking and passes complete lines on.
+    void     dispatch();
+    // Passes on the lines held back while the outputs were asleep.
+    void     resume();
+
+    void     logStats();
+
+  private:
+    struct SStream {
+        std::string                            cmd;
+        pid_t                                  pid = -1;
+        Hyprutils::OS::CFileDescriptor         out;
+        std::string                            buffer; // incomplete line
+        std::string                            lastLine;
+        bool                                   held = false; // lastLine was not passed on yet
+        std::unordered_map<uint64_t, lineFn_t> subscribers;
+
+        std::chrono::steady_clock::time_point  started;
+        size_t                                 failures = 0; // short runs in a row, for the backoff
+        ASP<CTimer>                            restartTimer;
+
+        size_t                                 lines    = 0;
+        size_t                                 restarts = 0;
+    };
+
+    bool                                         spawn(SStream& stream);
+    void                                         read(SStream& stream);
+    // Reaps the process and plans the restart.
+    void                                         onExit(SStream& stream);
+    void                                         scheduleRestart(SStream& stream);
+    void                                         stop(SStream& stream);
+    void                                         deliver(SStream& stream, const std::string& line);
+
+    Hyprutils::OS::CFileDescriptor               m_epoll;
+    std::unordered_map<std::string, UP<SStream>> m_streams;
+    std::unordered_map<uint64_t, SStream*>       m_subscriptions;
+    uint64_t                                     m_lastToken = 0;
+};
+
+inline UP<CCommandStreams> g_pCommandStreams;
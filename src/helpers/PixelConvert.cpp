@@ -0,0 +1,371 @@
+#include "PixelConvert.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PIXELCONVERT_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define PIXELCONVERT_NEON
+#endif
+
+// Below this, starting threads costs more than it saves.
+static const size_t PARALLELMINPIXELS = 512 * 1024;
+static const size_t MAXTHREADS        = 4;
+
+// Same as round(255 * v / 1023) for every 10 bit value.
+static inline uint32_t to8Bit(uint32_t v) {
+    return (v * 1021 + 2041) >> 12;
+}
+
+static void swapRBScalar(uint8_t* data, size_t pixels) {
+    for (size_t i = 0; i < pixels; ++i) {
+        std::swap(data[i * 4], data[i * 4 + 2]);
+    }
+}
+
+static void pack2101010Scalar(uint8_t* data, size_t pixels, bool flip) {
+    uint32_t* px = (uint32_t*)data;
+
+    for (size_t i = 0; i < pixels; ++i) {
+        const uint32_t R = to8Bit(px[i] & 0x3FF);
+        const uint32_t G = to8Bit((px[i] >> 10) & 0x3FF);
+        const uint32_t B = to8Bit((px[i] >> 20) & 0x3FF);
+        const uint32_t A = (px[i] >> 30) * 85;
+
+        px[i] = (flip ? B : R) | (G << 8) | ((flip ? R : B) << 16) | (A << 24);
+    }
+}
+
+static void expand24RowScalar(const uint8_t* src, uint8_t* dst, uint32_t width) {
+    for (uint32_t x = 0; x < width; ++x) {
+        dst[x * 4]     = src[x * 3];
+        dst[x * 4 + 1] = src[x * 3 + 1];
+        dst[x * 4 + 2] = src[x * 3 + 2];
+        dst[x * 4 + 3] = 0xFF;
+    }
+}
+
+#ifdef PIXELCONVERT_X86
+__attribute__((target("sse4.1"))) static void swapRBSSE(uint8_t* data, size_t pixels) {
+    const __m128i MASK = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    size_t        i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        const __m128i V = _mm_loadu_si128((const __m128i*)(data + i * 4));
+        _mm_storeu_si128((__m128i*)(data + i * 4), _mm_shuffle_epi8(V, MASK));
+    }
+
+    swapRBScalar(data + i * 4, pixels - i);
+}
+
+__attribute__((target("sse4.1"))) static inline __m128i to8BitSSE(__m128i v) {
+    return _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(v, _mm_set1_epi32(1021)), _mm_set1_epi32(2041)), 12);
+}
+
+__attribute__((target("sse4.1"))) static void pack2101010SSE(uint8_t* data, size_t pixels, bool flip) {
+    const __m128i MASK = _mm_set1_epi32(0x3FF);
+
+    size_t        i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        const __m128i P = _mm_loadu_si128((const __m128i*)(data + i * 4));
+
+        __m128i       r = to8BitSSE(_mm_and_si128(P, MASK));
+        const __m128i G = to8BitSSE(_mm_and_si128(_mm_srli_epi32(P, 10), MASK));
+        __m128i       b = to8BitSSE(_mm_and_si128(_mm_srli_epi32(P, 20), MASK));
+        const __m128i A = _mm_mullo_epi32(_mm_srli_epi32(P, 30), _mm_set1_epi32(85));
+
+        if (flip)
+            std::swap(r, b);
+
+        const __m128i OUT = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(G, 8)), _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(A, 24)));
+        _mm_storeu_si128((__m128i*)(data + i * 4), OUT);
+    }
+
+    pack2101010Scalar(data + i * 4, pixels - i, flip);
+}
+
+__attribute__((target("sse4.1"))) static void expand24RowSSE(const uint8_t* src, uint8_t* dst, uint32_t width) {
+    const __m128i MASK  = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i ALPHA = _mm_set1_epi32((int)0xFF000000);
+
+    uint32_t      x = 0;
+    // Each load reads 16 bytes for 4 pixels, stay clear of the end of the row.
+    for (; x + 6 <= width; x += 4) {
+        const __m128i V = _mm_loadu_si128((const __m128i*)(src + x * 3));
+        _mm_storeu_si128((__m128i*)(dst + x * 4), _mm_or_si128(_mm_shuffle_epi8(V, MASK), ALPHA));
+    }
+
+    expand24RowScalar(src + x * 3, dst + x * 4, width - x);
+}
+
+__attribute__((target("avx2"))) static void swapRBAVX2(uint8_t* data, size_t pixels) {
+    const __m256i MASK = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    size_t        i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        const __m256i V = _mm256_loadu_si256((const __m256i*)(data + i * 4));
+        _mm256_storeu_si256((__m256i*)(data + i * 4), _mm256_shuffle_epi8(V, MASK));
+    }
+
+    swapRBScalar(data + i * 4, pixels - i);
+}
+
+__attribute__((target("avx2"))) static inline __m256i to8BitAVX2(__m256i v) {
+    return _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(v, _mm256_set1_epi32(1021)), _mm256_set1_epi32(2041)), 12);
+}
+
+__attribute__((target("avx2"))) static void pack2101010AVX2(uint8_t* data, size_t pixels, bool flip) {
+    const __m256i MASK = _mm256_set1_epi32(0x3FF);
+
+    size_t        i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        const __m256i P = _mm256_loadu_si256((const __m256i*)(data + i * 4));
+
+        __m256i       r = to8BitAVX2(_mm256_and_si256(P, MASK));
+        const __m256i G = to8BitAVX2(_mm256_and_si256(_mm256_srli_epi32(P, 10), MASK));
+        __m256i       b = to8BitAVX2(_mm256_and_si256(_mm256_srli_epi32(P, 20), MASK));
+        const __m256i A = _mm256_mullo_epi32(_mm256_srli_epi32(P, 30), _mm256_set1_epi32(85));
+
+        if (flip)
+            std::swap(r, b);
+
+        const __m256i OUT = _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(G, 8)), _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_slli_epi32(A, 24)));
+        _mm256_storeu_si256((__m256i*)(data + i * 4), OUT);
+    }
+
+    pack2101010Scalar(data + i * 4, pixels - i, flip);
+}
+
+__attribute__((target("avx2"))) static void expand24RowAVX2(const uint8_t* src, uint8_t* dst, uint32_t width) {
+    const __m256i MASK  = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i ALPHA = _mm256_set1_epi32((int)0xFF000000);
+
+    uint32_t      x = 0;
+    // Two 16 byte loads for 8 pixels, the second one starts 12 bytes in.
+    for (; x + 10 <= width; x += 8) {
+        const __m128i LO = _mm_loadu_si128((const __m128i*)(src + x * 3));
+        const __m128i HI = _mm_loadu_si128((const __m128i*)(src + x * 3 + 12));
+        const __m256i V  = _mm256_inserti128_si256(_mm256_castsi128_si256(LO), HI, 1);
+        _mm256_storeu_si256((__m256i*)(dst + x * 4), _mm256_or_si256(_mm256_shuffle_epi8(V, MASK), ALPHA));
+    }
+
+    expand24RowScalar(src + x * 3, dst + x * 4, width - x);
+}
+#endif
+
+#ifdef PIXELCONVERT_NEON
+static void swapRBNEON(uint8_t* data, size_t pixels) {
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x4_t v = vld4q_u8(data + i * 4);
+        std::swap(v.val[0], v.val[2]);
+        vst4q_u8(data + i * 4, v);
+    }
+
+    swapRBScalar(data + i * 4, pixels - i);
+}
+
+static inline uint32x4_t to8BitNEON(uint32x4_t v) {
+    return vshrq_n_u32(vmlaq_u32(vdupq_n_u32(2041), v, vdupq_n_u32(1021)), 12);
+}
+
+static void pack2101010NEON(uint8_t* data, size_t pixels, bool flip) {
+    const uint32x4_t MASK = vdupq_n_u32(0x3FF);
+
+    size_t           i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        const uint32x4_t P = vld1q_u32((const uint32_t*)(data + i * 4));
+
+        uint32x4_t       r = to8BitNEON(vandq_u32(P, MASK));
+        const uint32x4_t G = to8BitNEON(vandq_u32(vshrq_n_u32(P, 10), MASK));
+        uint32x4_t       b = to8BitNEON(vandq_u32(vshrq_n_u32(P, 20), MASK));
+        const uint32x4_t A = vmulq_n_u32(vshrq_n_u32(P, 30), 85);
+
+        if (flip)
+            std::swap(r, b);
+
+        vst1q_u32((uint32_t*)(data + i * 4), vorrq_u32(vorrq_u32(r, vshlq_n_u32(G, 8)), vorrq_u32(vshlq_n_u32(b, 16), vshlq_n_u32(A, 24))));
+    }
+
+    pack2101010Scalar(data + i * 4, pixels - i, flip);
+}
+
+static void expand24RowNEON(const uint8_t* src, uint8_t* dst, uint32_t width) {
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16x3_t V   = vld3q_u8(src + x * 3);
+        const uint8x16x4_t OUT = {{V.val[0], V.val[1], V.val[2], vdupq_n_u8(0xFF)}};
+        vst4q_u8(dst + x * 4, OUT);
+    }
+
+    expand24RowScalar(src + x * 3, dst + x * 4, width - x);
+}
+#endif
+
+struct SKernels {
+    void (*swapRB)(uint8_t*, size_t)                        = swapRBScalar;
+    void (*pack2101010)(uint8_t*, size_t, bool)             = pack2101010Scalar;
+    void (*expand24Row)(const uint8_t*, uint8_t*, uint32_t) = expand24RowScalar;
+    const char* name                                        = "scalar";
+};
+
+// Every kernel set the cpu supports, the fastest one last.
+static std::vector<SKernels> availableKernels() {
+    std::vector<SKernels> kernels = {SKernels{}};
+#ifdef PIXELCONVERT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.1"))
+        kernels.push_back({.swapRB = swapRBSSE, .pack2101010 = pack2101010SSE, .expand24Row = expand24RowSSE, .name = "sse4.1"});
+    if (__builtin_cpu_supports("avx2"))
+        kernels.push_back({.swapRB = swapRBAVX2, .pack2101010 = pack2101010AVX2, .expand24Row = expand24RowAVX2, .name = "avx2"});
+#elif defined(PIXELCONVERT_NEON)
+    kernels.push_back({.swapRB = swapRBNEON, .pack2101010 = pack2101010NEON, .expand24Row = expand24RowNEON, .name = "neon"});
+#endif
+    return kernels;
+}
+
+static SKernels& kernels() {
+    static SKernels selected = availableKernels().back();
+    return selected;
+}
+
+// Threads for large images, started on first use and kept until exit.
+// Frames of several outputs are converted one after another, each conversion would otherwise start and join its own threads.
+class CWorkers {
+  public:
+    CWorkers(size_t threads) {
+        for (size_t i = 0; i < threads; ++i) {
+            m_threads.emplace_back([this]() { workerThread(); });
+        }
+    }
+
+    ~CWorkers() {
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_exit = true;
+        }
+        m_cv.notify_all();
+
+        for (auto& t : m_threads) {
+            t.join();
+        }
+    }
+
+    // Calls fn(i) for every i in [0, count) on the workers and the calling thread. Returns once all calls returned.
+    void run(size_t count, const std::function<void(size_t)>& fn) {
+        std::lock_guard<std::mutex> runLock(m_runMutex);
+
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_job     = &fn;
+            m_next    = 0;
+            m_count   = count;
+            m_pending = count;
+        }
+        m_cv.notify_all();
+
+        std::unique_lock<std::mutex> lk(m_mutex);
+        while (m_next < m_count) {
+            runNext(lk);
+        }
+
+        m_doneCV.wait(lk, [this] { return m_pending == 0; });
+        m_job = nullptr;
+    }
+
+  private:
+    // Called with lk held, returns with it held.
+    void runNext(std::unique_lock<std::mutex>& lk) {
+        const size_t I   = m_next++;
+        const auto*  JOB = m_job;
+        lk.unlock();
+
+        (*JOB)(I);
+
+        lk.lock();
+        if (--m_pending == 0)
+            m_doneCV.notify_all();
+    }
+
+    void workerThread() {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        while (true) {
+            m_cv.wait(lk, [this] { return m_exit || (m_job && m_next < m_count); });
+
+            if (m_exit)
+                return;
+
+            runNext(lk);
+        }
+    }
+
+    std::mutex                         m_runMutex; // one run at a time
+    std::mutex                         m_mutex;
+    std::condition_variable            m_cv;
+    std::condition_variable            m_doneCV;
+    const std::function<void(size_t)>* m_job     = nullptr;
+    size_t                             m_next    = 0;
+    size_t                             m_count   = 0;
+    size_t                             m_pending = 0;
+    bool                               m_exit    = false;
+    std::vector<std::thread>           m_threads;
+};
+
+// Calls fn with consecutive ranges covering [0, count), in parallel if the image is large enough.
+static void parallelFor(size_t count, size_t pixelsPerItem, const std::function<void(size_t begin, size_t end)>& fn) {
+    const size_t THREADS = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAXTHREADS);
+
+    if (THREADS == 1 || count * pixelsPerItem < PARALLELMINPIXELS) {
+        fn(0, count);
+        return;
+    }
+
+    // The calling thread takes part as well.
+    static CWorkers workers(THREADS - 1);
+
+    // Keep chunks aligned to 64 items, so threads don't write to the same cache lines.
+    const size_t CHUNK = (((count + THREADS - 1) / THREADS) + 63) & ~(size_t)63;
+
+    workers.run((count + CHUNK - 1) / CHUNK, [&fn, count, CHUNK](size_t i) { fn(i * CHUNK, std::min(count, (i + 1) * CHUNK)); });
+}
+
+void PixelConvert::swapRB(uint8_t* data, size_t pixels) {
+    parallelFor(pixels, 1, [data](size_t begin, size_t end) { kernels().swapRB(data + begin * 4, end - begin); });
+}
+
+void PixelConvert::pack2101010(uint8_t* data, size_t pixels, bool flip) {
+    parallelFor(pixels, 1, [data, flip](size_t begin, size_t end) { kernels().pack2101010(data + begin * 4, end - begin, flip); });
+}
+
+void PixelConvert::expand24(const uint8_t* src, size_t srcStride, uint8_t* dst, uint32_t width, uint32_t height) {
+    parallelFor(height, width, [src, srcStride, dst, width](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; ++y) {
+            kernels().expand24Row(src + y * srcStride, dst + y * width * 4, width);
+        }
+    });
+}
+
+const char* PixelConvert::implName() {
+    return kernels().name;
+}
+
+bool PixelConvert::setImpl(std::string_view name) {
+    for (const auto& k : availableKernels()) {
+        if (name != k.name)
+            continue;
+
+        kernels() = k;
+        return true;
+    }
+
+    return false;
+}
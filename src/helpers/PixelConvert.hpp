@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Pixel format conversions for shm screencopy buffers.
+// Uses AVX2, SSE4.1 or NEON when the cpu supports them and splits large images across a few threads.
+// Results are identical to the plain per pixel conversion.
+namespace PixelConvert {
+    // Swaps the first and third byte of every 4 byte pixel. ARGB8888 -> RGBA byte order.
+    void swapRB(uint8_t* data, size_t pixels);
+    // Converts 2101010 pixels to 8 bits per channel in place. If flip is set, red and blue swap places.
+    void pack2101010(uint8_t* data, size_t pixels, bool flip);
+    // Expands 3 byte pixels to 4 bytes with an opaque alpha. dst must hold width * height * 4 bytes.
+    void expand24(const uint8_t* src, size_t srcStride, uint8_t* dst, uint32_t width, uint32_t height);
+
+    // Name of the selected instruction set, for logging.
+    const char* implName();
+    // Selects the kernels by name ("scalar", "sse4.1", "avx2" or "neon"), for tests and benchmarks.
+    // Returns false if the cpu does not support them. Not thread safe, call it before converting anything.
+    bool        setImpl(std::string_view name);
+}
@@ -0,0 +1,184 @@
+#include "VariableProviders.hpp"
+
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string_view>
+#include <sys/sysinfo.h>
+#include <unistd.h>
+
+static std::string readLine(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    std::string   line;
+    if (file.good())
+        std::getline(file, line);
+
+    return line;
+}
+
+// The named battery, or the first one in /sys/class/power_supply.
+static std::filesystem::path findBattery(const std::string& name) {
+    const std::filesystem::path POWERSUPPLY = "/sys/class/power_supply";
+
+    if (!name.empty())
+        return POWERSUPPLY / name;
+
+    std::error_code ec;
+    for (const auto& e : std::filesystem::directory_iterator(POWERSUPPLY, ec)) {
+        if (readLine(e.path() / "type") == "Battery")
+            return e.path();
+    }
+
+    return {};
+}
+
+// $DATE{fmt}, local time formatted with strftime.
+class CDateProvider : public IVariableProvider {
+  public:
+    std::string name() const override {
+        return "DATE";
+    }
+
+    std::chrono::milliseconds interval(const std::string& arg) const override {
+        const std::string FORMAT = arg.empty() ? DEFAULTFORMAT : arg;
+        // Only conversions that show seconds need a second. Minutes, hours and the date are fine with a minute.
+        for (size_t i = 0; i + 1 < FORMAT.size(); i++) {
+            if (FORMAT[i] != '%')
+                continue;
+
+            i++;
+            if ((FORMAT[i] == 'E' || FORMAT[i] == 'O') && i + 1 < FORMAT.size())
+                i++;
+
+            if (std::string_view{"STscXr"}.contains(FORMAT[i]))
+                return std::chrono::seconds(1);
+        }
+
+        return std::chrono::minutes(1);
+    }
+
+    bool alignToClock() const override {
+        return true;
+    }
+
+    std::string value(const std::string& arg) override {
+        const auto NOW = std::time(nullptr);
+        std::tm    local;
+        if (!localtime_r(&NOW, &local))
+            return "";
+
+        char buf[256];
+        if (std::strftime(buf, sizeof(buf), arg.empty() ? DEFAULTFORMAT : arg.c_str(), &local) == 0)
+            return "";
+
+        return buf;
+    }
+
+  private:
+    static constexpr const char* DEFAULTFORMAT = "%A, %d %B %Y";
+};
+
+// $BATTERY{name}, the charge in percent.
+class CBatteryProvider : public IVariableProvider {
+  public:
+    std::string name() const override {
+        return "BATTERY";
+    }
+
+    std::chrono::milliseconds interval(const std::string& arg) const override {
+        return std::chrono::seconds(30);
+    }
+
+    std::string value(const std::string& arg) override {
+        const auto BATTERY = findBattery(arg);
+        return BATTERY.empty() ? "" : readLine(BATTERY / "capacity");
+    }
+};
+
+// $BATTERY_STATUS{name}, Charging, Discharging, Full, ...
+class CBatteryStatusProvider : public IVariableProvider {
+  public:
+    std::string name() const override {
+        return "BATTERY_STATUS";
+    }
+
+    std::chrono::milliseconds interval(const std::string& arg) const override {
+        return std::chrono::seconds(5);
+    }
+
+    std::string value(const std::string& arg) override {
+        const auto BATTERY = findBattery(arg);
+        return BATTERY.empty() ? "" : readLine(BATTERY / "status");
+    }
+};
+
+class CHostnameProvider : public IVariableProvider {
+  public:
+    std::string name() const override {
+        return "HOSTNAME";
+    }
+
+    std::chrono::milliseconds interval(const std::string& arg) const override {
+        return std::chrono::milliseconds(0);
+    }
+
+    std::string value(const std::string& arg) override {
+        char buf[256] = {0};
+        if (gethostname(buf, sizeof(buf) - 1) != 0)
+            return "";
+
+        return buf;
+    }
+};
+
+// $UPTIME, like "3d 4h 12m".
+class CUptimeProvider : public IVariableProvider {
+  public:
+    std::string name() const override {
+        return "UPTIME";
+    }
+
+    std::chrono::milliseconds interval(const std::string& arg) const override {
+        return std::chrono::minutes(1);
+    }
+
+    std::string value(const std::string& arg) override {
+        struct sysinfo info;
+        if (sysinfo(&info) != 0)
+            return "";
+
+        const auto DAYS  = info.uptime / 86400;
+        const auto HOURS = info.uptime / 3600 % 24;
+        const auto MINS  = info.uptime / 60 % 60;
+
+        if (DAYS > 0)
+            return std::format("{}d {}h {}m", DAYS, HOURS, MINS);
+        if (HOURS > 0)
+            return std::format("{}h {}m", HOURS, MINS);
+        return std::format("{}m", MINS);
+    }
+};
+
+CVariableProviders::CVariableProviders() {
+    registerProvider(makeUnique<CDateProvider>());
+    registerProvider(makeUnique<CBatteryProvider>());
+    registerProvider(makeUnique<CBatteryStatusProvider>());
+    registerProvider(makeUnique<CHostnameProvider>());
+    registerProvider(makeUnique<CUptimeProvider>());
+}
+
+void CVariableProviders::registerProvider(UP<IVariableProvider>&& provider) {
+    m_providers.emplace_back(std::move(provider));
+    std::ranges::stable_sort(m_providers, [](const auto& a, const auto& b) { return a->name().length() > b->name().length(); });
+}
+
+IVariableProvider* CVariableProviders::match(std::string_view str) const {
+    for (const auto& provider : m_providers) {
+        if (str.starts_with(provider->name()))
+            return provider.get();
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../defines.hpp"
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A label variable computed in process, instead of a cmd[] label running a helper for it.
+class IVariableProvider {
+  public:
+    virtual ~IVariableProvider() = default;
+
+    // The variable without the $. An argument can follow in braces, $NAME{arg}.
+    virtual std::string               name() const = 0;
+    // How often a label showing the variable should update. Zero if the value does not change.
+    virtual std::chrono::milliseconds interval(const std::string& arg) const = 0;
+    virtual std::string               value(const std::string& arg)          = 0;
+    // Whether the value changes when the wall clock reaches a multiple of the interval, like a clock does.
+    virtual bool alignToClock() const {
+        return false;
+    }
+};
+
+class CVariableProviders {
+  public:
+    // Registers the builtin providers.
+    CVariableProviders();
+
+    void               registerProvider(UP<IVariableProvider>&& provider);
+
+    // The provider with the longest name that str starts with, nullptr if none.
+    IVariableProvider* match(std::string_view str) const;
+
+  private:
+    // Longest name first, so that $BATTERY does not match $BATTERY_STATUS.
+    std::vector<UP<IVariableProvider>> m_providers;
+};
+
+inline UP<CVariableProviders> g_pVariableProviders = makeUnique<CVariableProviders>();
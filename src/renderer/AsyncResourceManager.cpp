@@ -1,6 +1,7 @@
 #include "AsyncResourceManager.hpp"
 
-#include "./resources/TextCmdResource.hpp"
+#include "./Framebuffer.hpp"
+#include "./Renderer.hpp"
 #include "../helpers/Log.hpp"
 #include "../helpers/MiscFunctions.hpp"
 #include "../core/hyprlock.hpp"
@@ -8,6 +9,8 @@
 #include "../core/Egl.hpp"
 
 #include <algorithm>
+#include <bit>
+#include <cmath>
 #include <cstdint>
 #include <functional>
 #include <sys/eventfd.h>
@@ -16,75 +19,168 @@
 using namespace Hyprgraphics;
 using namespace Hyprutils::OS;
 
+CAsyncResourceManager::CAsyncResourceManager() :
+    m_scheduler([](ResourceID id, const ASP<IAsyncResource>& resource) {
+        // Called from a scheduler thread.
+        if (!g_pHyprlock)
+            return;
+
+        g_pHyprlock->addTimer(
+            std::chrono::milliseconds(0),
+            [id, resource](auto, auto) {
+                if (g_asyncResourceManager)
+                    g_asyncResourceManager->onResourceFinished(id, resource);
+            },
+            nullptr, false, TIMER_OWNER_RESOURCES);
+    }),
+    m_uploader([](ResourceID id) {
+        // Called from the uploader thread.
+        if (!g_pHyprlock)
+            return;
+
+        g_pHyprlock->addTimer(
+            std::chrono::milliseconds(0),
+            [](auto, void* resourceID) {
+                if (g_asyncResourceManager)
+                    g_asyncResourceManager->onResourceStaged((size_t)resourceID);
+            },
+            (void*)id, false, TIMER_OWNER_RESOURCES);
+    }) {
+    ;
+}
+
 static inline ResourceID scopeResourceID(uint8_t scope, size_t in) {
     return (in & ~0x0f) | scope;
 }
 
-ResourceID CAsyncResourceManager::resourceIDForTextRequest(const CTextResource::STextResourceData& s) {
-    // TODO: Currently ignores the font string and resulting distribution is probably not perfect.
-    const auto H1 = std::hash<std::string>{}(s.text);
-    const auto H2 = std::hash<double>{}(s.color.asRgb().r);
-    const auto H3 = std::hash<double>{}(s.color.asRgb().g) + s.fontSize;
-    const auto H4 = std::hash<double>{}(s.color.asRgb().b) + s.align;
+// splitmix64 finalizer, every input bit affects every output bit.
+static inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
 
-    return scopeResourceID(1, H1 ^ (H2 << 1) ^ (H3 << 2) ^ (H4 << 3));
+static inline void hashCombine(uint64_t& seed, uint64_t value) {
+    seed = mix64(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
 }
 
-ResourceID CAsyncResourceManager::resourceIDForTextCmdRequest(const CTextResource::STextResourceData& s, size_t revision) {
-    return scopeResourceID(2, resourceIDForTextRequest(s) ^ (revision << 32));
+uint64_t CAsyncResourceManager::SResourceKey::hash() const {
+    uint64_t h = scope;
+    hashCombine(h, std::hash<std::string>{}(text));
+    hashCombine(h, std::hash<std::string>{}(font));
+    hashCombine(h, fontSize);
+    hashCombine(h, std::bit_cast<uint64_t>(r));
+    hashCombine(h, std::bit_cast<uint64_t>(g));
+    hashCombine(h, std::bit_cast<uint64_t>(b));
+    hashCombine(h, align);
+    hashCombine(h, revision);
+    hashCombine(h, std::bit_cast<uint64_t>(targetSize.x));
+    hashCombine(h, std::bit_cast<uint64_t>(targetSize.y));
+    hashCombine(h, fit);
+    return h;
 }
 
-ResourceID CAsyncResourceManager::resourceIDForImageRequest(const std::string& path, size_t revision) {
-    return scopeResourceID(3, std::hash<std::string>{}(path) ^ (revision << 32));
+CAsyncResourceManager::SResourceKey CAsyncResourceManager::keyForTextRequest(const CTextResource::STextResourceData& s) {
+    const auto RGB = s.color.asRgb();
+    return SResourceKey{
+        .scope    = RESOURCE_SCOPE_TEXT,
+        .text     = s.text,
+        .font     = s.font,
+        .fontSize = s.fontSize,
+        .r        = RGB.r,
+        .g        = RGB.g,
+        .b        = RGB.b,
+        .align    = s.align,
+    };
+}
+
+CAsyncResourceManager::SResourceKey CAsyncResourceManager::keyForTextCmdRequest(const CTextResource::STextResourceData& s, size_t revision) {
+    auto key     = keyForTextRequest(s);
+    key.scope    = RESOURCE_SCOPE_TEXTCMD;
+    key.revision = revision;
+    return key;
+}
+
+CAsyncResourceManager::SResourceKey CAsyncResourceManager::keyForImageRequest(const std::string& path, size_t revision, const Vector2D& targetSize, eImageFit fit) {
+    return SResourceKey{
+        .scope      = RESOURCE_SCOPE_IMAGE,
+        .text       = path,
+        .revision   = revision,
+        .targetSize = targetSize,
+        .fit        = fit,
+    };
 }
 
 ResourceID CAsyncResourceManager::resourceIDForScreencopy(const std::string& port) {
-    return scopeResourceID(4, std::hash<std::string>{}(port));
+    return scopeResourceID(RESOURCE_SCOPE_SCREENCOPY, std::hash<std::string>{}(port));
 }
 
-ResourceID CAsyncResourceManager::requestText(const CTextResource::STextResourceData& params, const AWP<IWidget>& widget) {
-    const auto RESOURCEID = resourceIDForTextRequest(params);
+ResourceID CAsyncResourceManager::resolveID(const SResourceKey& key) {
+    uint64_t h = key.hash();
+
+    while (true) {
+        const auto ID = scopeResourceID(key.scope, h);
+        const auto IT = m_keys.find(ID);
+        if (IT == m_keys.end()) {
+            m_keys.emplace(ID, key);
+            return ID;
+        }
+
+        if (IT->second == key)
+            return ID;
+
+        // Same id, different parameters. Probe the next one.
+        m_collisions++;
+        Log::logger->log(Log::WARN, "Resource id collision for {} (\"{}\" and \"{}\")", ID, IT->second.text, key.text);
+        h = mix64(h + 1);
+    }
+}
+
+CResourceHandle CAsyncResourceManager::requestText(const CTextResource::STextResourceData& params, const AWP<IWidget>& widget, eResourcePriority priority) {
+    const auto RESOURCEID = resolveID(keyForTextRequest(params));
     if (request(RESOURCEID, widget)) {
         Log::logger->log(Log::TRACE, "Reusing text resource \"{}\" (resourceID: {})", params.text, RESOURCEID, (uintptr_t)widget.get());
-        return RESOURCEID;
+        return CResourceHandle{RESOURCEID};
     }
 
     auto                                 resource = makeAtomicShared<CTextResource>(CTextResource::STextResourceData{params});
     CAtomicSharedPointer<IAsyncResource> resourceGeneric{resource};
 
     Log::logger->log(Log::TRACE, "Requesting text resource \"{}\" (resourceID: {})", params.text, RESOURCEID, (uintptr_t)widget.get());
-    enqueue(RESOURCEID, resourceGeneric, widget);
-    return RESOURCEID;
+    enqueue(RESOURCEID, resourceGeneric, widget, priority);
+    return CResourceHandle{RESOURCEID};
 }
 
-ResourceID CAsyncResourceManager::requestTextCmd(const CTextResource::STextResourceData& params, size_t revision, const AWP<IWidget>& widget) {
-    const auto RESOURCEID = resourceIDForTextCmdRequest(params, revision);
+CResourceHandle CAsyncResourceManager::requestTextCmd(const CTextResource::STextResourceData& params, size_t revision, const AWP<IWidget>& widget, eResourcePriority priority,
+                                                      std::chrono::milliseconds timeout) {
+    const auto RESOURCEID = resolveID(keyForTextCmdRequest(params, revision));
     if (request(RESOURCEID, widget)) {
         Log::logger->log(Log::TRACE, "Reusing text cmd resource \"{}\" revision {} (resourceID: {})", params.text, revision, RESOURCEID, (uintptr_t)widget.get());
-        return RESOURCEID;
+        return CResourceHandle{RESOURCEID};
     }
 
-    auto                                 resource = makeAtomicShared<CTextCmdResource>(CTextResource::STextResourceData{params});
-    CAtomicSharedPointer<IAsyncResource> resourceGeneric{resource};
-
     Log::logger->log(Log::TRACE, "Requesting text cmd resource \"{}\" revision {} (resourceID: {})", params.text, revision, RESOURCEID, (uintptr_t)widget.get());
-    enqueue(RESOURCEID, resourceGeneric, widget);
-    return RESOURCEID;
+    runCommand(RESOURCEID, params, widget, priority, timeout);
+    return CResourceHandle{RESOURCEID};
 }
 
-ResourceID CAsyncResourceManager::requestImage(const std::string& path, size_t revision, const AWP<IWidget>& widget) {
-    const auto RESOURCEID = resourceIDForImageRequest(path, revision);
+CResourceHandle CAsyncResourceManager::requestImage(const std::string& path, size_t revision, const AWP<IWidget>& widget, const Vector2D& targetSize, eImageFit fit,
+                                                    eResourcePriority priority) {
+    const auto RESOURCEID = resolveID(keyForImageRequest(path, revision, targetSize, fit));
     if (request(RESOURCEID, widget)) {
-        Log::logger->log(Log::TRACE, "Reusing image resource {} revision {} (resourceID: {})", path, revision, RESOURCEID, (uintptr_t)widget.get());
-        return RESOURCEID;
+        Log::logger->log(Log::TRACE, "Reusing image resource {} revision {} target {} (resourceID: {})", path, revision, targetSize, RESOURCEID, (uintptr_t)widget.get());
+        return CResourceHandle{RESOURCEID};
     }
 
-    auto                                 resource = makeAtomicShared<CImageResource>(absolutePath(path, ""));
+    auto                                 resource = makeAtomicShared<CScaledImageResource>(absolutePath(path, ""), targetSize, fit);
     CAtomicSharedPointer<IAsyncResource> resourceGeneric{resource};
 
-    Log::logger->log(Log::TRACE, "Requesting image resource {} revision {} (resourceID: {})", path, revision, RESOURCEID, (uintptr_t)widget.get());
-    enqueue(RESOURCEID, resourceGeneric, widget);
-    return RESOURCEID;
+    Log::logger->log(Log::TRACE, "Requesting image resource {} revision {} target {} (resourceID: {})", path, revision, targetSize, RESOURCEID, (uintptr_t)widget.get());
+    enqueue(RESOURCEID, resourceGeneric, widget, priority);
+    return CResourceHandle{RESOURCEID};
 }
 
 ASP<CTexture> CAsyncResourceManager::getAssetByID(size_t id) {
@@ -95,16 +191,22 @@ ASP<CTexture> CAsyncResourceManager::getAssetByID(size_t id) {
 }
 
 void CAsyncResourceManager::enqueueStaticAssets() {
-    const auto CWIDGETS = g_pConfigManager->getWidgetConfigs();
+    for (const auto& c : g_pConfigManager->getWidgetConfigs()) {
+        if (const auto* IMAGE = std::get_if<SImageConfig>(&c.values); IMAGE && !IMAGE->path.empty() && IMAGE->path != "screenshot") {
+            m_staticAssets.emplace_back(requestImage(IMAGE->path, 0, nullptr, Vector2D{IMAGE->size, IMAGE->size}, IMAGE_FIT_COVER));
+            continue;
+        }
 
-    for (auto& c : CWIDGETS) {
-        if (c.type == "background" || c.type == "image") {
-            std::string path = std::any_cast<Hyprlang::STRING>(c.values.at("path"));
+        const auto* BACKGROUND = std::get_if<SBackgroundConfig>(&c.values);
+        if (!BACKGROUND || BACKGROUND->path.empty() || BACKGROUND->path == "screenshot")
+            continue;
 
-            if (path.empty() || path == "screenshot")
+        // Backgrounds cover the output they are displayed on. The mode size, like CBackground requests it once the lock surface exists.
+        for (const auto& MON : g_pHyprlock->m_vOutputs) {
+            if (!MON->matchesMonitor(c.monitor))
                 continue;
 
-            requestImage(path, 0, nullptr);
+            m_staticAssets.emplace_back(requestImage(BACKGROUND->path, 0, nullptr, MON->size, IMAGE_FIT_COVER, RESOURCE_PRIORITY_BACKGROUND));
         }
     }
 }
@@ -121,13 +223,59 @@ void CAsyncResourceManager::enqueueScreencopyFrames() {
     }
 }
 
+// After the fade-in the screencopy is only mixed into the fade-out, that does not need the full resolution.
+// Unless a background on the output shows the screenshot without blur.
+static float screencopyScaleFor(const SP<COutput>& output) {
+    static const auto SCSCALE = g_pConfigManager->getValue<Hyprlang::FLOAT>("general:screencopy_scale");
+
+    const float       SCALE = std::clamp<float>(*SCSCALE, 0.1F, 1.F);
+    if (SCALE >= 1.F || !output)
+        return 1.F;
+
+    for (const auto& c : g_pConfigManager->getWidgetConfigs()) {
+        const auto* BACKGROUND = std::get_if<SBackgroundConfig>(&c.values);
+        if (!BACKGROUND || !output->matchesMonitor(c.monitor))
+            continue;
+
+        if (BACKGROUND->path == "screenshot" && BACKGROUND->blurPasses == 0)
+            return 1.F;
+    }
+
+    return SCALE;
+}
+
+// Renders the capture into a smaller texture. The full resolution texture is released by the caller.
+static ASP<CTexture> shrinkScreencopy(const ASP<CTexture>& texture, float scale) {
+    const Vector2D SIZE = {std::max(1.0, std::round(texture->m_vSize.x * scale)), std::max(1.0, std::round(texture->m_vSize.y * scale))};
+
+    g_pEGL->makeCurrent(nullptr);
+
+    // Imported captures sample with GL_NEAREST, linear filtering averages the skipped texels.
+    glBindTexture(GL_TEXTURE_2D, texture->m_iTexID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    CFramebuffer fb;
+    fb.alloc(SIZE.x, SIZE.y);
+    fb.bind();
+
+    CRenderer::renderTextureWith(g_pRenderer->getShaders(), Mat3x3::outputProjection(SIZE, HYPRUTILS_TRANSFORM_NORMAL), CBox{{}, SIZE}, *texture, 1.0, 0,
+                                 HYPRUTILS_TRANSFORM_NORMAL);
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+    return fb.releaseTexture();
+}
+
 void CAsyncResourceManager::screencopyToTexture(const CScreencopyFrame& scFrame) {
     if (!scFrame.m_ready || !m_assets.contains(scFrame.m_resourceID)) {
         Log::logger->log(Log::ERR, "Bogus call to CAsyncResourceManager::screencopyToTexture. This is a bug!");
         return;
     }
 
-    m_assets[scFrame.m_resourceID].texture = scFrame.m_asset;
+    // The fade-in shows the capture 1:1, it is scaled down in shrinkScreencopyFrames once that finished.
+    setAssetTexture(scFrame.m_resourceID, scFrame.m_asset);
 
     Log::logger->log(Log::TRACE, "Done sc frame {}", scFrame.m_resourceID);
 
@@ -139,6 +287,36 @@ void CAsyncResourceManager::screencopyToTexture(const CScreencopyFrame& scFrame)
     }
 }
 
+void CAsyncResourceManager::shrinkScreencopyFrames() {
+    if (m_screencopyShrunk)
+        return;
+
+    m_screencopyShrunk = true;
+
+    bool shrunk = false;
+    for (const auto& output : g_pHyprlock->m_vOutputs) {
+        const auto IT = m_assets.find(resourceIDForScreencopy(output->stringPort));
+        if (IT == m_assets.end() || !IT->second.texture || IT->second.texture->m_iType == TEXTURE_INVALID)
+            continue;
+
+        const float SCALE = screencopyScaleFor(output);
+        if (SCALE >= 1.F)
+            continue;
+
+        const auto FULLSIZE = IT->second.texture->m_vSize;
+        setAssetTexture(IT->first, shrinkScreencopy(IT->second.texture, SCALE));
+        shrunk = true;
+
+        const auto SIZE = IT->second.texture->m_vSize;
+        Log::logger->log(Log::INFO, "Scaled sc frame {} from {} to {}, {:.1f} MiB less texture memory", IT->first, FULLSIZE, SIZE,
+                         (FULLSIZE.x * FULLSIZE.y - SIZE.x * SIZE.y) * 4 / (1024.F * 1024.F));
+    }
+
+    // Backgrounds swap to the scaled copies when they draw next.
+    if (shrunk)
+        g_pHyprlock->renderAllOutputs();
+}
+
 void CAsyncResourceManager::gatherInitialResources(wl_display* display) {
     const auto MAXDELAYMS    = 2000; // 2 Seconds
     const auto STARTGATHERTP = std::chrono::system_clock::now();
@@ -195,48 +373,143 @@ bool CAsyncResourceManager::checkIdPresent(ResourceID id) {
     return m_assets.contains(id);
 }
 
-void CAsyncResourceManager::unload(ASP<CTexture> texture) {
-    auto preload = std::ranges::find_if(m_assets, [texture](const auto& a) { return a.second.texture == texture; });
-    if (preload == m_assets.end())
+void CAsyncResourceManager::unloadById(ResourceID id) {
+    if (!m_assets.contains(id))
         return;
 
-    preload->second.refs--;
+    m_assets[id].refs--;
 
-    if (preload->second.refs == 0) {
-        Log::logger->log(Log::TRACE, "Releasing resourceID: {}!", preload->first);
-        m_assets.erase(preload->first);
-    }
+    if (m_assets[id].refs == 0)
+        release(id);
 }
 
-void CAsyncResourceManager::unloadById(ResourceID id) {
-    if (!m_assets.contains(id))
-        return;
+static size_t textureBytes(const ASP<CTexture>& texture) {
+    // Textures that used to be framebuffers are counted in g_renderTargetStats.
+    if (!texture || texture->m_iType == TEXTURE_INVALID || texture->m_renderTargetBytes)
+        return 0;
 
-    m_assets[id].refs--;
+    return (size_t)texture->m_vSize.x * texture->m_vSize.y * 4;
+}
+
+void CAsyncResourceManager::release(ResourceID id) {
+    const auto TEXTURE = m_assets[id].texture;
+    m_assets.erase(id);
+    m_assetBytes -= textureBytes(TEXTURE);
 
-    if (m_assets[id].refs == 0) {
+    // Nobody waits for it anymore.
+    if (!TEXTURE)
+        cancel(id);
+
+    // Command output is requested with a new revision every time, so those textures are never requested again.
+    if (!TEXTURE || TEXTURE->m_iType == TEXTURE_INVALID || (id & 0x0f) == RESOURCE_SCOPE_TEXTCMD) {
         Log::logger->log(Log::TRACE, "Releasing resourceID: {}!", id);
-        m_assets.erase(id);
+        m_keys.erase(id);
+        return;
+    }
+
+    Log::logger->log(Log::TRACE, "Retaining resourceID: {}", id);
+    m_retained.emplace_front(id, TEXTURE);
+    m_retainedByID[id] = m_retained.begin();
+    m_retainedBytes += textureBytes(TEXTURE);
+    evictRetained();
+}
+
+void CAsyncResourceManager::setAssetTexture(ResourceID id, const ASP<CTexture>& texture) {
+    auto& asset = m_assets[id];
+
+    m_assetBytes -= textureBytes(asset.texture);
+    m_assetBytes += textureBytes(texture);
+    asset.texture = texture;
+}
+
+void CAsyncResourceManager::evictRetained() {
+    static const auto VRAMBUDGET = g_pConfigManager->getValue<Hyprlang::INT>("general:vram_budget");
+
+    const size_t      BUDGET = (size_t)std::max<Hyprlang::INT>(*VRAMBUDGET, 0) * 1024 * 1024;
+    size_t            total  = m_assetBytes + m_retainedBytes + g_renderTargetStats.bytes;
+
+    while (total > BUDGET && !m_retained.empty()) {
+        const auto& [id, texture] = m_retained.back();
+        Log::logger->log(Log::TRACE, "Evicting retained resourceID: {}", id);
+
+        const size_t BYTES = textureBytes(texture);
+        total -= std::min(total, BYTES);
+        m_retainedBytes -= BYTES;
+        m_keys.erase(id);
+        m_retainedByID.erase(id);
+        m_retained.pop_back();
+        m_evictions++;
+    }
+
+    if (total > BUDGET && !m_warnedBudget) {
+        Log::logger->log(Log::WARN, "Textures and framebuffers in use take {:.1f} MiB, more than general:vram_budget ({} MiB)", total / (1024.F * 1024.F), *VRAMBUDGET);
+        m_warnedBudget = true;
     }
 }
 
+void CAsyncResourceManager::logStats() {
+    size_t assets = 0;
+    for (const auto& [id, asset] : m_assets) {
+        if (asset.texture)
+            assets++;
+    }
+
+    static const auto VRAMBUDGET = g_pConfigManager->getValue<Hyprlang::INT>("general:vram_budget");
+    const float       MIB        = 1024.F * 1024.F;
+
+    Log::logger->log(Log::INFO,
+                     "Resource memory: {} textures ({:.1f} MiB), {} retained ({:.1f} MiB), {} framebuffers ({:.1f} MiB, peak {:.1f} MiB), budget {} MiB, {} retention hits, "
+                     "{} evictions, {} deduplicated requests, {} id collisions, {} unchanged command outputs",
+                     assets, m_assetBytes / MIB, m_retained.size(), m_retainedBytes / MIB, g_renderTargetStats.count.load(), g_renderTargetStats.bytes / MIB,
+                     g_renderTargetStats.peakBytes / MIB, *VRAMBUDGET, m_retainHits, m_evictions, m_dedups, m_collisions, m_unchangedOutputs);
+
+    m_scheduler.logStats();
+    m_commands.logStats();
+}
+
 bool CAsyncResourceManager::request(ResourceID id, const AWP<IWidget>& widget) {
     if (!m_assets.contains(id)) {
-        // New asset!!
-        m_assets.emplace(id, SPreloadedTexture{.texture = nullptr, .refs = 1});
-        return false;
-    }
+        const auto RETAINED = m_retainedByID.find(id);
+        if (RETAINED == m_retainedByID.end()) {
+            // New asset!!
+            m_assets.emplace(id, SPreloadedTexture{.texture = nullptr, .refs = 1});
+            return false;
+        }
+
+        // Released recently, bring it back.
+        const auto TEXTURE = RETAINED->second->second;
+        const auto BYTES   = textureBytes(TEXTURE);
+        m_assets.emplace(id, SPreloadedTexture{.texture = TEXTURE, .refs = 0});
+        m_assetBytes += BYTES;
+        m_retainedBytes -= BYTES;
+        m_retained.erase(RETAINED->second);
+        m_retainedByID.erase(RETAINED);
+        m_retainHits++;
+    } else
+        m_dedups++;
 
     m_assets[id].refs++;
 
     if (m_assets[id].texture) {
-        // Asset already present. Dispatch the asset callback function.
-        const auto& TEXTURE = m_assets[id].texture;
-        if (auto w = widget.lock()) {
-            w->onAssetUpdate(id, TEXTURE);
-
-            // TODO: add a centalized mechanism to render in one place in the event loop to avoid duplicate render calls
-            g_pHyprlock->addTimer(std::chrono::milliseconds(0), [](auto, auto) { g_pHyprlock->renderAllOutputs(); }, nullptr);
+        // Asset already present. Dispatch the asset callback function once the caller holds the handle.
+        if (widget) {
+            g_pHyprlock->addTimer(
+                std::chrono::milliseconds(0),
+                [id, widget](auto, auto) {
+                    if (!g_asyncResourceManager)
+                        return;
+
+                    const auto TEXTURE = g_asyncResourceManager->getAssetByID(id);
+                    auto       w       = widget.lock();
+                    if (!TEXTURE || !w)
+                        return;
+
+                    w->onAssetUpdate(id, TEXTURE);
+
+                    // TODO: add a centalized mechanism to render in one place in the event loop to avoid duplicate render calls
+                    g_pHyprlock->renderAllOutputs();
+                },
+                nullptr, false, TIMER_OWNER_RESOURCES);
         }
     } else if (widget) {
         // Asset currently in-flight. Add the widget reference to in order for the callback to get dispatched later.
@@ -253,85 +526,193 @@ bool CAsyncResourceManager::request(ResourceID id, const AWP<IWidget>& widget) {
     return true;
 }
 
-void CAsyncResourceManager::enqueue(ResourceID resourceID, const ASP<IAsyncResource>& resource, const AWP<IWidget>& widget) {
-    m_gatherer.enqueue(resource);
-
+void CAsyncResourceManager::enqueue(ResourceID resourceID, const ASP<IAsyncResource>& resource, const AWP<IWidget>& widget, eResourcePriority priority) {
     m_resourcesMutex.lock();
+    // Released while rendering and requested again. The result of the old one is ignored in onResourceFinished.
     if (m_resources.contains(resourceID))
-        Log::logger->log(Log::ERR, "Resource already enqueued! This is a bug.");
+        Log::logger->log(Log::TRACE, "Replacing in-flight resourceID: {}", resourceID);
 
     m_resources[resourceID] = {resource, {widget}};
     m_resourcesMutex.unlock();
 
-    resource->m_events.finished.listenStatic([resourceID]() {
+    m_scheduler.enqueue(resourceID, resource, priority);
+}
+
+void CAsyncResourceManager::runCommand(ResourceID id, const CTextResource::STextResourceData& params, const AWP<IWidget>& widget, eResourcePriority priority,
+                                       std::chrono::milliseconds timeout) {
+    static const auto CMDTIMEOUT = g_pConfigManager->getValue<Hyprlang::INT>("general:cmd_timeout");
+
+    const auto        TOKEN = ++m_lastCommandToken;
+    m_commandTokens[id]     = TOKEN;
+
+    // The resource is created once the command printed its output.
+    m_resourcesMutex.lock();
+    m_resources[id] = {nullptr, {widget}};
+    m_resourcesMutex.unlock();
+
+    if (timeout.count() <= 0)
+        timeout = std::chrono::milliseconds(std::max<Hyprlang::INT>(*CMDTIMEOUT, 1));
+
+    m_commands.run(TOKEN, params.text, timeout, [id, TOKEN, params, priority](const SCommandResult& result) {
+        // Called from a command pool thread.
         if (!g_pHyprlock)
             return;
 
         g_pHyprlock->addTimer(
             std::chrono::milliseconds(0),
-            [](auto, void* resourceID) {
+            [id, TOKEN, params, priority, result](auto, auto) {
                 if (g_asyncResourceManager)
-                    g_asyncResourceManager->onResourceFinished((size_t)resourceID);
+                    g_asyncResourceManager->onCommandFinished(id, TOKEN, params, priority, result);
             },
-            (void*)resourceID);
+            nullptr, false, TIMER_OWNER_RESOURCES);
     });
 }
 
-void CAsyncResourceManager::onResourceFinished(ResourceID id) {
-    m_resourcesMutex.lock();
-    if (!m_resources.contains(id)) {
+void CAsyncResourceManager::onCommandFinished(ResourceID id, uint64_t token, CTextResource::STextResourceData params, eResourcePriority priority, const SCommandResult& result) {
+    static const auto TRIM = g_pConfigManager->getValue<Hyprlang::INT>("general:text_trim");
+
+    // Cancelled or requested again in the meantime.
+    const auto        TOKEN = m_commandTokens.find(id);
+    if (TOKEN == m_commandTokens.end() || TOKEN->second != token)
+        return;
+
+    m_commandTokens.erase(TOKEN);
+
+    auto& last = m_commandOutputs[keyForTextCmdRequest(params, 0)];
+
+    if (!result.ok() || !m_assets.contains(id) || m_assets[id].refs == 0) {
+        m_resourcesMutex.lock();
+        const auto WIDGETS = m_resources[id].second;
+        m_resources.erase(id);
         m_resourcesMutex.unlock();
+
+        // Widgets keep showing the last good texture.
+        for (const auto& widget : WIDGETS) {
+            if (auto w = widget.lock())
+                w->onAssetUpdate(id, nullptr);
+        }
         return;
     }
 
-    const auto RESOURCE = m_resources[id].first;
-    const auto WIDGETS  = m_resources[id].second;
-    m_resources.erase(id);
+    params.text = result.out;
+
+    if (*TRIM) {
+        params.text.erase(0, params.text.find_first_not_of(" \n\r\t"));
+        params.text.erase(params.text.find_last_not_of(" \n\r\t") + 1);
+    }
+
+    // Most commands print the same thing most of the time. Nothing to render or upload then.
+    if (const auto TEXTURE = last.texture.lock(); TEXTURE && last.output == params.text) {
+        Log::logger->log(Log::TRACE, "Command output unchanged, reusing the texture of resourceID: {} for resourceID: {}", last.id, id);
+        m_unchangedOutputs++;
+        last.id = id;
+        onTextureReady(id, TEXTURE, false);
+        return;
+    }
+
+    last = SCommandOutput{.output = params.text, .id = id};
+
+    auto                                 resource = makeAtomicShared<CTextResource>(std::move(params));
+    CAtomicSharedPointer<IAsyncResource> resourceGeneric{resource};
+
+    m_resourcesMutex.lock();
+    m_resources[id].first = resourceGeneric;
     m_resourcesMutex.unlock();
 
-    if (!m_assets.contains(id) || m_assets[id].refs == 0) // Not referenced? Drop it
+    m_scheduler.enqueue(id, resourceGeneric, priority);
+}
+
+void CAsyncResourceManager::cancel(ResourceID id) {
+    if (const auto TOKEN = m_commandTokens.find(id); TOKEN != m_commandTokens.end()) {
+        Log::logger->log(Log::TRACE, "Cancelled command for resourceID: {}", id);
+        m_commands.cancel(TOKEN->second);
+        m_commandTokens.erase(TOKEN);
+
+        std::lock_guard<std::mutex> lg(m_resourcesMutex);
+        m_resources.erase(id);
         return;
+    }
+
+    std::lock_guard<std::mutex> lg(m_resourcesMutex);
 
-    if (!RESOURCE || !RESOURCE->m_asset.cairoSurface)
+    const auto                  IT = m_resources.find(id);
+    if (IT == m_resources.end() || !m_scheduler.cancel(IT->second.first))
         return;
 
+    Log::logger->log(Log::TRACE, "Cancelled queued resourceID: {}", id);
+    m_resources.erase(IT);
+}
+
+void CAsyncResourceManager::onResourceFinished(ResourceID id, const ASP<IAsyncResource>& resource) {
+    m_resourcesMutex.lock();
+    if (!m_resources.contains(id) || m_resources[id].first != resource) {
+        m_resourcesMutex.unlock();
+        return;
+    }
+
+    const auto RESOURCE = m_resources[id].first;
+    m_resourcesMutex.unlock();
+
+    // Not referenced or nothing to upload? Drop it
+    if (!m_assets.contains(id) || m_assets[id].refs == 0 || !RESOURCE || !RESOURCE->m_asset.cairoSurface) {
+        m_resourcesMutex.lock();
+        m_resources.erase(id);
+        m_resourcesMutex.unlock();
+        return;
+    }
+
     Log::logger->log(Log::TRACE, "Resource to texture id:{}", id);
 
     g_pEGL->makeCurrent(nullptr);
 
-    const auto           texture = makeAtomicShared<CTexture>();
+    // Large surfaces get copied to a pixel buffer by the uploader thread. Continues in onResourceStaged.
+    if (m_uploader.stage(id, RESOURCE))
+        return;
 
-    const cairo_status_t SURFACESTATUS = (cairo_status_t)RESOURCE->m_asset.cairoSurface->status();
-    const auto           CAIROFORMAT   = cairo_image_surface_get_format(RESOURCE->m_asset.cairoSurface->cairo());
-    const GLint          glIFormat     = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_RGB32F : GL_RGBA;
-    const GLint          glFormat      = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_RGB : GL_RGBA;
-    const GLint          glType        = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_FLOAT : GL_UNSIGNED_BYTE;
+    onTextureReady(id, m_uploader.uploadSync(id, RESOURCE));
+}
 
-    if (SURFACESTATUS != CAIRO_STATUS_SUCCESS) {
-        Log::logger->log(Log::ERR, "resourceID: {} invalid ({})", id, cairo_status_to_string(SURFACESTATUS));
-        texture->m_iType = TEXTURE_INVALID;
-    }
+void CAsyncResourceManager::onResourceStaged(ResourceID id) {
+    if (!m_uploader.isStaging(id))
+        return;
 
-    texture->m_vSize = RESOURCE->m_asset.pixelSize;
-    texture->allocate();
+    g_pEGL->makeCurrent(nullptr);
 
-    glBindTexture(GL_TEXTURE_2D, texture->m_iTexID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    if (CAIROFORMAT != CAIRO_FORMAT_RGB96F) {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+    onTextureReady(id, m_uploader.finish(id));
+}
+
+void CAsyncResourceManager::onTextureReady(ResourceID id, const ASP<CTexture>& texture, bool redraw) {
+    m_resourcesMutex.lock();
+    if (!m_resources.contains(id)) {
+        m_resourcesMutex.unlock();
+        return;
     }
-    glTexImage2D(GL_TEXTURE_2D, 0, glIFormat, texture->m_vSize.x, texture->m_vSize.y, 0, glFormat, glType, RESOURCE->m_asset.cairoSurface->data());
 
-    m_assets[id].texture = texture;
+    const auto WIDGETS = m_resources[id].second;
+    m_resources.erase(id);
+    m_resourcesMutex.unlock();
+
+    if (!texture || !m_assets.contains(id) || m_assets[id].refs == 0) // Released while uploading
+        return;
+
+    setAssetTexture(id, texture);
+    evictRetained();
+
+    // Remember the texture of command output, so that the same output does not have to be rendered again.
+    if ((id & 0x0f) == RESOURCE_SCOPE_TEXTCMD && m_keys.contains(id)) {
+        auto key     = m_keys[id];
+        key.revision = 0;
+        if (const auto LAST = m_commandOutputs.find(key); LAST != m_commandOutputs.end() && LAST->second.id == id)
+            LAST->second.texture = texture;
+    }
 
     for (const auto& widget : WIDGETS) {
         if (auto w = widget.lock())
             w->onAssetUpdate(id, texture);
     }
 
-    g_pHyprlock->renderAllOutputs();
+    if (redraw)
+        g_pHyprlock->renderAllOutputs();
 
     if (!m_gathered && !g_pHyprlock->m_bImmediateRender) {
         m_resourcesMutex.lock();
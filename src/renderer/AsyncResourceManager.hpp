@@ -2,73 +2,150 @@
 
 #include "../defines.hpp"
 #include "./Texture.hpp"
+#include "./ResourceHandle.hpp"
 #include "./Screencopy.hpp"
+#include "./TextureUploader.hpp"
+#include "./ResourceScheduler.hpp"
+#include "../helpers/CommandPool.hpp"
 #include "./widgets/IWidget.hpp"
+#include "./resources/ScaledImageResource.hpp"
 
-#include <hyprgraphics/resource/AsyncResourceGatherer.hpp>
 #include <hyprgraphics/resource/resources/AsyncResource.hpp>
 #include <hyprgraphics/resource/resources/TextResource.hpp>
-#include <hyprgraphics/resource/resources/ImageResource.hpp>
 #include <hyprutils/os/FileDescriptor.hpp>
 
+#include <list>
+
 class CAsyncResourceManager {
 
   public:
     // Notes on resource lifetimes:
-    // Resources id's are the result of hashing the requested resource parameters.
+    // Resources id's are the result of hashing the requested resource parameters (see SResourceKey).
+    // Keys are compared in full, so two different requests never share an id even if their hashes collide.
     // When a new request is made, adding a new entry to the m_assets map is done immediatly.
     // Subsequent calls through this section with the same resource id will increment the texture's references.
+    // Every request returns a CResourceHandle that owns one reference and releases it when it goes away.
     // The manager will release the resource when refs reaches 0, while the resource itelf may outlife it's reference in the manager.
     // Why not use ASP/AWP for this?
     // The problem is that we want to to increment the reference as soon as requesting the resource id.
     // Not only when actually retrieving the asset with `getAssetById`.
     //
-    // Improvement idea: Make a wrapper object that is returned when requesting and contains the resource id. Then we can unload with RAII.
+    // Textures that lose their last reference are retained for a while, so that requesting them again does not render them again.
+    // Retained textures are evicted least recently released first, once all textures and framebuffers together exceed general:vram_budget.
+
+    enum eResourceScope : uint8_t {
+        RESOURCE_SCOPE_TEXT       = 1,
+        RESOURCE_SCOPE_TEXTCMD    = 2,
+        RESOURCE_SCOPE_IMAGE      = 3,
+        RESOURCE_SCOPE_SCREENCOPY = 4,
+    };
+
+    // Every parameter that changes the resulting texture.
+    struct SResourceKey {
+        eResourceScope scope = RESOURCE_SCOPE_TEXT;
+        std::string    text; // text, command or image path
+        std::string    font;
+        size_t         fontSize = 0;
+        double         r = 0, g = 0, b = 0;
+        int            align = 0;
+        // Consumer needs to increment the revision parameter to get a new command evaluation.
+        // Image paths may be file system links, thus images support a revision parameter as well.
+        size_t         revision = 0;
+        // The same image decoded for different sizes results in different textures.
+        Vector2D       targetSize;
+        int            fit = 0;
+
+        bool           operator==(const SResourceKey&) const = default;
+        uint64_t       hash() const;
+    };
+
+    struct SResourceKeyHash {
+        size_t operator()(const SResourceKey& key) const {
+            return key.hash();
+        }
+    };
 
-    // Those are hash functions that return the id for a requested resource.
-    static ResourceID resourceIDForTextRequest(const CTextResource::STextResourceData& s);
-    // Consumer needs to increment the revision parameter to get a new command evaluation.
-    static ResourceID resourceIDForTextCmdRequest(const CTextResource::STextResourceData& s, size_t revision);
-    // Image paths may be file system links, thus this function supports a revision parameter that gets factored into the resource id.
-    static ResourceID resourceIDForImageRequest(const std::string& path, size_t revision);
-    static ResourceID resourceIDForScreencopy(const std::string& port);
+    static SResourceKey keyForTextRequest(const CTextResource::STextResourceData& s);
+    static SResourceKey keyForTextCmdRequest(const CTextResource::STextResourceData& s, size_t revision);
+    static SResourceKey keyForImageRequest(const std::string& path, size_t revision, const Vector2D& targetSize = {}, eImageFit fit = IMAGE_FIT_COVER);
+    static ResourceID   resourceIDForScreencopy(const std::string& port);
 
     struct SPreloadedTexture {
         ASP<CTexture> texture;
         size_t        refs = 0;
     };
 
-    CAsyncResourceManager()  = default;
+    CAsyncResourceManager();
     ~CAsyncResourceManager() = default;
 
-    ResourceID requestText(const CTextResource::STextResourceData& params, const AWP<IWidget>& widget);
+    // If a widget is passed, its onAssetUpdate is called once the texture is available. Never from within the request call itself.
+    // The priority decides the order in which queued requests are rendered.
+    CResourceHandle requestText(const CTextResource::STextResourceData& params, const AWP<IWidget>& widget, eResourcePriority priority = RESOURCE_PRIORITY_VISIBLE);
     // Same as requestText but substitute the text with what launching sh -c request.text returns.
-    ResourceID    requestTextCmd(const CTextResource::STextResourceData& params, size_t revision, const AWP<IWidget>& widget);
-    ResourceID    requestImage(const std::string& path, size_t revision, const AWP<IWidget>& widget);
+    // Commands that take longer than timeout (general:cmd_timeout if zero) are killed, the widget keeps its current texture then.
+    CResourceHandle requestTextCmd(const CTextResource::STextResourceData& params, size_t revision, const AWP<IWidget>& widget,
+                                   eResourcePriority priority = RESOURCE_PRIORITY_VISIBLE, std::chrono::milliseconds timeout = {});
+    // If targetSize is set, the image gets downscaled on the worker thread to the size it is displayed at.
+    CResourceHandle requestImage(const std::string& path, size_t revision, const AWP<IWidget>& widget, const Vector2D& targetSize = {}, eImageFit fit = IMAGE_FIT_COVER,
+                                 eResourcePriority priority = RESOURCE_PRIORITY_VISIBLE);
 
-    ASP<CTexture> getAssetByID(ResourceID id);
+    ASP<CTexture>   getAssetByID(ResourceID id);
 
-    void          unload(ASP<CTexture> resource);
-    void          unloadById(ResourceID id);
+    void            enqueueStaticAssets();
+    void            enqueueScreencopyFrames();
+    void            screencopyToTexture(const CScreencopyFrame& scFrame);
+    // Called once the fade-in finished. Replaces the screencopy frames with copies scaled by general:screencopy_scale.
+    // The full resolution captures are freed once the backgrounds let go of them.
+    void            shrinkScreencopyFrames();
+    void            gatherInitialResources(wl_display* display);
 
-    void          enqueueStaticAssets();
-    void          enqueueScreencopyFrames();
-    void          screencopyToTexture(const CScreencopyFrame& scFrame);
-    void          gatherInitialResources(wl_display* display);
+    bool            checkIdPresent(ResourceID id);
 
-    bool          checkIdPresent(ResourceID id);
+    // Logs texture and framebuffer memory, retention hits, evictions, deduplicated requests, id collisions, unchanged command outputs, queue and command stats.
+    void            logStats();
 
   private:
+    friend class CResourceHandle;
+
+    typedef std::list<std::pair<ResourceID, ASP<CTexture>>> retainedList_t;
+
+    struct SCommandOutput {
+        std::string   output;
+        ResourceID    id = 0; // the request that rendered output
+        AWP<CTexture> texture;
+    };
+
     // Returns whether or not the id was already requested.
     // Makes sure the widgets onAssetCallback function gets called.
-    bool request(ResourceID id, const AWP<IWidget>& widget);
-    // Adds a new resource to m_resources and passes it to m_gatherer.
-    void enqueue(ResourceID resourceID, const ASP<IAsyncResource>& resource, const AWP<IWidget>& widget);
+    bool       request(ResourceID id, const AWP<IWidget>& widget);
+    // Adds a new resource to m_resources and passes it to m_scheduler.
+    void       enqueue(ResourceID resourceID, const ASP<IAsyncResource>& resource, const AWP<IWidget>& widget, eResourcePriority priority);
+    // Drops the resource for id if it did not start rendering yet. Kills its command if it has one.
+    void       cancel(ResourceID id);
+    // Runs the command of a text cmd request in m_commands. Continues in onCommandFinished.
+    void       runCommand(ResourceID id, const CTextResource::STextResourceData& params, const AWP<IWidget>& widget, eResourcePriority priority,
+                          std::chrono::milliseconds timeout);
+    // Enqueues the text resource for the command output. On failure the waiting widgets get a nullptr asset.
+    // If the output did not change since the last run, the texture of the last run is handed out again without rendering.
+    void       onCommandFinished(ResourceID id, uint64_t token, CTextResource::STextResourceData params, eResourcePriority priority, const SCommandResult& result);
     // Callback for finished resources.
-    // Copies the resources cairo surface to a GL_TEXTURE_2D and sets it in the asset map.
-    // Removes the entry in m_resources.
-    // Call onAssetUpdate for all stored widget references.
-    void onResourceFinished(ResourceID id);
+    // Hands the resources cairo surface to m_uploader. Small surfaces are uploaded right away, large ones continue in onResourceStaged.
+    void       onResourceFinished(ResourceID id, const ASP<IAsyncResource>& resource);
+    // Callback for when m_uploader copied the pixels of a resource to its pixel buffer.
+    void       onResourceStaged(ResourceID id);
+    // Sets the texture in the asset map and removes the entry in m_resources.
+    // Call onAssetUpdate for all stored widget references. Renders all outputs afterwards if redraw is set.
+    void       onTextureReady(ResourceID id, const ASP<CTexture>& texture, bool redraw = true);
+    // Returns the id for key. The hash of the key, unless a different key already uses that id.
+    ResourceID resolveID(const SResourceKey& key);
+    // Drops one reference, called by CResourceHandle.
+    void       unloadById(ResourceID id);
+    // Removes an asset without references from m_assets and retains its texture if it might be requested again.
+    void       release(ResourceID id);
+    // Evicts retained textures until the memory in use fits general:vram_budget.
+    void       evictRetained();
+    // Sets the texture of an asset in m_assets and keeps m_assetBytes up to date.
+    void       setAssetTexture(ResourceID id, const ASP<CTexture>& texture);
 
     // For polling when using gatherInitialResources.
     bool                           m_gathered = false;
@@ -81,11 +158,34 @@ class CAsyncResourceManager {
     // not shared between threads
     std::unordered_map<ResourceID, SPreloadedTexture> m_assets;
     std::vector<UP<CScreencopyFrame>>                 m_scFrames;
+    bool                                              m_screencopyShrunk = false;
+    size_t                                            m_assetBytes       = 0;
+    // Released textures, most recently released first.
+    retainedList_t                                           m_retained;
+    std::unordered_map<ResourceID, retainedList_t::iterator> m_retainedByID;
+    size_t                                                   m_retainedBytes = 0;
+    size_t                                                   m_retainHits    = 0;
+    size_t                                                   m_evictions     = 0;
+    bool                                                     m_warnedBudget  = false;
+    // Keys of the ids in m_assets and m_retained.
+    std::unordered_map<ResourceID, SResourceKey>      m_keys;
+    size_t                                            m_dedups     = 0;
+    size_t                                            m_collisions = 0;
+    // References to the images from enqueueStaticAssets, held until exit.
+    std::vector<CResourceHandle>                      m_staticAssets;
+    // Text cmd requests waiting for their command, by the token passed to m_commands.
+    std::unordered_map<ResourceID, uint64_t>          m_commandTokens;
+    uint64_t                                          m_lastCommandToken = 0;
+    // The last output of every command, by its key with revision 0, and the texture it was rendered to.
+    std::unordered_map<SResourceKey, SCommandOutput, SResourceKeyHash> m_commandOutputs;
+    size_t                                                             m_unchangedOutputs = 0;
     // shared between threads
     std::mutex                                                                                              m_resourcesMutex;
     std::unordered_map<ResourceID, std::pair<ASP<Hyprgraphics::IAsyncResource>, std::vector<AWP<IWidget>>>> m_resources;
 
-    Hyprgraphics::CAsyncResourceGatherer                                                                    m_gatherer;
+    CResourceScheduler                                                                                      m_scheduler;
+    CCommandPool                                                                                            m_commands;
+    CTextureUploader                                                                                        m_uploader;
 };
 
 inline UP<CAsyncResourceManager> g_asyncResourceManager;
@@ -45,6 +45,11 @@ bool CFramebuffer::alloc(int w, int h, bool highres) {
         glBindTexture(GL_TEXTURE_2D, m_cTex.m_iTexID);
         glTexImage2D(GL_TEXTURE_2D, 0, glFormat, w, h, 0, GL_RGBA, glType, nullptr);
 
+        if (m_cTex.m_renderTargetBytes)
+            g_renderTargetStats.remove(m_cTex.m_renderTargetBytes);
+        m_cTex.m_renderTargetBytes = (size_t)w * h * (highres ? 8 : 4);
+        g_renderTargetStats.add(m_cTex.m_renderTargetBytes);
+
         glBindFramebuffer(GL_FRAMEBUFFER, m_iFb);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_cTex.m_iTexID, 0);
 
@@ -106,6 +111,11 @@ void CFramebuffer::destroyBuffer() {
     if (m_cTex.m_iTexID)
         glDeleteTextures(1, &m_cTex.m_iTexID);
 
+    if (m_cTex.m_renderTargetBytes) {
+        g_renderTargetStats.remove(m_cTex.m_renderTargetBytes);
+        m_cTex.m_renderTargetBytes = 0;
+    }
+
     if (m_pStencilTex && m_pStencilTex->m_iTexID)
         glDeleteTextures(1, &m_pStencilTex->m_iTexID);
 
@@ -115,6 +125,22 @@ void CFramebuffer::destroyBuffer() {
     m_pStencilTex   = nullptr;
 }
 
+ASP<CTexture> CFramebuffer::releaseTexture() {
+    const auto texture    = makeAtomicShared<CTexture>();
+    texture->m_iTexID     = m_cTex.m_iTexID;
+    texture->m_bAllocated = m_cTex.m_iTexID != 0;
+    texture->m_vSize      = m_vSize;
+
+    // The memory now belongs to the texture.
+    texture->m_renderTargetBytes = m_cTex.m_renderTargetBytes;
+    m_cTex.m_renderTargetBytes   = 0;
+
+    m_cTex.m_iTexID = 0;
+    destroyBuffer();
+
+    return texture;
+}
+
 CFramebuffer::~CFramebuffer() {
     destroyBuffer();
 }
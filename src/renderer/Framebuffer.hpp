@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../defines.hpp"
 #include "../helpers/Math.hpp"
 #include <GLES3/gl32.h>
 #include "Texture.hpp"
@@ -13,6 +14,9 @@ class CFramebuffer {
     void          bind() const;
     void          destroyBuffer();
     bool          isAllocated() const;
+    // Detaches the color texture and destroys the framebuffer.
+    // Needed to hand a rendered texture to another context, framebuffers are not shared between contexts.
+    ASP<CTexture> releaseTexture();
 
     Vector2D      m_vSize;
 
@@ -0,0 +1,164 @@
+#include "GLWorker.hpp"
+
+#include "../helpers/Log.hpp"
+#include "../core/hyprlock.hpp"
+#include "../core/Egl.hpp"
+
+#include <GLES3/gl32.h>
+#include <string>
+
+CGLWorker::CGLWorker() {
+    const char*       _EXTS = eglQueryString(g_pEGL->eglDisplay, EGL_EXTENSIONS);
+    const std::string EXTS  = _EXTS ? _EXTS : "";
+
+    if (!EXTS.contains("EGL_KHR_fence_sync") || !EXTS.contains("EGL_KHR_surfaceless_context")) {
+        Log::logger->log(Log::WARN, "[glworker] EGL_KHR_fence_sync or EGL_KHR_surfaceless_context not supported, uploads and blurs stay on the main thread");
+        return;
+    }
+
+    m_eglCreateSyncKHR     = (PFNEGLCREATESYNCKHRPROC)eglGetProcAddress("eglCreateSyncKHR");
+    m_eglDestroySyncKHR    = (PFNEGLDESTROYSYNCKHRPROC)eglGetProcAddress("eglDestroySyncKHR");
+    m_eglClientWaitSyncKHR = (PFNEGLCLIENTWAITSYNCKHRPROC)eglGetProcAddress("eglClientWaitSyncKHR");
+    if (!m_eglCreateSyncKHR || !m_eglDestroySyncKHR || !m_eglClientWaitSyncKHR) {
+        Log::logger->log(Log::WARN, "[glworker] Failed to get the EGL_KHR_fence_sync functions, uploads and blurs stay on the main thread");
+        return;
+    }
+
+    if (EXTS.contains("EGL_KHR_wait_sync"))
+        m_eglWaitSyncKHR = (PFNEGLWAITSYNCKHRPROC)eglGetProcAddress("eglWaitSyncKHR");
+    m_serverWait = m_eglWaitSyncKHR != nullptr;
+
+    m_context = g_pEGL->createSharedContext();
+    if (m_context == EGL_NO_CONTEXT)
+        return;
+
+    m_thread = std::thread([this]() { workerThread(); });
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+    m_cv.wait(lk, [this] { return m_initDone; });
+
+    Log::logger->log(Log::INFO, "[glworker] {} (server side waits: {})", m_available ? "Started" : "Failed to start", m_serverWait);
+}
+
+CGLWorker::~CGLWorker() {
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_exit = true;
+    }
+    m_cv.notify_all();
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    for (auto& job : m_finished) {
+        if (job.fence != EGL_NO_SYNC_KHR)
+            m_eglDestroySyncKHR(g_pEGL->eglDisplay, job.fence);
+    }
+
+    if (m_context != EGL_NO_CONTEXT)
+        eglDestroyContext(g_pEGL->eglDisplay, m_context);
+}
+
+bool CGLWorker::isAvailable() const {
+    return m_available;
+}
+
+void CGLWorker::submit(jobFn_t job, doneFn_t done) {
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_jobs.emplace_back(SJob{.job = std::move(job), .done = std::move(done)});
+    }
+    m_cv.notify_all();
+}
+
+void CGLWorker::workerThread() {
+    const bool CURRENT = eglMakeCurrent(g_pEGL->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, m_context) == EGL_TRUE;
+
+    auto shaders = makeUnique<CRenderer::SShaders>();
+    if (CURRENT)
+        CRenderer::compileShaders(*shaders);
+    else
+        Log::logger->log(Log::ERR, "[glworker] Failed to make the shared context current");
+
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_available = CURRENT;
+        m_initDone  = true;
+    }
+    m_cv.notify_all();
+
+    if (!CURRENT)
+        return;
+
+    while (true) {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_cv.wait(lk, [this] { return m_exit || !m_jobs.empty(); });
+
+        if (m_exit)
+            break;
+
+        SJob job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        lk.unlock();
+
+        job.result = job.job(*shaders);
+        job.fence  = m_eglCreateSyncKHR(g_pEGL->eglDisplay, EGL_SYNC_FENCE_KHR, nullptr);
+        // The fence has to reach the gpu before another context can wait on it.
+        glFlush();
+
+        if (job.fence == EGL_NO_SYNC_KHR)
+            glFinish();
+        else if (!m_serverWait) {
+            m_eglClientWaitSyncKHR(g_pEGL->eglDisplay, job.fence, 0, EGL_FOREVER_KHR);
+            m_eglDestroySyncKHR(g_pEGL->eglDisplay, job.fence);
+            job.fence = EGL_NO_SYNC_KHR;
+        }
+
+        lk.lock();
+        m_finished.emplace_back(std::move(job));
+        lk.unlock();
+
+        g_pHyprlock->addTimer(
+            std::chrono::milliseconds(0),
+            [](auto, auto) {
+                if (g_pGLWorker)
+                    g_pGLWorker->dispatchFinished();
+            },
+            nullptr, false, TIMER_OWNER_RESOURCES);
+    }
+
+    // Shaders and leftover results belong to this context.
+    shaders.reset();
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        for (auto& job : m_finished)
+            job.result.reset();
+    }
+
+    eglMakeCurrent(g_pEGL->eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglReleaseThread();
+}
+
+void CGLWorker::dispatchFinished() {
+    std::vector<SJob> finished;
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        finished = std::move(m_finished);
+        m_finished.clear();
+    }
+
+    if (finished.empty())
+        return;
+
+    g_pEGL->makeCurrent(nullptr);
+
+    for (auto& job : finished) {
+        if (job.fence != EGL_NO_SYNC_KHR) {
+            // Makes the main context wait for the worker on the gpu. Does not block here.
+            m_eglWaitSyncKHR(g_pEGL->eglDisplay, job.fence, 0);
+            m_eglDestroySyncKHR(g_pEGL->eglDisplay, job.fence);
+        }
+
+        job.done(job.result);
+    }
+}
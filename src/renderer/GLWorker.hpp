@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "Renderer.hpp"
+#include "Texture.hpp"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs GL work that is too expensive for a frame (texture uploads, background blurs) on a separate thread.
+// The worker has its own context in the share group of the main context and its own set of shaders.
+// Results are handed back to the main thread together with an EGL fence, so the main context never samples a half written texture.
+class CGLWorker {
+  public:
+    CGLWorker();
+    ~CGLWorker();
+
+    typedef std::function<ASP<CTexture>(const CRenderer::SShaders& shaders)> jobFn_t;
+    typedef std::function<void(ASP<CTexture> texture)>                       doneFn_t;
+
+    // False if no shared context could be created. Callers should do the work on the main thread in that case.
+    bool isAvailable() const;
+    // job runs on the worker thread with the shared context current, done runs on the main thread.
+    // Jobs must not leave framebuffers or other container objects behind, those are not shared between contexts.
+    void submit(jobFn_t job, doneFn_t done);
+
+  private:
+    struct SJob {
+        jobFn_t       job;
+        doneFn_t      done;
+        ASP<CTexture> result;
+        EGLSyncKHR    fence = EGL_NO_SYNC_KHR;
+    };
+
+    void                          workerThread();
+    void                          dispatchFinished();
+
+    EGLContext                    m_context   = EGL_NO_CONTEXT;
+    bool                          m_available = false;
+    // Without EGL_KHR_wait_sync the worker waits for its own fence instead of the main context.
+    bool                          m_serverWait = false;
+
+    PFNEGLCREATESYNCKHRPROC       m_eglCreateSyncKHR     = nullptr;
+    PFNEGLDESTROYSYNCKHRPROC      m_eglDestroySyncKHR    = nullptr;
+    PFNEGLCLIENTWAITSYNCKHRPROC   m_eglClientWaitSyncKHR = nullptr;
+    PFNEGLWAITSYNCKHRPROC         m_eglWaitSyncKHR       = nullptr;
+
+    // shared between threads
+    std::mutex                    m_mutex;
+    std::condition_variable       m_cv;
+    std::deque<SJob>              m_jobs;
+    std::vector<SJob>             m_finished;
+    bool                          m_initDone = false;
+    bool                          m_exit     = false;
+
+    std::thread                   m_thread;
+};
+
+inline UP<CGLWorker> g_pGLWorker;
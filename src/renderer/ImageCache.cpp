@@ -0,0 +1,241 @@
+#include "ImageCache.hpp"
+
+#include "../helpers/Log.hpp"
+#include "../config/ConfigManager.hpp"
+
+#include <hyprutils/os/FileDescriptor.hpp>
+#include <cairo/cairo.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Hyprutils::OS;
+
+static const char     CACHEMAGIC[4] = {'H', 'L', 'I', 'C'};
+static const uint32_t CACHEVERSION  = 1;
+
+struct SCacheHeader {
+    char     magic[4]   = {};
+    uint32_t version    = 0;
+    uint32_t format     = 0; // cairo_format_t
+    int32_t  width      = 0;
+    int32_t  height     = 0;
+    int32_t  stride     = 0;
+    uint32_t keyLength  = 0; // the key follows the header, to rule out hash collisions
+    uint32_t dataOffset = 0;
+};
+
+struct SMapping {
+    void*  addr = nullptr;
+    size_t size = 0;
+};
+
+static const cairo_user_data_key_t MAPPINGKEY = {};
+
+CImageCache::CImageCache() {
+    static const auto CACHESIZE = g_pConfigManager->getValue<Hyprlang::INT>("general:image_cache_size");
+
+    if (*CACHESIZE <= 0)
+        return;
+
+    const char* xdgCache = getenv("XDG_CACHE_HOME");
+    const char* home     = getenv("HOME");
+    if (xdgCache && xdgCache[0] == '/')
+        m_dir = std::string{xdgCache} + "/hyprlock/images";
+    else if (home)
+        m_dir = std::string{home} + "/.cache/hyprlock/images";
+    else {
+        Log::logger->log(Log::WARN, "[imagecache] Neither XDG_CACHE_HOME nor HOME are set, disabling the image cache");
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_dir, ec);
+    if (ec) {
+        Log::logger->log(Log::WARN, "[imagecache] Failed to create {}: {}, disabling the image cache", m_dir, ec.message());
+        m_dir.clear();
+        return;
+    }
+
+    m_maxBytes = (size_t)*CACHESIZE * 1024 * 1024;
+}
+
+std::string CImageCache::keyFor(const std::string& path, const Hyprutils::Math::Vector2D& targetSize, eImageFit fit) {
+    if (m_dir.empty())
+        return "";
+
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+        return "";
+
+    return std::format("{}\n{}\n{}.{}\n{}x{}\n{}", path, st.st_size, st.st_mtim.tv_sec, st.st_mtim.tv_nsec, targetSize.x, targetSize.y, (int)fit);
+}
+
+std::string CImageCache::fileFor(const std::string& key) {
+    return std::format("{}/{:016x}.bin", m_dir, std::hash<std::string>{}(key));
+}
+
+SP<Hyprgraphics::CCairoSurface> CImageCache::load(const std::string& key) {
+    const auto      PATH = fileFor(key);
+
+    CFileDescriptor fd{open(PATH.c_str(), O_RDONLY | O_CLOEXEC)};
+    struct stat     st;
+    if (!fd.isValid() || fstat(fd.get(), &st) != 0 || (size_t)st.st_size < sizeof(SCacheHeader)) {
+        m_misses++;
+        return nullptr;
+    }
+
+    const size_t SIZE = st.st_size;
+    // Private and writable, so that cairo gets the non-const data it wants. Pages are only copied if something writes to them.
+    void* addr = mmap(nullptr, SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd.get(), 0);
+    if (addr == MAP_FAILED) {
+        m_misses++;
+        return nullptr;
+    }
+
+    SCacheHeader header;
+    std::memcpy(&header, addr, sizeof(header));
+
+    const auto   FORMAT = (cairo_format_t)header.format;
+    const size_t BYTES  = (size_t)header.stride * header.height;
+    const bool   VALID  = std::memcmp(header.magic, CACHEMAGIC, sizeof(CACHEMAGIC)) == 0 && header.version == CACHEVERSION && header.keyLength == key.size() &&
+        sizeof(SCacheHeader) + header.keyLength <= header.dataOffset && header.dataOffset + BYTES == SIZE && header.width > 0 && header.height > 0 &&
+        header.stride == cairo_format_stride_for_width(FORMAT, header.width) && std::memcmp((char*)addr + sizeof(SCacheHeader), key.data(), key.size()) == 0;
+
+    if (!VALID) {
+        Log::logger->log(Log::TRACE, "[imagecache] Ignoring stale or foreign entry {}", PATH);
+        munmap(addr, SIZE);
+        m_misses++;
+        return nullptr;
+    }
+
+    auto* surface = cairo_image_surface_create_for_data((unsigned char*)addr + header.dataOffset, FORMAT, header.width, header.height, header.stride);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        munmap(addr, SIZE);
+        m_misses++;
+        return nullptr;
+    }
+
+    // Unmap once cairo is done with the surface.
+    cairo_surface_set_user_data(surface, &MAPPINGKEY, new SMapping{.addr = addr, .size = SIZE}, [](void* data) {
+        const auto MAPPING = (SMapping*)data;
+        munmap(MAPPING->addr, MAPPING->size);
+        delete MAPPING;
+    });
+
+    // The mtime of an entry is its last use.
+    futimens(fd.get(), nullptr);
+
+    m_hits++;
+    m_bytesSaved += BYTES;
+
+    Log::logger->log(Log::TRACE, "[imagecache] Hit {} ({}x{})", PATH, header.width, header.height);
+
+    return makeShared<Hyprgraphics::CCairoSurface>(surface);
+}
+
+void CImageCache::store(const std::string& key, cairo_surface_t* surface) {
+    if (m_dir.empty() || !surface || cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS || cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE)
+        return;
+
+    cairo_surface_flush(surface);
+
+    SCacheHeader header;
+    std::memcpy(header.magic, CACHEMAGIC, sizeof(CACHEMAGIC));
+    header.version    = CACHEVERSION;
+    header.format     = cairo_image_surface_get_format(surface);
+    header.width      = cairo_image_surface_get_width(surface);
+    header.height     = cairo_image_surface_get_height(surface);
+    header.stride     = cairo_image_surface_get_stride(surface);
+    header.keyLength  = key.size();
+    header.dataOffset = (sizeof(SCacheHeader) + key.size() + 63) & ~63;
+
+    const size_t BYTES = (size_t)header.stride * header.height;
+    if (BYTES > m_maxBytes)
+        return;
+
+    const auto PATH = fileFor(key);
+    // Write to a temporary file first, concurrent loads must never see a partial entry.
+    const auto              TMPPATH = std::format("{}.{}.tmp", PATH, gettid());
+    const std::vector<char> PADDING(header.dataOffset - sizeof(SCacheHeader) - key.size(), 0);
+
+    {
+        std::ofstream ofs(TMPPATH, std::ios::binary | std::ios::trunc);
+        ofs.write((const char*)&header, sizeof(header));
+        ofs.write(key.data(), key.size());
+        ofs.write(PADDING.data(), PADDING.size());
+        ofs.write((const char*)cairo_image_surface_get_data(surface), BYTES);
+
+        if (!ofs.good()) {
+            Log::logger->log(Log::WARN, "[imagecache] Failed to write {}", TMPPATH);
+            ofs.close();
+            unlink(TMPPATH.c_str());
+            return;
+        }
+    }
+
+    if (rename(TMPPATH.c_str(), PATH.c_str()) != 0) {
+        unlink(TMPPATH.c_str());
+        return;
+    }
+
+    Log::logger->log(Log::TRACE, "[imagecache] Stored {} ({}x{}, {} bytes)", PATH, header.width, header.height, BYTES);
+
+    prune();
+}
+
+void CImageCache::prune() {
+    std::lock_guard<std::mutex> lg(m_pruneMutex);
+
+    struct SEntry {
+        std::filesystem::path           path;
+        std::filesystem::file_time_type lastUse;
+        size_t                          size = 0;
+    };
+
+    std::vector<SEntry> entries;
+    size_t              total = 0;
+
+    std::error_code     ec;
+    for (const auto& e : std::filesystem::directory_iterator(m_dir, ec)) {
+        if (!e.is_regular_file(ec) || e.path().extension() != ".bin")
+            continue;
+
+        SEntry entry{.path = e.path(), .lastUse = e.last_write_time(ec), .size = e.file_size(ec)};
+        if (ec)
+            continue;
+
+        total += entry.size;
+        entries.emplace_back(std::move(entry));
+    }
+
+    if (total <= m_maxBytes)
+        return;
+
+    std::ranges::sort(entries, [](const auto& a, const auto& b) { return a.lastUse < b.lastUse; });
+
+    for (const auto& e : entries) {
+        if (total <= m_maxBytes)
+            break;
+
+        if (std::filesystem::remove(e.path, ec)) {
+            total -= e.size;
+            Log::logger->log(Log::TRACE, "[imagecache] Pruned {}", e.path.string());
+        }
+    }
+}
+
+void CImageCache::logStats() {
+    if (m_dir.empty())
+        return;
+
+    Log::logger->log(Log::INFO, "[imagecache] {} hits, {} misses, {:.1f} MiB of decoding saved", m_hits.load(), m_misses.load(), m_bytesSaved.load() / (1024.F * 1024.F));
+}
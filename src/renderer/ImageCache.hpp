@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "./resources/ScaledImageResource.hpp"
+#include <hyprutils/math/Vector2D.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// On disk cache of decoded (and downscaled) images, so that a lock does not need to decode the same wallpaper again.
+// Each entry is a small header followed by the raw cairo pixels. Hits are mmap'd and handed to cairo without a copy.
+// Entries are keyed by path, file size, mtime and decode target. When the cache grows above
+// general:image_cache_size, the least recently used entries are removed.
+// load and store are called from the resource gatherer threads.
+class CImageCache {
+  public:
+    CImageCache();
+    ~CImageCache() = default;
+
+    // Returns an empty string if the cache is disabled or the file can't be stat'd.
+    std::string                            keyFor(const std::string& path, const Hyprutils::Math::Vector2D& targetSize, eImageFit fit);
+
+    SP<Hyprgraphics::CCairoSurface>        load(const std::string& key);
+    void                                   store(const std::string& key, cairo_surface_t* surface);
+
+    void                                   logStats();
+
+  private:
+    std::string                            fileFor(const std::string& key);
+    void                                   prune();
+
+    std::string                            m_dir;
+    size_t                                 m_maxBytes = 0;
+
+    std::mutex                             m_pruneMutex;
+
+    std::atomic<size_t>                    m_hits       = 0;
+    std::atomic<size_t>                    m_misses     = 0;
+    std::atomic<size_t>                    m_bytesSaved = 0;
+};
+
+inline UP<CImageCache> g_pImageCache;
@@ -1,4 +1,5 @@
 #include "Renderer.hpp"
+#include "AsyncResourceManager.hpp"
 #include "Shaders.hpp"
 #include "Screencopy.hpp"
 #include "../config/ConfigManager.hpp"
@@ -75,125 +76,129 @@ static void glMessageCallbackA(GLenum source, GLenum type, GLuint id, GLenum sev
     Log::logger->log(Log::INFO, "[gl] {}", (const char*)message);
 }
 
+void CRenderer::compileShaders(SShaders& shaders) {
+    GLuint prog                  = createProgram(QUADVERTSRC, QUADFRAGSRC);
+    shaders.rectShader.program   = prog;
+    shaders.rectShader.proj      = glGetUniformLocation(prog, "proj");
+    shaders.rectShader.color     = glGetUniformLocation(prog, "color");
+    shaders.rectShader.posAttrib = glGetAttribLocation(prog, "pos");
+    shaders.rectShader.topLeft   = glGetUniformLocation(prog, "topLeft");
+    shaders.rectShader.fullSize  = glGetUniformLocation(prog, "fullSize");
+    shaders.rectShader.radius    = glGetUniformLocation(prog, "radius");
+
+    prog                                = createProgram(TEXVERTSRC, TEXFRAGSRCRGBA);
+    shaders.texShader.program           = prog;
+    shaders.texShader.proj              = glGetUniformLocation(prog, "proj");
+    shaders.texShader.tex               = glGetUniformLocation(prog, "tex");
+    shaders.texShader.alphaMatte        = glGetUniformLocation(prog, "texMatte");
+    shaders.texShader.alpha             = glGetUniformLocation(prog, "alpha");
+    shaders.texShader.texAttrib         = glGetAttribLocation(prog, "texcoord");
+    shaders.texShader.matteTexAttrib    = glGetAttribLocation(prog, "texcoordMatte");
+    shaders.texShader.posAttrib         = glGetAttribLocation(prog, "pos");
+    shaders.texShader.discardOpaque     = glGetUniformLocation(prog, "discardOpaque");
+    shaders.texShader.discardAlpha      = glGetUniformLocation(prog, "discardAlpha");
+    shaders.texShader.discardAlphaValue = glGetUniformLocation(prog, "discardAlphaValue");
+    shaders.texShader.topLeft           = glGetUniformLocation(prog, "topLeft");
+    shaders.texShader.fullSize          = glGetUniformLocation(prog, "fullSize");
+    shaders.texShader.radius            = glGetUniformLocation(prog, "radius");
+    shaders.texShader.applyTint         = glGetUniformLocation(prog, "applyTint");
+    shaders.texShader.tint              = glGetUniformLocation(prog, "tint");
+    shaders.texShader.useAlphaMatte     = glGetUniformLocation(prog, "useAlphaMatte");
+
+    prog                                   = createProgram(TEXVERTSRC, TEXMIXFRAGSRCRGBA);
+    shaders.texMixShader.program           = prog;
+    shaders.texMixShader.proj              = glGetUniformLocation(prog, "proj");
+    shaders.texMixShader.tex               = glGetUniformLocation(prog, "tex1");
+    shaders.texMixShader.tex2              = glGetUniformLocation(prog, "tex2");
+    shaders.texMixShader.alphaMatte        = glGetUniformLocation(prog, "texMatte");
+    shaders.texMixShader.alpha             = glGetUniformLocation(prog, "alpha");
+    shaders.texMixShader.mixFactor         = glGetUniformLocation(prog, "mixFactor");
+    shaders.texMixShader.texAttrib         = glGetAttribLocation(prog, "texcoord");
+    shaders.texMixShader.matteTexAttrib    = glGetAttribLocation(prog, "texcoordMatte");
+    shaders.texMixShader.posAttrib         = glGetAttribLocation(prog, "pos");
+    shaders.texMixShader.discardOpaque     = glGetUniformLocation(prog, "discardOpaque");
+    shaders.texMixShader.discardAlpha      = glGetUniformLocation(prog, "discardAlpha");
+    shaders.texMixShader.discardAlphaValue = glGetUniformLocation(prog, "discardAlphaValue");
+    shaders.texMixShader.topLeft           = glGetUniformLocation(prog, "topLeft");
+    shaders.texMixShader.fullSize          = glGetUniformLocation(prog, "fullSize");
+    shaders.texMixShader.radius            = glGetUniformLocation(prog, "radius");
+    shaders.texMixShader.applyTint         = glGetUniformLocation(prog, "applyTint");
+    shaders.texMixShader.tint              = glGetUniformLocation(prog, "tint");
+    shaders.texMixShader.useAlphaMatte     = glGetUniformLocation(prog, "useAlphaMatte");
+
+    prog                                  = createProgram(TEXVERTSRC, FRAGBLUR1);
+    shaders.blurShader1.program           = prog;
+    shaders.blurShader1.tex               = glGetUniformLocation(prog, "tex");
+    shaders.blurShader1.alpha             = glGetUniformLocation(prog, "alpha");
+    shaders.blurShader1.proj              = glGetUniformLocation(prog, "proj");
+    shaders.blurShader1.posAttrib         = glGetAttribLocation(prog, "pos");
+    shaders.blurShader1.texAttrib         = glGetAttribLocation(prog, "texcoord");
+    shaders.blurShader1.radius            = glGetUniformLocation(prog, "radius");
+    shaders.blurShader1.halfpixel         = glGetUniformLocation(prog, "halfpixel");
+    shaders.blurShader1.passes            = glGetUniformLocation(prog, "passes");
+    shaders.blurShader1.vibrancy          = glGetUniformLocation(prog, "vibrancy");
+    shaders.blurShader1.vibrancy_darkness = glGetUniformLocation(prog, "vibrancy_darkness");
+
+    prog                          = createProgram(TEXVERTSRC, FRAGBLUR2);
+    shaders.blurShader2.program   = prog;
+    shaders.blurShader2.tex       = glGetUniformLocation(prog, "tex");
+    shaders.blurShader2.alpha     = glGetUniformLocation(prog, "alpha");
+    shaders.blurShader2.proj      = glGetUniformLocation(prog, "proj");
+    shaders.blurShader2.posAttrib = glGetAttribLocation(prog, "pos");
+    shaders.blurShader2.texAttrib = glGetAttribLocation(prog, "texcoord");
+    shaders.blurShader2.radius    = glGetUniformLocation(prog, "radius");
+    shaders.blurShader2.halfpixel = glGetUniformLocation(prog, "halfpixel");
+
+    prog                                 = createProgram(TEXVERTSRC, FRAGBLURPREPARE);
+    shaders.blurPrepareShader.program    = prog;
+    shaders.blurPrepareShader.tex        = glGetUniformLocation(prog, "tex");
+    shaders.blurPrepareShader.proj       = glGetUniformLocation(prog, "proj");
+    shaders.blurPrepareShader.posAttrib  = glGetAttribLocation(prog, "pos");
+    shaders.blurPrepareShader.texAttrib  = glGetAttribLocation(prog, "texcoord");
+    shaders.blurPrepareShader.contrast   = glGetUniformLocation(prog, "contrast");
+    shaders.blurPrepareShader.brightness = glGetUniformLocation(prog, "brightness");
+
+    prog                                  = createProgram(TEXVERTSRC, FRAGBLURFINISH);
+    shaders.blurFinishShader.program      = prog;
+    shaders.blurFinishShader.tex          = glGetUniformLocation(prog, "tex");
+    shaders.blurFinishShader.proj         = glGetUniformLocation(prog, "proj");
+    shaders.blurFinishShader.posAttrib    = glGetAttribLocation(prog, "pos");
+    shaders.blurFinishShader.texAttrib    = glGetAttribLocation(prog, "texcoord");
+    shaders.blurFinishShader.brightness   = glGetUniformLocation(prog, "brightness");
+    shaders.blurFinishShader.noise        = glGetUniformLocation(prog, "noise");
+    shaders.blurFinishShader.colorize     = glGetUniformLocation(prog, "colorize");
+    shaders.blurFinishShader.colorizeTint = glGetUniformLocation(prog, "colorizeTint");
+    shaders.blurFinishShader.boostA       = glGetUniformLocation(prog, "boostA");
+
+    prog                                       = createProgram(QUADVERTSRC, FRAGBORDER);
+    shaders.borderShader.program               = prog;
+    shaders.borderShader.proj                  = glGetUniformLocation(prog, "proj");
+    shaders.borderShader.thick                 = glGetUniformLocation(prog, "thick");
+    shaders.borderShader.posAttrib             = glGetAttribLocation(prog, "pos");
+    shaders.borderShader.texAttrib             = glGetAttribLocation(prog, "texcoord");
+    shaders.borderShader.topLeft               = glGetUniformLocation(prog, "topLeft");
+    shaders.borderShader.bottomRight           = glGetUniformLocation(prog, "bottomRight");
+    shaders.borderShader.fullSize              = glGetUniformLocation(prog, "fullSize");
+    shaders.borderShader.fullSizeUntransformed = glGetUniformLocation(prog, "fullSizeUntransformed");
+    shaders.borderShader.radius                = glGetUniformLocation(prog, "radius");
+    shaders.borderShader.radiusOuter           = glGetUniformLocation(prog, "radiusOuter");
+    shaders.borderShader.gradient              = glGetUniformLocation(prog, "gradient");
+    shaders.borderShader.gradientLength        = glGetUniformLocation(prog, "gradientLength");
+    shaders.borderShader.angle                 = glGetUniformLocation(prog, "angle");
+    shaders.borderShader.gradient2             = glGetUniformLocation(prog, "gradient2");
+    shaders.borderShader.gradient2Length       = glGetUniformLocation(prog, "gradient2Length");
+    shaders.borderShader.angle2                = glGetUniformLocation(prog, "angle2");
+    shaders.borderShader.gradientLerp          = glGetUniformLocation(prog, "gradientLerp");
+    shaders.borderShader.alpha                 = glGetUniformLocation(prog, "alpha");
+}
+
 CRenderer::CRenderer() {
     g_pEGL->makeCurrent(nullptr);
 
     glEnable(GL_DEBUG_OUTPUT);
     glDebugMessageCallback(glMessageCallbackA, nullptr);
 
-    GLuint prog          = createProgram(QUADVERTSRC, QUADFRAGSRC);
-    rectShader.program   = prog;
-    rectShader.proj      = glGetUniformLocation(prog, "proj");
-    rectShader.color     = glGetUniformLocation(prog, "color");
-    rectShader.posAttrib = glGetAttribLocation(prog, "pos");
-    rectShader.topLeft   = glGetUniformLocation(prog, "topLeft");
-    rectShader.fullSize  = glGetUniformLocation(prog, "fullSize");
-    rectShader.radius    = glGetUniformLocation(prog, "radius");
-
-    prog                        = createProgram(TEXVERTSRC, TEXFRAGSRCRGBA);
-    texShader.program           = prog;
-    texShader.proj              = glGetUniformLocation(prog, "proj");
-    texShader.tex               = glGetUniformLocation(prog, "tex");
-    texShader.alphaMatte        = glGetUniformLocation(prog, "texMatte");
-    texShader.alpha             = glGetUniformLocation(prog, "alpha");
-    texShader.texAttrib         = glGetAttribLocation(prog, "texcoord");
-    texShader.matteTexAttrib    = glGetAttribLocation(prog, "texcoordMatte");
-    texShader.posAttrib         = glGetAttribLocation(prog, "pos");
-    texShader.discardOpaque     = glGetUniformLocation(prog, "discardOpaque");
-    texShader.discardAlpha      = glGetUniformLocation(prog, "discardAlpha");
-    texShader.discardAlphaValue = glGetUniformLocation(prog, "discardAlphaValue");
-    texShader.topLeft           = glGetUniformLocation(prog, "topLeft");
-    texShader.fullSize          = glGetUniformLocation(prog, "fullSize");
-    texShader.radius            = glGetUniformLocation(prog, "radius");
-    texShader.applyTint         = glGetUniformLocation(prog, "applyTint");
-    texShader.tint              = glGetUniformLocation(prog, "tint");
-    texShader.useAlphaMatte     = glGetUniformLocation(prog, "useAlphaMatte");
-
-    prog                           = createProgram(TEXVERTSRC, TEXMIXFRAGSRCRGBA);
-    texMixShader.program           = prog;
-    texMixShader.proj              = glGetUniformLocation(prog, "proj");
-    texMixShader.tex               = glGetUniformLocation(prog, "tex1");
-    texMixShader.tex2              = glGetUniformLocation(prog, "tex2");
-    texMixShader.alphaMatte        = glGetUniformLocation(prog, "texMatte");
-    texMixShader.alpha             = glGetUniformLocation(prog, "alpha");
-    texMixShader.mixFactor         = glGetUniformLocation(prog, "mixFactor");
-    texMixShader.texAttrib         = glGetAttribLocation(prog, "texcoord");
-    texMixShader.matteTexAttrib    = glGetAttribLocation(prog, "texcoordMatte");
-    texMixShader.posAttrib         = glGetAttribLocation(prog, "pos");
-    texMixShader.discardOpaque     = glGetUniformLocation(prog, "discardOpaque");
-    texMixShader.discardAlpha      = glGetUniformLocation(prog, "discardAlpha");
-    texMixShader.discardAlphaValue = glGetUniformLocation(prog, "discardAlphaValue");
-    texMixShader.topLeft           = glGetUniformLocation(prog, "topLeft");
-    texMixShader.fullSize          = glGetUniformLocation(prog, "fullSize");
-    texMixShader.radius            = glGetUniformLocation(prog, "radius");
-    texMixShader.applyTint         = glGetUniformLocation(prog, "applyTint");
-    texMixShader.tint              = glGetUniformLocation(prog, "tint");
-    texMixShader.useAlphaMatte     = glGetUniformLocation(prog, "useAlphaMatte");
-
-    prog                          = createProgram(TEXVERTSRC, FRAGBLUR1);
-    blurShader1.program           = prog;
-    blurShader1.tex               = glGetUniformLocation(prog, "tex");
-    blurShader1.alpha             = glGetUniformLocation(prog, "alpha");
-    blurShader1.proj              = glGetUniformLocation(prog, "proj");
-    blurShader1.posAttrib         = glGetAttribLocation(prog, "pos");
-    blurShader1.texAttrib         = glGetAttribLocation(prog, "texcoord");
-    blurShader1.radius            = glGetUniformLocation(prog, "radius");
-    blurShader1.halfpixel         = glGetUniformLocation(prog, "halfpixel");
-    blurShader1.passes            = glGetUniformLocation(prog, "passes");
-    blurShader1.vibrancy          = glGetUniformLocation(prog, "vibrancy");
-    blurShader1.vibrancy_darkness = glGetUniformLocation(prog, "vibrancy_darkness");
-
-    prog                  = createProgram(TEXVERTSRC, FRAGBLUR2);
-    blurShader2.program   = prog;
-    blurShader2.tex       = glGetUniformLocation(prog, "tex");
-    blurShader2.alpha     = glGetUniformLocation(prog, "alpha");
-    blurShader2.proj      = glGetUniformLocation(prog, "proj");
-    blurShader2.posAttrib = glGetAttribLocation(prog, "pos");
-    blurShader2.texAttrib = glGetAttribLocation(prog, "texcoord");
-    blurShader2.radius    = glGetUniformLocation(prog, "radius");
-    blurShader2.halfpixel = glGetUniformLocation(prog, "halfpixel");
-
-    prog                         = createProgram(TEXVERTSRC, FRAGBLURPREPARE);
-    blurPrepareShader.program    = prog;
-    blurPrepareShader.tex        = glGetUniformLocation(prog, "tex");
-    blurPrepareShader.proj       = glGetUniformLocation(prog, "proj");
-    blurPrepareShader.posAttrib  = glGetAttribLocation(prog, "pos");
-    blurPrepareShader.texAttrib  = glGetAttribLocation(prog, "texcoord");
-    blurPrepareShader.contrast   = glGetUniformLocation(prog, "contrast");
-    blurPrepareShader.brightness = glGetUniformLocation(prog, "brightness");
-
-    prog                          = createProgram(TEXVERTSRC, FRAGBLURFINISH);
-    blurFinishShader.program      = prog;
-    blurFinishShader.tex          = glGetUniformLocation(prog, "tex");
-    blurFinishShader.proj         = glGetUniformLocation(prog, "proj");
-    blurFinishShader.posAttrib    = glGetAttribLocation(prog, "pos");
-    blurFinishShader.texAttrib    = glGetAttribLocation(prog, "texcoord");
-    blurFinishShader.brightness   = glGetUniformLocation(prog, "brightness");
-    blurFinishShader.noise        = glGetUniformLocation(prog, "noise");
-    blurFinishShader.colorize     = glGetUniformLocation(prog, "colorize");
-    blurFinishShader.colorizeTint = glGetUniformLocation(prog, "colorizeTint");
-    blurFinishShader.boostA       = glGetUniformLocation(prog, "boostA");
-
-    prog                               = createProgram(QUADVERTSRC, FRAGBORDER);
-    borderShader.program               = prog;
-    borderShader.proj                  = glGetUniformLocation(prog, "proj");
-    borderShader.thick                 = glGetUniformLocation(prog, "thick");
-    borderShader.posAttrib             = glGetAttribLocation(prog, "pos");
-    borderShader.texAttrib             = glGetAttribLocation(prog, "texcoord");
-    borderShader.topLeft               = glGetUniformLocation(prog, "topLeft");
-    borderShader.bottomRight           = glGetUniformLocation(prog, "bottomRight");
-    borderShader.fullSize              = glGetUniformLocation(prog, "fullSize");
-    borderShader.fullSizeUntransformed = glGetUniformLocation(prog, "fullSizeUntransformed");
-    borderShader.radius                = glGetUniformLocation(prog, "radius");
-    borderShader.radiusOuter           = glGetUniformLocation(prog, "radiusOuter");
-    borderShader.gradient              = glGetUniformLocation(prog, "gradient");
-    borderShader.gradientLength        = glGetUniformLocation(prog, "gradientLength");
-    borderShader.angle                 = glGetUniformLocation(prog, "angle");
-    borderShader.gradient2             = glGetUniformLocation(prog, "gradient2");
-    borderShader.gradient2Length       = glGetUniformLocation(prog, "gradient2Length");
-    borderShader.angle2                = glGetUniformLocation(prog, "angle2");
-    borderShader.gradientLerp          = glGetUniformLocation(prog, "gradientLerp");
-    borderShader.alpha                 = glGetUniformLocation(prog, "alpha");
+    compileShaders(shaders);
 
     g_pAnimationManager->createAnimation(0.f, opacity, g_pConfigManager->m_AnimationTree.getConfig("fadeIn"));
 }
@@ -232,28 +237,28 @@ void CRenderer::renderRect(const CBox& box, const CHyprColor& col, int rounding)
     Mat3x3     matrix     = projMatrix.projectBox(ROUNDEDBOX, HYPRUTILS_TRANSFORM_NORMAL, box.rot);
     Mat3x3     glMatrix   = projection.copy().multiply(matrix);
 
-    glUseProgram(rectShader.program);
+    glUseProgram(shaders.rectShader.program);
 
-    glUniformMatrix3fv(rectShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
+    glUniformMatrix3fv(shaders.rectShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
 
     // premultiply the color as well as we don't work with straight alpha
-    glUniform4f(rectShader.color, col.r * col.a, col.g * col.a, col.b * col.a, col.a);
+    glUniform4f(shaders.rectShader.color, col.r * col.a, col.g * col.a, col.b * col.a, col.a);
 
     const auto TOPLEFT  = Vector2D(ROUNDEDBOX.x, ROUNDEDBOX.y);
     const auto FULLSIZE = Vector2D(ROUNDEDBOX.width, ROUNDEDBOX.height);
 
     // Rounded corners
-    glUniform2f(rectShader.topLeft, (float)TOPLEFT.x, (float)TOPLEFT.y);
-    glUniform2f(rectShader.fullSize, (float)FULLSIZE.x, (float)FULLSIZE.y);
-    glUniform1f(rectShader.radius, rounding);
+    glUniform2f(shaders.rectShader.topLeft, (float)TOPLEFT.x, (float)TOPLEFT.y);
+    glUniform2f(shaders.rectShader.fullSize, (float)FULLSIZE.x, (float)FULLSIZE.y);
+    glUniform1f(shaders.rectShader.radius, rounding);
 
-    glVertexAttribPointer(rectShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
+    glVertexAttribPointer(shaders.rectShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
 
-    glEnableVertexAttribArray(rectShader.posAttrib);
+    glEnableVertexAttribArray(shaders.rectShader.posAttrib);
 
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-    glDisableVertexAttribArray(rectShader.posAttrib);
+    glDisableVertexAttribArray(shaders.rectShader.posAttrib);
 }
 
 void CRenderer::renderBorder(const CBox& box, const CGradientValueData& gradient, int thickness, int rounding, float alpha) {
@@ -261,44 +266,48 @@ void CRenderer::renderBorder(const CBox& box, const CGradientValueData& gradient
     Mat3x3     matrix     = projMatrix.projectBox(ROUNDEDBOX, HYPRUTILS_TRANSFORM_NORMAL, box.rot);
     Mat3x3     glMatrix   = projection.copy().multiply(matrix);
 
-    glUseProgram(borderShader.program);
+    glUseProgram(shaders.borderShader.program);
 
-    glUniformMatrix3fv(borderShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
+    glUniformMatrix3fv(shaders.borderShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
 
-    glUniform4fv(borderShader.gradient, gradient.m_vColorsOkLabA.size() / 4, (float*)gradient.m_vColorsOkLabA.data());
-    glUniform1i(borderShader.gradientLength, gradient.m_vColorsOkLabA.size() / 4);
-    glUniform1f(borderShader.angle, (int)(gradient.m_fAngle / (M_PI / 180.0)) % 360 * (M_PI / 180.0));
-    glUniform1f(borderShader.alpha, alpha);
-    glUniform1i(borderShader.gradient2Length, 0);
+    glUniform4fv(shaders.borderShader.gradient, gradient.m_vColorsOkLabA.size() / 4, (float*)gradient.m_vColorsOkLabA.data());
+    glUniform1i(shaders.borderShader.gradientLength, gradient.m_vColorsOkLabA.size() / 4);
+    glUniform1f(shaders.borderShader.angle, (int)(gradient.m_fAngle / (M_PI / 180.0)) % 360 * (M_PI / 180.0));
+    glUniform1f(shaders.borderShader.alpha, alpha);
+    glUniform1i(shaders.borderShader.gradient2Length, 0);
 
     const auto TOPLEFT  = Vector2D(ROUNDEDBOX.x, ROUNDEDBOX.y);
     const auto FULLSIZE = Vector2D(ROUNDEDBOX.width, ROUNDEDBOX.height);
 
-    glUniform2f(borderShader.topLeft, (float)TOPLEFT.x, (float)TOPLEFT.y);
-    glUniform2f(borderShader.fullSize, (float)FULLSIZE.x, (float)FULLSIZE.y);
-    glUniform2f(borderShader.fullSizeUntransformed, (float)box.width, (float)box.height);
-    glUniform1f(borderShader.radius, rounding);
-    glUniform1f(borderShader.radiusOuter, rounding);
-    glUniform1f(borderShader.thick, thickness);
+    glUniform2f(shaders.borderShader.topLeft, (float)TOPLEFT.x, (float)TOPLEFT.y);
+    glUniform2f(shaders.borderShader.fullSize, (float)FULLSIZE.x, (float)FULLSIZE.y);
+    glUniform2f(shaders.borderShader.fullSizeUntransformed, (float)box.width, (float)box.height);
+    glUniform1f(shaders.borderShader.radius, rounding);
+    glUniform1f(shaders.borderShader.radiusOuter, rounding);
+    glUniform1f(shaders.borderShader.thick, thickness);
 
-    glVertexAttribPointer(borderShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-    glVertexAttribPointer(borderShader.texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
+    glVertexAttribPointer(shaders.borderShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
+    glVertexAttribPointer(shaders.borderShader.texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
 
-    glEnableVertexAttribArray(borderShader.posAttrib);
-    glEnableVertexAttribArray(borderShader.texAttrib);
+    glEnableVertexAttribArray(shaders.borderShader.posAttrib);
+    glEnableVertexAttribArray(shaders.borderShader.texAttrib);
 
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-    glDisableVertexAttribArray(borderShader.posAttrib);
-    glDisableVertexAttribArray(borderShader.texAttrib);
+    glDisableVertexAttribArray(shaders.borderShader.posAttrib);
+    glDisableVertexAttribArray(shaders.borderShader.texAttrib);
 }
 
 void CRenderer::renderTexture(const CBox& box, const CTexture& tex, float a, int rounding, std::optional<eTransform> tr) {
-    const auto ROUNDEDBOX = box.copy().round();
-    Mat3x3     matrix     = projMatrix.projectBox(ROUNDEDBOX, tr.value_or(HYPRUTILS_TRANSFORM_FLIPPED_180), box.rot);
-    Mat3x3     glMatrix   = projection.copy().multiply(matrix);
+    renderTextureWith(shaders, projection, box, tex, a, rounding, tr);
+}
 
-    CShader*   shader = &texShader;
+void CRenderer::renderTextureWith(const SShaders& shaders, const Mat3x3& projection, const CBox& box, const CTexture& tex, float a, int rounding, std::optional<eTransform> tr) {
+    const auto     ROUNDEDBOX = box.copy().round();
+    Mat3x3         matrix     = Mat3x3::identity().projectBox(ROUNDEDBOX, tr.value_or(HYPRUTILS_TRANSFORM_FLIPPED_180), box.rot);
+    Mat3x3         glMatrix   = projection.copy().multiply(matrix);
+
+    const CShader* shader = &shaders.texShader;
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(tex.m_iTarget, tex.m_iTexID);
@@ -339,7 +348,7 @@ void CRenderer::renderTextureMix(const CBox& box, const CTexture& tex, const CTe
     Mat3x3     matrix     = projMatrix.projectBox(ROUNDEDBOX, tr.value_or(HYPRUTILS_TRANSFORM_FLIPPED_180), box.rot);
     Mat3x3     glMatrix   = projection.copy().multiply(matrix);
 
-    CShader*   shader = &texMixShader;
+    CShader*   shader = &shaders.texMixShader;
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(tex.m_iTarget, tex.m_iTexID);
@@ -381,44 +390,45 @@ void CRenderer::renderTextureMix(const CBox& box, const CTexture& tex, const CTe
 }
 
 template <class Widget>
-static void createWidget(std::vector<ASP<IWidget>>& widgets) {
+static ASP<IWidget> createWidget() {
     const auto W = makeAtomicShared<Widget>();
     W->registerSelf(W);
-    widgets.emplace_back(W);
+    return W;
+}
+
+static ASP<IWidget> createWidgetFor(const SWidgetConfig& config) {
+    if (std::holds_alternative<SBackgroundConfig>(config.values))
+        return createWidget<CBackground>();
+    if (std::holds_alternative<SInputFieldConfig>(config.values))
+        return createWidget<CPasswordInputField>();
+    if (std::holds_alternative<SLabelConfig>(config.values))
+        return createWidget<CLabel>();
+    if (std::holds_alternative<SShapeConfig>(config.values))
+        return createWidget<CShape>();
+
+    return createWidget<CImage>();
+}
+
+static SP<COutput> outputByID(OUTPUTID id) {
+    const auto IT = std::ranges::find_if(g_pHyprlock->m_vOutputs, [id](const auto& o) { return o->m_ID == id; });
+    return IT == g_pHyprlock->m_vOutputs.end() ? nullptr : *IT;
 }
 
 std::vector<ASP<IWidget>>& CRenderer::getOrCreateWidgetsFor(const CSessionLockSurface& surf) {
     RASSERT(surf.m_outputID != OUTPUT_INVALID, "Invalid output ID!");
 
     if (!widgets.contains(surf.m_outputID)) {
-        auto CWIDGETS = g_pConfigManager->getWidgetConfigs();
+        const auto POUTPUT       = surf.m_outputRef.lock();
+        auto&      outputWidgets = widgets[surf.m_outputID];
+        auto&      outputConfigs = widgetConfigs[surf.m_outputID];
 
-        std::ranges::sort(CWIDGETS, [](CConfigManager::SWidgetConfig& a, CConfigManager::SWidgetConfig& b) {
-            return std::any_cast<Hyprlang::INT>(a.values.at("zindex")) < std::any_cast<Hyprlang::INT>(b.values.at("zindex"));
-        });
-
-        const auto POUTPUT = surf.m_outputRef.lock();
-        for (auto& c : CWIDGETS) {
-            if (!c.monitor.empty() && c.monitor != POUTPUT->stringPort && !POUTPUT->stringDesc.starts_with(c.monitor) && !("desc:" + POUTPUT->stringDesc).starts_with(c.monitor))
+        for (const auto& c : g_pConfigManager->getWidgetConfigs()) {
+            if (!POUTPUT->matchesMonitor(c.monitor))
                 continue;
 
-            // by type
-            if (c.type == "background") {
-                createWidget<CBackground>(widgets[surf.m_outputID]);
-            } else if (c.type == "input-field") {
-                createWidget<CPasswordInputField>(widgets[surf.m_outputID]);
-            } else if (c.type == "label") {
-                createWidget<CLabel>(widgets[surf.m_outputID]);
-            } else if (c.type == "shape") {
-                createWidget<CShape>(widgets[surf.m_outputID]);
-            } else if (c.type == "image") {
-                createWidget<CImage>(widgets[surf.m_outputID]);
-            } else {
-                Log::logger->log(Log::ERR, "Unknown widget type: {}", c.type);
-                continue;
-            }
-
-            widgets[surf.m_outputID].back()->configure(c.values, POUTPUT);
+            outputWidgets.emplace_back(createWidgetFor(c));
+            outputConfigs.emplace_back(c);
+            outputWidgets.back()->configure(c, POUTPUT);
         }
     }
 
@@ -426,12 +436,16 @@ std::vector<ASP<IWidget>>& CRenderer::getOrCreateWidgetsFor(const CSessionLockSu
 }
 
 void CRenderer::blurFB(const CFramebuffer& outfb, SBlurParams params) {
+    blurFBWith(shaders, projection, outfb, params);
+}
+
+void CRenderer::blurFBWith(const SShaders& shaders, const Mat3x3& projection, const CFramebuffer& outfb, SBlurParams params) {
     glDisable(GL_BLEND);
     glDisable(GL_STENCIL_TEST);
 
     CBox box{0, 0, outfb.m_vSize.x, outfb.m_vSize.y};
     box.round();
-    Mat3x3       matrix   = projMatrix.projectBox(box, HYPRUTILS_TRANSFORM_NORMAL, 0);
+    Mat3x3       matrix   = Mat3x3::identity().projectBox(box, HYPRUTILS_TRANSFORM_NORMAL, 0);
     Mat3x3       glMatrix = projection.copy().multiply(matrix);
 
     CFramebuffer mirrors[2];
@@ -451,29 +465,29 @@ void CRenderer::blurFB(const CFramebuffer& outfb, SBlurParams params) {
 
         glTexParameteri(outfb.m_cTex.m_iTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 
-        glUseProgram(blurPrepareShader.program);
+        glUseProgram(shaders.blurPrepareShader.program);
 
-        glUniformMatrix3fv(blurPrepareShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
-        glUniform1f(blurPrepareShader.contrast, params.contrast);
-        glUniform1f(blurPrepareShader.brightness, params.brightness);
-        glUniform1i(blurPrepareShader.tex, 0);
+        glUniformMatrix3fv(shaders.blurPrepareShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
+        glUniform1f(shaders.blurPrepareShader.contrast, params.contrast);
+        glUniform1f(shaders.blurPrepareShader.brightness, params.brightness);
+        glUniform1i(shaders.blurPrepareShader.tex, 0);
 
-        glVertexAttribPointer(blurPrepareShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-        glVertexAttribPointer(blurPrepareShader.texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
+        glVertexAttribPointer(shaders.blurPrepareShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
+        glVertexAttribPointer(shaders.blurPrepareShader.texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
 
-        glEnableVertexAttribArray(blurPrepareShader.posAttrib);
-        glEnableVertexAttribArray(blurPrepareShader.texAttrib);
+        glEnableVertexAttribArray(shaders.blurPrepareShader.posAttrib);
+        glEnableVertexAttribArray(shaders.blurPrepareShader.texAttrib);
 
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-        glDisableVertexAttribArray(blurPrepareShader.posAttrib);
-        glDisableVertexAttribArray(blurPrepareShader.texAttrib);
+        glDisableVertexAttribArray(shaders.blurPrepareShader.posAttrib);
+        glDisableVertexAttribArray(shaders.blurPrepareShader.texAttrib);
 
         currentRenderToFB = &mirrors[1];
     }
 
     // declare the draw func
-    auto drawPass = [&](CShader* pShader) {
+    auto drawPass = [&](const CShader* pShader) {
         if (currentRenderToFB == &mirrors[0])
             mirrors[1].bind();
         else
@@ -490,13 +504,13 @@ void CRenderer::blurFB(const CFramebuffer& outfb, SBlurParams params) {
         // prep two shaders
         glUniformMatrix3fv(pShader->proj, 1, GL_TRUE, glMatrix.getMatrix().data());
         glUniform1f(pShader->radius, params.size);
-        if (pShader == &blurShader1) {
-            glUniform2f(blurShader1.halfpixel, 0.5f / (outfb.m_vSize.x / 2.f), 0.5f / (outfb.m_vSize.y / 2.f));
-            glUniform1i(blurShader1.passes, params.passes);
-            glUniform1f(blurShader1.vibrancy, params.vibrancy);
-            glUniform1f(blurShader1.vibrancy_darkness, params.vibrancy_darkness);
+        if (pShader == &shaders.blurShader1) {
+            glUniform2f(shaders.blurShader1.halfpixel, 0.5f / (outfb.m_vSize.x / 2.f), 0.5f / (outfb.m_vSize.y / 2.f));
+            glUniform1i(shaders.blurShader1.passes, params.passes);
+            glUniform1f(shaders.blurShader1.vibrancy, params.vibrancy);
+            glUniform1f(shaders.blurShader1.vibrancy_darkness, params.vibrancy_darkness);
         } else
-            glUniform2f(blurShader2.halfpixel, 0.5f / (outfb.m_vSize.x * 2.f), 0.5f / (outfb.m_vSize.y * 2.f));
+            glUniform2f(shaders.blurShader2.halfpixel, 0.5f / (outfb.m_vSize.x * 2.f), 0.5f / (outfb.m_vSize.y * 2.f));
         glUniform1i(pShader->tex, 0);
 
         glVertexAttribPointer(pShader->posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
@@ -522,11 +536,11 @@ void CRenderer::blurFB(const CFramebuffer& outfb, SBlurParams params) {
     glBindTexture(mirrors[1].m_cTex.m_iTarget, mirrors[1].m_cTex.m_iTexID);
 
     for (int i = 1; i <= params.passes; ++i) {
-        drawPass(&blurShader1); // down
+        drawPass(&shaders.blurShader1); // down
     }
 
     for (int i = params.passes - 1; i >= 0; --i) {
-        drawPass(&blurShader2); // up
+        drawPass(&shaders.blurShader2); // up
     }
 
     // finalize the image
@@ -542,28 +556,28 @@ void CRenderer::blurFB(const CFramebuffer& outfb, SBlurParams params) {
 
         glTexParameteri(currentRenderToFB->m_cTex.m_iTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 
-        glUseProgram(blurFinishShader.program);
+        glUseProgram(shaders.blurFinishShader.program);
 
-        glUniformMatrix3fv(blurFinishShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
-        glUniform1f(blurFinishShader.noise, params.noise);
-        glUniform1f(blurFinishShader.brightness, params.brightness);
-        glUniform1i(blurFinishShader.colorize, params.colorize.has_value());
+        glUniformMatrix3fv(shaders.blurFinishShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
+        glUniform1f(shaders.blurFinishShader.noise, params.noise);
+        glUniform1f(shaders.blurFinishShader.brightness, params.brightness);
+        glUniform1i(shaders.blurFinishShader.colorize, params.colorize.has_value());
         if (params.colorize.has_value())
-            glUniform3f(blurFinishShader.colorizeTint, params.colorize->r, params.colorize->g, params.colorize->b);
-        glUniform1f(blurFinishShader.boostA, params.boostA);
+            glUniform3f(shaders.blurFinishShader.colorizeTint, params.colorize->r, params.colorize->g, params.colorize->b);
+        glUniform1f(shaders.blurFinishShader.boostA, params.boostA);
 
-        glUniform1i(blurFinishShader.tex, 0);
+        glUniform1i(shaders.blurFinishShader.tex, 0);
 
-        glVertexAttribPointer(blurFinishShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-        glVertexAttribPointer(blurFinishShader.texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
+        glVertexAttribPointer(shaders.blurFinishShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
+        glVertexAttribPointer(shaders.blurFinishShader.texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
 
-        glEnableVertexAttribArray(blurFinishShader.posAttrib);
-        glEnableVertexAttribArray(blurFinishShader.texAttrib);
+        glEnableVertexAttribArray(shaders.blurFinishShader.posAttrib);
+        glEnableVertexAttribArray(shaders.blurFinishShader.texAttrib);
 
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-        glDisableVertexAttribArray(blurFinishShader.posAttrib);
-        glDisableVertexAttribArray(blurFinishShader.texAttrib);
+        glDisableVertexAttribArray(shaders.blurFinishShader.posAttrib);
+        glDisableVertexAttribArray(shaders.blurFinishShader.texAttrib);
 
         if (currentRenderToFB != &mirrors[0])
             currentRenderToFB = &mirrors[0];
@@ -573,11 +587,15 @@ void CRenderer::blurFB(const CFramebuffer& outfb, SBlurParams params) {
 
     // finish
     outfb.bind();
-    renderTexture(box, currentRenderToFB->m_cTex, 1.0, 0, HYPRUTILS_TRANSFORM_NORMAL);
+    renderTextureWith(shaders, projection, box, currentRenderToFB->m_cTex, 1.0, 0, HYPRUTILS_TRANSFORM_NORMAL);
 
     glEnable(GL_BLEND);
 }
 
+const CRenderer::SShaders& CRenderer::getShaders() const {
+    return shaders;
+}
+
 void CRenderer::pushFb(GLint fb) {
     boundFBs.push_back(fb);
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fb);
@@ -590,20 +608,90 @@ void CRenderer::popFb() {
 
 void CRenderer::removeWidgetsFor(OUTPUTID id) {
     widgets.erase(id);
+    widgetConfigs.erase(id);
 }
 
 void CRenderer::reconfigureWidgetsFor(OUTPUTID id) {
-    // TODO: reconfigure widgets by just calling their configure method again.
-    // Requires a way to get a widgets config properties.
-    // I think the best way would be to store the anonymos key of the widget config.
-    removeWidgetsFor(id);
+    const auto POUTPUT = outputByID(id);
+    if (!POUTPUT || !widgets.contains(id))
+        return;
+
+    const auto& CONFIGS = widgetConfigs[id];
+    for (size_t i = 0; i < CONFIGS.size(); i++) {
+        widgets[id][i]->configure(CONFIGS[i], POUTPUT);
+    }
+}
+
+void CRenderer::updateWidgets() {
+    for (auto& [id, oldWidgets] : widgets) {
+        const auto POUTPUT = outputByID(id);
+        if (!POUTPUT)
+            continue;
+
+        auto&                      oldConfigs = widgetConfigs[id];
+        std::vector<bool>          taken(oldWidgets.size(), false);
+        std::vector<SWidgetConfig> newConfigs;
+        for (const auto& c : g_pConfigManager->getWidgetConfigs()) {
+            if (POUTPUT->matchesMonitor(c.monitor))
+                newConfigs.emplace_back(c);
+        }
+
+        // Anonymous config sections have no identity. A widget is matched to an identical config first, then to the next one of its type.
+        std::vector<ASP<IWidget>> newWidgets(newConfigs.size());
+        for (size_t i = 0; i < newConfigs.size(); i++) {
+            for (size_t j = 0; j < oldConfigs.size(); j++) {
+                if (taken[j] || oldConfigs[j] != newConfigs[i])
+                    continue;
+
+                newWidgets[i] = oldWidgets[j];
+                taken[j]      = true;
+                break;
+            }
+        }
+
+        size_t reconfigured = 0;
+        size_t created      = 0;
+        for (size_t i = 0; i < newConfigs.size(); i++) {
+            if (newWidgets[i])
+                continue;
+
+            for (size_t j = 0; j < oldConfigs.size(); j++) {
+                if (taken[j] || oldConfigs[j].values.index() != newConfigs[i].values.index())
+                    continue;
+
+                newWidgets[i] = oldWidgets[j];
+                taken[j]      = true;
+                break;
+            }
+
+            if (newWidgets[i])
+                reconfigured++;
+            else {
+                newWidgets[i] = createWidgetFor(newConfigs[i]);
+                created++;
+            }
+
+            newWidgets[i]->configure(newConfigs[i], POUTPUT);
+        }
+
+        Log::logger->log(Log::INFO, "Config reload on {}: {} widgets kept, {} reconfigured, {} created, {} removed", POUTPUT->stringPort,
+                         newWidgets.size() - reconfigured - created, reconfigured, created, std::ranges::count(taken, false));
+
+        oldWidgets = std::move(newWidgets);
+        oldConfigs = std::move(newConfigs);
+    }
 }
 
 void CRenderer::startFadeIn() {
     Log::logger->log(Log::INFO, "Starting fade in");
     *opacity = 1.f;
 
-    opacity->setCallbackOnEnd([this](auto) { opacity->setConfig(g_pConfigManager->m_AnimationTree.getConfig("fadeOut")); }, true);
+    opacity->setCallbackOnEnd(
+        [this](auto) {
+            opacity->setConfig(g_pConfigManager->m_AnimationTree.getConfig("fadeOut"));
+            g_asyncResourceManager->shrinkScreencopyFrames();
+        },
+        true);
 }
 
 void CRenderer::startFadeOut(bool unlock) {
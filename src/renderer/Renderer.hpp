@@ -12,6 +12,7 @@
 #include "Framebuffer.hpp"
 
 typedef std::unordered_map<OUTPUTID, std::vector<ASP<IWidget>>> widgetMap_t;
+typedef std::unordered_map<OUTPUTID, std::vector<SWidgetConfig>> widgetConfigMap_t;
 
 class CRenderer {
   public:
@@ -28,6 +29,28 @@ class CRenderer {
         float                     boostA = 1.0;
     };
 
+    // Shader programs have per program uniform state, so every thread that renders needs its own set.
+    struct SShaders {
+        CShader rectShader;
+        CShader texShader;
+        CShader texMixShader;
+        CShader blurShader1;
+        CShader blurShader2;
+        CShader blurPrepareShader;
+        CShader blurFinishShader;
+        CShader borderShader;
+    };
+
+    // Compiles all shaders for the context current on the calling thread.
+    static void compileShaders(SShaders& shaders);
+    // Stateless variants of renderTexture and blurFB, for rendering from a context other than the main one (see CGLWorker).
+    static void renderTextureWith(const SShaders& shaders, const Mat3x3& projection, const CBox& box, const CTexture& tex, float a = 1.0, int rounding = 0,
+                                  std::optional<eTransform> tr = {});
+    static void blurFBWith(const SShaders& shaders, const Mat3x3& projection, const CFramebuffer& outfb, SBlurParams params);
+
+    // The shaders of the main context.
+    const SShaders& getShaders() const;
+
     SRenderFeedback renderLock(const CSessionLockSurface& surf);
 
     void            renderRect(const CBox& box, const CHyprColor& col, int rounding = 0);
@@ -42,7 +65,10 @@ class CRenderer {
     void                                  popFb();
 
     void                                  removeWidgetsFor(OUTPUTID id);
+    // Configures the widgets of the output again, for a new size or scale.
     void                                  reconfigureWidgetsFor(OUTPUTID id);
+    // After a config reload. Widgets keep their state unless their config changed, only added and removed ones are created or destroyed.
+    void                                  updateWidgets();
 
     void                                  startFadeIn();
     void                                  startFadeOut(bool unlock = false);
@@ -51,15 +77,10 @@ class CRenderer {
 
   private:
     widgetMap_t        widgets;
+    // What each widget was configured with, by the index in widgets.
+    widgetConfigMap_t  widgetConfigs;
 
-    CShader            rectShader;
-    CShader            texShader;
-    CShader            texMixShader;
-    CShader            blurShader1;
-    CShader            blurShader2;
-    CShader            blurPrepareShader;
-    CShader            blurFinishShader;
-    CShader            borderShader;
+    SShaders           shaders;
 
     Mat3x3             projMatrix = Mat3x3::identity();
     Mat3x3             projection;
@@ -0,0 +1,43 @@
+#include "ResourceHandle.hpp"
+#include "AsyncResourceManager.hpp"
+
+#include <utility>
+
+CResourceHandle::CResourceHandle(ResourceID id) : m_id(id) {
+    ;
+}
+
+CResourceHandle::~CResourceHandle() {
+    reset();
+}
+
+CResourceHandle::CResourceHandle(CResourceHandle&& other) noexcept : m_id(std::exchange(other.m_id, 0)) {
+    ;
+}
+
+CResourceHandle& CResourceHandle::operator=(CResourceHandle&& other) noexcept {
+    if (this != &other) {
+        // Take the new reference first, both handles may refer to the same resource.
+        const auto OLDID = std::exchange(m_id, std::exchange(other.m_id, 0));
+        if (OLDID != 0 && g_asyncResourceManager)
+            g_asyncResourceManager->unloadById(OLDID);
+    }
+
+    return *this;
+}
+
+ResourceID CResourceHandle::id() const {
+    return m_id;
+}
+
+void CResourceHandle::reset() {
+    // The manager may already be gone during shutdown.
+    if (m_id != 0 && g_asyncResourceManager)
+        g_asyncResourceManager->unloadById(m_id);
+
+    m_id = 0;
+}
+
+CResourceHandle::operator bool() const {
+    return m_id != 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../defines.hpp"
+
+class CAsyncResourceManager;
+
+// One reference to a resource requested from CAsyncResourceManager.
+// The reference is released when the handle is destroyed, reset or assigned another handle.
+class CResourceHandle {
+  public:
+    CResourceHandle() = default;
+    ~CResourceHandle();
+
+    CResourceHandle(const CResourceHandle&)            = delete;
+    CResourceHandle& operator=(const CResourceHandle&) = delete;
+    CResourceHandle(CResourceHandle&& other) noexcept;
+    CResourceHandle& operator=(CResourceHandle&& other) noexcept;
+
+    // 0 if the handle is empty.
+    ResourceID id() const;
+    void       reset();
+
+    explicit   operator bool() const;
+
+  private:
+    explicit CResourceHandle(ResourceID id);
+
+    ResourceID m_id = 0;
+
+    friend class CAsyncResourceManager;
+};
@@ -0,0 +1,101 @@
+#include "ResourceScheduler.hpp"
+
+#include "../helpers/Log.hpp"
+
+#include <algorithm>
+
+using namespace Hyprgraphics;
+
+static const char* priorityName(size_t priority) {
+    switch (priority) {
+        case RESOURCE_PRIORITY_BACKGROUND: return "background";
+        case RESOURCE_PRIORITY_VISIBLE: return "visible";
+        case RESOURCE_PRIORITY_RELOAD: return "reload";
+        default: return "unknown";
+    }
+}
+
+CResourceScheduler::CResourceScheduler(std::function<void(ResourceID, const ASP<IAsyncResource>&)> onDone) : m_onDone(std::move(onDone)) {
+    // One slow resource (a cmd[] label, a huge image) should not hold up the rest.
+    const size_t WORKERS = std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 2, 4);
+
+    for (size_t i = 0; i < WORKERS; i++) {
+        m_threads.emplace_back([this]() { workerThread(); });
+    }
+}
+
+CResourceScheduler::~CResourceScheduler() {
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_exit = true;
+    }
+    m_cv.notify_all();
+
+    for (auto& t : m_threads) {
+        if (t.joinable())
+            t.join();
+    }
+}
+
+void CResourceScheduler::enqueue(ResourceID id, const ASP<IAsyncResource>& resource, eResourcePriority priority) {
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_queues[std::min(priority, (eResourcePriority)(RESOURCE_PRIORITY_COUNT - 1))].emplace_back(
+            SJob{.id = id, .resource = resource, .queued = std::chrono::steady_clock::now()});
+    }
+    m_cv.notify_one();
+}
+
+bool CResourceScheduler::cancel(const ASP<IAsyncResource>& resource) {
+    std::lock_guard<std::mutex> lg(m_mutex);
+
+    for (size_t priority = 0; priority < RESOURCE_PRIORITY_COUNT; priority++) {
+        if (std::erase_if(m_queues[priority], [&resource](const auto& job) { return job.resource == resource; }) > 0) {
+            m_stats[priority].cancelled++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void CResourceScheduler::workerThread() {
+    while (true) {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_cv.wait(lk, [this] { return m_exit || std::ranges::any_of(m_queues, [](const auto& q) { return !q.empty(); }); });
+
+        if (m_exit)
+            return;
+
+        const auto PRIORITY = std::ranges::find_if(m_queues, [](const auto& q) { return !q.empty(); }) - m_queues.begin();
+        const auto JOB      = std::move(m_queues[PRIORITY].front());
+        m_queues[PRIORITY].pop_front();
+
+        const auto WAIT  = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - JOB.queued);
+        auto&      stats = m_stats[PRIORITY];
+        stats.jobs++;
+        stats.totalWait += WAIT;
+        if (WAIT > stats.maxWait)
+            stats.maxWait = WAIT;
+        lk.unlock();
+
+        Log::logger->log(Log::TRACE, "Rendering resourceID: {} ({} priority, queued for {}us)", JOB.id, priorityName(PRIORITY), WAIT.count());
+
+        JOB.resource->render();
+
+        m_onDone(JOB.id, JOB.resource);
+    }
+}
+
+void CResourceScheduler::logStats() {
+    std::lock_guard<std::mutex> lg(m_mutex);
+
+    for (size_t priority = 0; priority < RESOURCE_PRIORITY_COUNT; priority++) {
+        const auto& STATS = m_stats[priority];
+        if (STATS.jobs == 0 && STATS.cancelled == 0)
+            continue;
+
+        Log::logger->log(Log::INFO, "Resource queue {}: {} rendered, {} cancelled, average wait {:.1f}ms, max wait {:.1f}ms", priorityName(priority), STATS.jobs, STATS.cancelled,
+                         STATS.jobs ? STATS.totalWait.count() / 1000.F / STATS.jobs : 0.F, STATS.maxWait.count() / 1000.F);
+    }
+}
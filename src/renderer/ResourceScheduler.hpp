@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../defines.hpp"
+#include <hyprgraphics/resource/resources/AsyncResource.hpp>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum eResourcePriority : uint8_t {
+    RESOURCE_PRIORITY_BACKGROUND = 0, // backgrounds, they gate the first frame
+    RESOURCE_PRIORITY_VISIBLE,        // text and images shown from the start
+    RESOURCE_PRIORITY_RELOAD,         // periodic label updates and image reloads
+    RESOURCE_PRIORITY_COUNT,
+};
+
+// Renders async resources on a few worker threads.
+// Jobs are taken from the highest priority queue first, in request order within a priority.
+// Queued jobs can be cancelled. Jobs that already started run to completion.
+class CResourceScheduler {
+  public:
+    // onDone is called from a worker thread after the resource rendered.
+    CResourceScheduler(std::function<void(ResourceID, const ASP<Hyprgraphics::IAsyncResource>&)> onDone);
+    ~CResourceScheduler();
+
+    void enqueue(ResourceID id, const ASP<Hyprgraphics::IAsyncResource>& resource, eResourcePriority priority);
+    // Returns true if the resource was still queued. It will not be rendered and onDone is not called for it.
+    bool cancel(const ASP<Hyprgraphics::IAsyncResource>& resource);
+
+    void logStats();
+
+  private:
+    struct SJob {
+        ResourceID                            id = 0;
+        ASP<Hyprgraphics::IAsyncResource>     resource;
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    struct SQueueStats {
+        size_t                    jobs      = 0;
+        size_t                    cancelled = 0;
+        std::chrono::microseconds totalWait{0};
+        std::chrono::microseconds maxWait{0};
+    };
+
+    void                                                                      workerThread();
+
+    std::function<void(ResourceID, const ASP<Hyprgraphics::IAsyncResource>&)> m_onDone;
+
+    // shared between threads
+    std::mutex                                                                m_mutex;
+    std::condition_variable                                                   m_cv;
+    std::array<std::deque<SJob>, RESOURCE_PRIORITY_COUNT>                     m_queues;
+    std::array<SQueueStats, RESOURCE_PRIORITY_COUNT>                          m_stats;
+    bool                                                                      m_exit = false;
+
+    std::vector<std::thread>                                                  m_threads;
+};
@@ -2,12 +2,14 @@
 #include "./AsyncResourceManager.hpp"
 #include "../helpers/Log.hpp"
 #include "../helpers/MiscFunctions.hpp"
+#include "../helpers/PixelConvert.hpp"
 #include "../core/hyprlock.hpp"
 #include "../core/Egl.hpp"
 #include "../config/ConfigManager.hpp"
 #include "wlr-screencopy-unstable-v1.hpp"
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
+#include <chrono>
 #include <cstring>
 #include <array>
 #include <cstdint>
@@ -21,7 +23,6 @@
 #include <GLES2/gl2ext.h>
 
 static PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES = nullptr;
-static PFNEGLQUERYDMABUFMODIFIERSEXTPROC   eglQueryDmaBufModifiersEXT   = nullptr;
 
 //
 void CScreencopyFrame::capture(SP<COutput> pOutput) {
@@ -31,6 +32,7 @@ void CScreencopyFrame::capture(SP<COutput> pOutput) {
 
     m_asset      = makeAtomicShared<CTexture>();
     m_resourceID = CAsyncResourceManager::resourceIDForScreencopy(pOutput->stringPort);
+    m_output     = pOutput;
 
     m_sc = makeShared<CCZwlrScreencopyFrameV1>(g_pHyprlock->getScreencopy()->sendCaptureOutput(false, pOutput->m_wlOutput->resource()));
 
@@ -91,9 +93,6 @@ CSCDMAFrame::CSCDMAFrame(SP<CCZwlrScreencopyFrameV1> sc) : m_sc(sc) {
         return;
     }
 
-    if (!eglQueryDmaBufModifiersEXT)
-        eglQueryDmaBufModifiersEXT = (PFNEGLQUERYDMABUFMODIFIERSEXTPROC)eglGetProcAddress("eglQueryDmaBufModifiersEXT");
-
     m_sc->setLinuxDmabuf([this](CCZwlrScreencopyFrameV1* r, uint32_t format, uint32_t width, uint32_t height) {
         Log::logger->log(Log::TRACE, "[sc] wlrOnDmabuf for {}", (void*)this);
 
@@ -110,94 +109,23 @@ CSCDMAFrame::CSCDMAFrame(SP<CCZwlrScreencopyFrameV1> sc) : m_sc(sc) {
 }
 
 CSCDMAFrame::~CSCDMAFrame() {
-    if (g_pEGL)
-        eglDestroyImage(g_pEGL->eglDisplay, m_image);
-
-    // leaks bo and stuff but lives throughout so for now who cares
+    if (g_pSCBufferPool)
+        g_pSCBufferPool->release(m_buffer, m_discardBuffer);
 }
 
 bool CSCDMAFrame::onBufferDone() {
-    uint32_t flags = GBM_BO_USE_RENDERING;
-
-    if (!eglQueryDmaBufModifiersEXT) {
-        Log::logger->log(Log::WARN, "Querying modifiers without eglQueryDmaBufModifiersEXT support");
-        m_bo = gbm_bo_create(g_pHyprlock->dma.gbmDevice, m_w, m_h, m_fmt, flags);
-    } else {
-        std::array<uint64_t, 64>   mods;
-        std::array<EGLBoolean, 64> externalOnly;
-        int                        num = 0;
-        if (!eglQueryDmaBufModifiersEXT(g_pEGL->eglDisplay, m_fmt, 64, mods.data(), externalOnly.data(), &num) || num == 0) {
-            Log::logger->log(Log::WARN, "eglQueryDmaBufModifiersEXT failed, falling back to regular bo");
-            m_bo = gbm_bo_create(g_pHyprlock->dma.gbmDevice, m_w, m_h, m_fmt, flags);
-        } else {
-            Log::logger->log(Log::INFO, "eglQueryDmaBufModifiersEXT found {} mods", num);
-            std::vector<uint64_t> goodMods;
-            for (int i = 0; i < num; ++i) {
-                if (externalOnly[i]) {
-                    Log::logger->log(Log::TRACE, "Modifier {:x} failed test", mods[i]);
-                    continue;
-                }
-
-                Log::logger->log(Log::TRACE, "Modifier {:x} passed test", mods[i]);
-                goodMods.emplace_back(mods[i]);
-            }
-
-            m_bo = gbm_bo_create_with_modifiers2(g_pHyprlock->dma.gbmDevice, m_w, m_h, m_fmt, goodMods.data(), goodMods.size(), flags);
-        }
-    }
-
-    if (!m_bo) {
-        Log::logger->log(Log::ERR, "[bo] Couldn't create a drm buffer");
+    if (!g_pSCBufferPool)
         return false;
-    }
 
-    m_planes = gbm_bo_get_plane_count(m_bo);
-    Log::logger->log(Log::INFO, "[bo] has {} plane(s)", m_planes);
-
-    m_mod = gbm_bo_get_modifier(m_bo);
-    Log::logger->log(Log::INFO, "[bo] chose modifier {:x}", m_mod);
-
-    auto params = makeShared<CCZwpLinuxBufferParamsV1>(g_pHyprlock->dma.linuxDmabuf->sendCreateParams());
-    if (!params) {
-        Log::logger->log(Log::ERR, "zwp_linux_dmabuf_v1_create_params failed");
-        gbm_bo_destroy(m_bo);
+    m_buffer = g_pSCBufferPool->acquireDMA(m_fmt, m_w, m_h);
+    if (!m_buffer)
         return false;
-    }
-
-    for (size_t plane = 0; plane < (size_t)m_planes; plane++) {
-        m_stride[plane] = gbm_bo_get_stride_for_plane(m_bo, plane);
-        m_offset[plane] = gbm_bo_get_offset(m_bo, plane);
-        m_fd[plane]     = gbm_bo_get_fd_for_plane(m_bo, plane);
-
-        if (m_fd[plane] < 0) {
-            Log::logger->log(Log::ERR, "gbm_m_bo_get_fd_for_plane failed");
-            params.reset();
-            gbm_bo_destroy(m_bo);
-            for (size_t plane_tmp = 0; plane_tmp < plane; plane_tmp++) {
-                close(m_fd[plane_tmp]);
-            }
-            return false;
-        }
-
-        params->sendAdd(m_fd[plane], plane, m_offset[plane], m_stride[plane], m_mod >> 32, m_mod & 0xffffffff);
-    }
-
-    m_wlBuffer = makeShared<CCWlBuffer>(params->sendCreateImmed(m_w, m_h, m_fmt, (zwpLinuxBufferParamsV1Flags)0));
-    params.reset();
-
-    if (!m_wlBuffer) {
-        Log::logger->log(Log::ERR, "[pw] zwp_linux_buffer_params_v1_create_immed failed");
-        gbm_bo_destroy(m_bo);
-        for (size_t plane = 0; plane < (size_t)m_planes; plane++)
-            close(m_fd[plane]);
-
-        return false;
-    }
 
+    m_wlBuffer = m_buffer->m_wlBuffer;
     return true;
 }
 
-bool CSCDMAFrame::onBufferReady(ASP<CTexture> texture) {
+bool CSCDMAFrame::createImage() {
     static constexpr struct {
         EGLAttrib fd;
         EGLAttrib offset;
@@ -228,29 +156,42 @@ bool CSCDMAFrame::onBufferReady(ASP<CTexture> texture) {
     std::vector<EGLAttrib> attribs = {
         EGL_WIDTH, m_w, EGL_HEIGHT, m_h, EGL_LINUX_DRM_FOURCC_EXT, m_fmt,
     };
-    for (int i = 0; i < m_planes; i++) {
+    for (int i = 0; i < m_buffer->m_planes; i++) {
         attribs.emplace_back(attrNames[i].fd);
-        attribs.emplace_back(m_fd[i]);
+        attribs.emplace_back(m_buffer->m_fd[i]);
         attribs.emplace_back(attrNames[i].offset);
-        attribs.emplace_back(m_offset[i]);
+        attribs.emplace_back(m_buffer->m_offset[i]);
         attribs.emplace_back(attrNames[i].pitch);
-        attribs.emplace_back(m_stride[i]);
-        if (m_mod != DRM_FORMAT_MOD_INVALID) {
+        attribs.emplace_back(m_buffer->m_stride[i]);
+        if (m_buffer->m_mod != DRM_FORMAT_MOD_INVALID) {
             attribs.emplace_back(attrNames[i].modlo);
-            attribs.emplace_back(m_mod & 0xFFFFFFFF);
+            attribs.emplace_back(m_buffer->m_mod & 0xFFFFFFFF);
             attribs.emplace_back(attrNames[i].modhi);
-            attribs.emplace_back(m_mod >> 32);
+            attribs.emplace_back(m_buffer->m_mod >> 32);
         }
     }
     attribs.emplace_back(EGL_NONE);
 
-    m_image = eglCreateImage(g_pEGL->eglDisplay, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr, attribs.data());
+    m_buffer->m_image = eglCreateImage(g_pEGL->eglDisplay, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr, attribs.data());
 
-    if (m_image == EGL_NO_IMAGE) {
+    if (m_buffer->m_image == EGL_NO_IMAGE) {
         Log::logger->log(Log::ERR, "Failed creating an egl image");
         return false;
     }
 
+    return true;
+}
+
+bool CSCDMAFrame::onBufferReady(ASP<CTexture> texture) {
+    if (!m_buffer || !glEGLImageTargetTexture2DOES)
+        return false;
+
+    // The image is kept with the buffer, a reused buffer was already imported.
+    if (m_buffer->m_image == EGL_NO_IMAGE && !createImage())
+        return false;
+
+    const bool TENBIT = m_fmt == DRM_FORMAT_XRGB2101010 || m_fmt == DRM_FORMAT_XBGR2101010 || m_fmt == DRM_FORMAT_ARGB2101010 || m_fmt == DRM_FORMAT_ABGR2101010;
+
     texture->allocate();
     texture->m_vSize = {m_w, m_h};
     glBindTexture(GL_TEXTURE_2D, texture->m_iTexID);
@@ -258,7 +199,39 @@ bool CSCDMAFrame::onBufferReady(ASP<CTexture> texture) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, m_image);
+    glTexImage2D(GL_TEXTURE_2D, 0, TENBIT ? GL_RGB10_A2 : GL_RGBA8, m_w, m_h, 0, GL_RGBA, TENBIT ? GL_UNSIGNED_INT_2_10_10_10_REV : GL_UNSIGNED_BYTE, nullptr);
+
+    // Copy the frame out of the dmabuf, so that the buffer can go back to the pool.
+    GLuint imageTex = 0;
+    glGenTextures(1, &imageTex);
+    glBindTexture(GL_TEXTURE_2D, imageTex);
+    glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, m_buffer->m_image);
+
+    GLuint fbs[2] = {0, 0};
+    glGenFramebuffers(2, fbs);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbs[0]);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, imageTex, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbs[1]);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->m_iTexID, 0);
+
+    const bool COPIED = glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE && glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (COPIED)
+        glBlitFramebuffer(0, 0, m_w, m_h, 0, 0, m_w, m_h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(2, fbs);
+    glDeleteTextures(1, &imageTex);
+
+    if (COPIED) {
+        // Submit the copy before the compositor gets to write into the buffer again.
+        glFlush();
+    } else {
+        Log::logger->log(Log::WARN, "[sc] Can't copy from the dmabuf, sampling it directly");
+        glBindTexture(GL_TEXTURE_2D, texture->m_iTexID);
+        glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, m_buffer->m_image);
+        m_discardBuffer = true;
+    }
+
     glBindTexture(GL_TEXTURE_2D, 0);
 
     Log::logger->log(Log::INFO, "Got dma frame with size {}", texture->m_vSize);
@@ -272,42 +245,19 @@ CSCSHMFrame::CSCSHMFrame(SP<CCZwlrScreencopyFrameV1> sc) : m_sc(sc) {
     m_sc->setBuffer([this](CCZwlrScreencopyFrameV1* r, uint32_t format, uint32_t width, uint32_t height, uint32_t stride) {
         Log::logger->log(Log::TRACE, "[sc] [shm] wlrOnBuffer for {}", (void*)this);
 
-        const auto SIZE = stride * height;
-        m_shmFmt        = format;
-        m_w             = width;
-        m_h             = height;
-        m_stride        = stride;
-
-        // Create a shm pool with format and size
-        std::string shmPoolFile;
-        const auto  FD = createPoolFile(SIZE, shmPoolFile);
+        m_shmFmt = format;
+        m_w      = width;
+        m_h      = height;
+        m_stride = stride;
 
-        if (FD < 0) {
-            Log::logger->log(Log::ERR, "[sc] [shm] failed to create a pool file");
-            return;
-        }
-
-        m_shmData = mmap(nullptr, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, FD, 0);
-        if (m_shmData == MAP_FAILED) {
-            Log::logger->log(Log::ERR, "[sc] [shm] failed to (errno {})", strerror(errno));
-            close(FD);
+        m_buffer = g_pSCBufferPool ? g_pSCBufferPool->acquireSHM(format, width, height, stride) : nullptr;
+        if (!m_buffer) {
             m_ok = false;
             return;
         }
 
-        if (!g_pHyprlock->getShm()) {
-            Log::logger->log(Log::ERR, "[sc] [shm] Failed to get WLShm global");
-            close(FD);
-            m_ok = false;
-            return;
-        }
-
-        auto pShmPool = makeShared<CCWlShmPool>(g_pHyprlock->getShm()->sendCreatePool(FD, SIZE));
-        m_wlBuffer    = makeShared<CCWlBuffer>(pShmPool->sendCreateBuffer(0, width, height, stride, m_shmFmt));
-
-        pShmPool.reset();
-
-        close(FD);
+        m_shmData  = m_buffer->m_shmData;
+        m_wlBuffer = m_buffer->m_wlBuffer;
     });
 
     m_sc->setLinuxDmabuf([](CCZwlrScreencopyFrameV1* r, uint32_t, uint32_t, uint32_t) {
@@ -316,79 +266,33 @@ CSCSHMFrame::CSCSHMFrame(SP<CCZwlrScreencopyFrameV1> sc) : m_sc(sc) {
 }
 
 CSCSHMFrame::~CSCSHMFrame() {
-    if (m_convBuffer)
-        free(m_convBuffer);
-    if (m_shmData)
-        munmap(m_shmData, m_stride * m_h);
+    if (g_pSCBufferPool)
+        g_pSCBufferPool->release(m_buffer);
 }
 
 void CSCSHMFrame::convertBuffer() {
     const auto BYTESPERPX = m_stride / m_w;
+    const auto START      = std::chrono::steady_clock::now();
+
     if (BYTESPERPX == 4) {
         switch (m_shmFmt) {
             case WL_SHM_FORMAT_ARGB8888:
             case WL_SHM_FORMAT_XRGB8888: {
                 Log::logger->log(Log::INFO, "[sc] [shm] Converting ARGB to RGBA");
-                uint8_t* data = (uint8_t*)m_shmData;
-
-                for (uint32_t y = 0; y < m_h; ++y) {
-                    for (uint32_t x = 0; x < m_w; ++x) {
-                        struct pixel {
-                            // little-endian ARGB
-                            unsigned char blue;
-                            unsigned char green;
-                            unsigned char red;
-                            unsigned char alpha;
-                        }* px = (struct pixel*)(data + (y * m_w * 4) + (x * 4));
-
-                        // RGBA
-                        *px = {.blue = px->red, .green = px->green, .red = px->blue, .alpha = px->alpha};
-                    }
-                }
+                PixelConvert::swapRB((uint8_t*)m_shmData, (size_t)m_w * m_h);
             } break;
             case WL_SHM_FORMAT_ABGR8888:
             case WL_SHM_FORMAT_XBGR8888: {
-                Log::logger->log(Log::INFO, "[sc] [shm] Converting ABGR to RGBA");
-                uint8_t* data = (uint8_t*)m_shmData;
-
-                for (uint32_t y = 0; y < m_h; ++y) {
-                    for (uint32_t x = 0; x < m_w; ++x) {
-                        struct pixel {
-                            // little-endian ARGB
-                            unsigned char blue;
-                            unsigned char green;
-                            unsigned char red;
-                            unsigned char alpha;
-                        }* px = (struct pixel*)(data + (y * m_w * 4) + (x * 4));
-
-                        // BGRA
-                        *px = {.blue = px->blue, .green = px->green, .red = px->red, .alpha = px->alpha};
-                    }
-                }
+                // little-endian ABGR is RGBA in memory already
+                Log::logger->log(Log::INFO, "[sc] [shm] ABGR needs no conversion");
             } break;
             case WL_SHM_FORMAT_ABGR2101010:
             case WL_SHM_FORMAT_ARGB2101010:
             case WL_SHM_FORMAT_XRGB2101010:
             case WL_SHM_FORMAT_XBGR2101010: {
                 Log::logger->log(Log::INFO, "[sc] [shm] Converting 10-bit channels to 8-bit");
-                uint8_t*   data = (uint8_t*)m_shmData;
-
-                const bool FLIP = m_shmFmt != WL_SHM_FORMAT_XBGR2101010;
-
-                for (uint32_t y = 0; y < m_h; ++y) {
-                    for (uint32_t x = 0; x < m_w; ++x) {
-                        uint32_t* px = (uint32_t*)(data + (y * m_w * 4) + (x * 4));
-
-                        // conv to 8 bit
-                        uint8_t R = (uint8_t)std::round((255.0 * (((*px) & 0b00000000000000000000001111111111) >> 0) / 1023.0));
-                        uint8_t G = (uint8_t)std::round((255.0 * (((*px) & 0b00000000000011111111110000000000) >> 10) / 1023.0));
-                        uint8_t B = (uint8_t)std::round((255.0 * (((*px) & 0b00111111111100000000000000000000) >> 20) / 1023.0));
-                        uint8_t A = (uint8_t)std::round((255.0 * (((*px) & 0b11000000000000000000000000000000) >> 30) / 3.0));
-
-                        // write 8-bit values
-                        *px = ((FLIP ? B : R) << 0) + (G << 8) + ((FLIP ? R : B) << 16) + (A << 24);
-                    }
-                }
+                const bool FLIP = m_shmFmt == WL_SHM_FORMAT_ARGB2101010 || m_shmFmt == WL_SHM_FORMAT_XRGB2101010;
+                PixelConvert::pack2101010((uint8_t*)m_shmData, (size_t)m_w * m_h, FLIP);
             } break;
             default: {
                 Log::logger->log(Log::WARN, "[sc] [shm] Unsupported format {}", m_shmFmt);
@@ -396,52 +300,17 @@ void CSCSHMFrame::convertBuffer() {
         }
     } else if (BYTESPERPX == 3) {
         Log::logger->log(Log::INFO, "[sc] [shm] Converting 24 bit to 32 bit");
-        m_convBuffer        = malloc(m_w * m_h * 4);
-        const int NEWSTRIDE = m_w * 4;
+        if (!m_buffer->m_convBuffer)
+            m_buffer->m_convBuffer = malloc(m_w * m_h * 4);
+        m_convBuffer = m_buffer->m_convBuffer;
         RASSERT(m_convBuffer, "malloc failed");
 
         switch (m_shmFmt) {
-            case WL_SHM_FORMAT_BGR888: {
-                Log::logger->log(Log::INFO, "[sc] [shm] Converting BGR to RGBA");
-                for (uint32_t y = 0; y < m_h; ++y) {
-                    for (uint32_t x = 0; x < m_w; ++x) {
-                        struct pixel3 {
-                            // little-endian RGB
-                            unsigned char blue;
-                            unsigned char green;
-                            unsigned char red;
-                        }* srcPx = (struct pixel3*)((char*)m_shmData + (y * m_stride) + (x * 3));
-                        struct pixel4 {
-                            // little-endian ARGB
-                            unsigned char blue;
-                            unsigned char green;
-                            unsigned char red;
-                            unsigned char alpha;
-                        }* dstPx = (struct pixel4*)((char*)m_convBuffer + (y * NEWSTRIDE) + (x * 4));
-                        *dstPx   = {.blue = srcPx->blue, .green = srcPx->green, .red = srcPx->red, .alpha = 0xFF};
-                    }
-                }
-            } break;
+            // Both end up with the first three bytes of each pixel as the color channels.
+            case WL_SHM_FORMAT_BGR888:
             case WL_SHM_FORMAT_RGB888: {
-                Log::logger->log(Log::INFO, "[sc] [shm] Converting RGB to RGBA");
-                for (uint32_t y = 0; y < m_h; ++y) {
-                    for (uint32_t x = 0; x < m_w; ++x) {
-                        struct pixel3 {
-                            // big-endian RGB
-                            unsigned char red;
-                            unsigned char green;
-                            unsigned char blue;
-                        }* srcPx = (struct pixel3*)((char*)m_shmData + (y * m_stride) + (x * 3));
-                        struct pixel4 {
-                            // big-endian ARGB
-                            unsigned char alpha;
-                            unsigned char red;
-                            unsigned char green;
-                            unsigned char blue;
-                        }* dstPx = (struct pixel4*)((char*)m_convBuffer + (y * NEWSTRIDE) + (x * 4));
-                        *dstPx   = {.alpha = srcPx->red, .red = srcPx->green, .green = srcPx->blue, .blue = 0xFF};
-                    }
-                }
+                Log::logger->log(Log::INFO, "[sc] [shm] Converting {} to RGBA", m_shmFmt == WL_SHM_FORMAT_BGR888 ? "BGR" : "RGB");
+                PixelConvert::expand24((const uint8_t*)m_shmData, m_stride, (uint8_t*)m_convBuffer, m_w, m_h);
             } break;
             default: {
                 Log::logger->log(Log::ERR, "[sc] [shm] Unsupported format for 24bit buffer {}", m_shmFmt);
@@ -451,10 +320,74 @@ void CSCSHMFrame::convertBuffer() {
     } else {
         Log::logger->log(Log::ERR, "[sc] [shm] Unsupported bytes per pixel {}", BYTESPERPX);
     }
+
+    Log::logger->log(Log::TRACE, "[sc] [shm] Conversion took {:.2f}ms ({})",
+                     std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - START).count() / 1000.F, PixelConvert::implName());
+}
+
+bool CSCSHMFrame::uploadDirect() {
+    GLint    glIFormat = 0, glFormat = 0, glType = 0;
+    uint32_t bytesPerPx = 4;
+    bool     swapRB     = false;
+
+    switch (m_shmFmt) {
+        case WL_SHM_FORMAT_ARGB8888:
+        case WL_SHM_FORMAT_XRGB8888: swapRB = true; [[fallthrough]];
+        case WL_SHM_FORMAT_ABGR8888:
+        case WL_SHM_FORMAT_XBGR8888:
+            glIFormat = GL_RGBA8;
+            glFormat  = GL_RGBA;
+            glType    = GL_UNSIGNED_BYTE;
+            break;
+        // GL_UNSIGNED_INT_2_10_10_10_REV puts red in the low bits, same as (X|A)BGR2101010. Keeps all 10 bits.
+        case WL_SHM_FORMAT_ARGB2101010:
+        case WL_SHM_FORMAT_XRGB2101010: swapRB = true; [[fallthrough]];
+        case WL_SHM_FORMAT_ABGR2101010:
+        case WL_SHM_FORMAT_XBGR2101010:
+            glIFormat = GL_RGB10_A2;
+            glFormat  = GL_RGBA;
+            glType    = GL_UNSIGNED_INT_2_10_10_10_REV;
+            break;
+        // Same channel order as the cpu conversion, which copies the first three bytes of each pixel.
+        case WL_SHM_FORMAT_BGR888:
+        case WL_SHM_FORMAT_RGB888:
+            glIFormat  = GL_RGB8;
+            glFormat   = GL_RGB;
+            glType     = GL_UNSIGNED_BYTE;
+            bytesPerPx = 3;
+            break;
+        default: return false;
+    }
+
+    if (m_stride % bytesPerPx != 0 || m_stride < m_w * bytesPerPx)
+        return false;
+
+    // Clear stale errors, so that a failed upload can be detected below.
+    while (glGetError() != GL_NO_ERROR) {
+        ;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, m_stride / bytesPerPx);
+    glTexImage2D(GL_TEXTURE_2D, 0, glIFormat, m_w, m_h, 0, glFormat, glType, m_shmData);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (glGetError() != GL_NO_ERROR) {
+        Log::logger->log(Log::WARN, "[sc] [shm] Direct upload of format {} failed, converting on the cpu", m_shmFmt);
+        return false;
+    }
+
+    if (swapRB) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+    }
+
+    return true;
 }
 
 bool CSCSHMFrame::onBufferReady(ASP<CTexture> texture) {
-    convertBuffer();
+    const auto START = std::chrono::steady_clock::now();
 
     texture->allocate();
     texture->m_vSize.x = m_w;
@@ -462,16 +395,25 @@ bool CSCSHMFrame::onBufferReady(ASP<CTexture> texture) {
 
     glBindTexture(GL_TEXTURE_2D, texture->m_iTexID);
 
-    void* buffer = m_convBuffer ? m_convBuffer : m_shmData;
-
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_w, m_h, 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
+
+    // The gpu handles the channel order via swizzles and packed formats. The cpu conversion is the fallback.
+    const bool DIRECT = uploadDirect();
+    if (!DIRECT) {
+        convertBuffer();
+
+        void* buffer = m_convBuffer ? m_convBuffer : m_shmData;
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_w, m_h, 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
+    }
+
     glBindTexture(GL_TEXTURE_2D, 0);
 
     Log::logger->log(Log::INFO, "[sc] [shm] Got screenshot with size {}", texture->m_vSize);
+    Log::logger->log(Log::TRACE, "[sc] [shm] Format {} to texture {} took {:.2f}ms", m_shmFmt, DIRECT ? "directly" : "via cpu conversion",
+                     std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - START).count() / 1000.F);
 
     return true;
 }
@@ -3,8 +3,8 @@
 #include "../defines.hpp"
 #include "../core/Output.hpp"
 #include "../renderer/Texture.hpp"
+#include "ScreencopyBufferPool.hpp"
 #include <cstdint>
-#include <gbm.h>
 #include "linux-dmabuf-v1.hpp"
 #include "wlr-screencopy-unstable-v1.hpp"
 
@@ -30,6 +30,7 @@ class CScreencopyFrame {
 
     size_t                      m_resourceID;
     ASP<CTexture>               m_asset;
+    WP<COutput>                 m_output;
 
     bool                        m_ready = false;
 
@@ -40,6 +41,7 @@ class CScreencopyFrame {
 };
 
 // Uses a gpu buffer created via gbm_bo
+// The buffer comes from g_pSCBufferPool. Its contents are copied into a texture on import, so the buffer can be reused right after.
 class CSCDMAFrame : public ISCFrame {
   public:
     CSCDMAFrame(SP<CCZwlrScreencopyFrameV1> sc);
@@ -49,20 +51,16 @@ class CSCDMAFrame : public ISCFrame {
     virtual bool onBufferDone();
 
   private:
-    gbm_bo*                     m_bo = nullptr;
-
-    int                         m_planes = 0;
-    uint64_t                    m_mod    = 0;
-
-    int                         m_fd[4];
-    uint32_t                    m_stride[4], m_offset[4];
+    bool                        createImage();
 
     int                         m_w = 0, m_h = 0;
     uint32_t                    m_fmt = 0;
 
     SP<CCZwlrScreencopyFrameV1> m_sc = nullptr;
 
-    EGLImage                    m_image = nullptr;
+    SP<CSCBuffer>               m_buffer = nullptr;
+    // Set if the texture had to keep sampling the buffer, which then can't go back to the pool.
+    bool                        m_discardBuffer = false;
 };
 
 // Uses a shm buffer - is slow and needs ugly format conversion
@@ -79,6 +77,9 @@ class CSCSHMFrame : public ISCFrame {
     void         convertBuffer();
 
   private:
+    // Uploads the buffer without converting it first. Returns false if the format or stride isn't supported that way.
+    bool                        uploadDirect();
+
     bool                        m_ok = true;
 
     uint32_t                    m_w = 0, m_h = 0;
@@ -86,7 +87,8 @@ class CSCSHMFrame : public ISCFrame {
 
     SP<CCZwlrScreencopyFrameV1> m_sc = nullptr;
 
+    SP<CSCBuffer>               m_buffer     = nullptr;
     uint32_t                    m_shmFmt     = 0;
-    void*                       m_shmData    = nullptr;
-    void*                       m_convBuffer = nullptr;
+    void*                       m_shmData    = nullptr; // owned by m_buffer
+    void*                       m_convBuffer = nullptr; // owned by m_buffer
 };
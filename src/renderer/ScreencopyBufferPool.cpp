@@ -0,0 +1,290 @@
+#include "ScreencopyBufferPool.hpp"
+
+#include "../helpers/Log.hpp"
+#include "../helpers/MiscFunctions.hpp"
+#include "../core/hyprlock.hpp"
+#include "../core/Egl.hpp"
+#include "linux-dmabuf-v1.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static PFNEGLQUERYDMABUFMODIFIERSEXTPROC eglQueryDmaBufModifiersEXT = nullptr;
+
+// Buffers unused for this long are destroyed.
+static const auto SCBUFFERIDLETIMEOUT = std::chrono::seconds(5);
+
+CSCBuffer::~CSCBuffer() {
+    m_wlBuffer.reset();
+
+    if (m_image != EGL_NO_IMAGE && g_pEGL)
+        eglDestroyImage(g_pEGL->eglDisplay, m_image);
+
+    for (int plane = 0; plane < m_planes; plane++) {
+        if (m_fd[plane] >= 0)
+            close(m_fd[plane]);
+    }
+
+    if (m_bo)
+        gbm_bo_destroy(m_bo);
+
+    if (m_convBuffer)
+        free(m_convBuffer);
+
+    if (m_shmData)
+        munmap(m_shmData, m_shmSize);
+}
+
+size_t CSCBuffer::bytes() const {
+    if (m_type == SC_BUFFER_SHM)
+        return m_shmSize + (m_convBuffer ? (size_t)m_w * m_h * 4 : 0);
+
+    size_t total = 0;
+    for (int plane = 0; plane < m_planes; plane++) {
+        total += (size_t)m_stride[plane] * m_h;
+    }
+
+    return total;
+}
+
+CSCBufferPool::~CSCBufferPool() {
+    if (m_trimTimer)
+        m_trimTimer->cancel();
+
+    logOccupancy("shutdown");
+}
+
+SP<CSCBuffer> CSCBufferPool::findIdle(eSCBufferType type, uint32_t fmt, uint32_t w, uint32_t h, uint32_t stride) {
+    const auto IT = std::ranges::find_if(m_buffers, [&](const auto& b) {
+        // The modifier of a dma buffer is picked by gbm from the modifiers EGL supports for the format, so it follows from the format.
+        return !b->m_inUse && b->m_type == type && b->m_fmt == fmt && b->m_w == w && b->m_h == h && (type != SC_BUFFER_SHM || b->m_shmStride == stride);
+    });
+
+    return IT == m_buffers.end() ? nullptr : *IT;
+}
+
+SP<CSCBuffer> CSCBufferPool::acquireDMA(uint32_t fmt, uint32_t w, uint32_t h) {
+    auto buffer = findIdle(SC_BUFFER_DMA, fmt, w, h, 0);
+    if (buffer)
+        m_reused++;
+    else {
+        buffer = createDMA(fmt, w, h);
+        if (!buffer)
+            return nullptr;
+
+        m_created++;
+        m_buffers.emplace_back(buffer);
+    }
+
+    buffer->m_inUse = true;
+    logOccupancy("acquire");
+    return buffer;
+}
+
+SP<CSCBuffer> CSCBufferPool::acquireSHM(uint32_t fmt, uint32_t w, uint32_t h, uint32_t stride) {
+    auto buffer = findIdle(SC_BUFFER_SHM, fmt, w, h, stride);
+    if (buffer)
+        m_reused++;
+    else {
+        buffer = createSHM(fmt, w, h, stride);
+        if (!buffer)
+            return nullptr;
+
+        m_created++;
+        m_buffers.emplace_back(buffer);
+    }
+
+    buffer->m_inUse = true;
+    logOccupancy("acquire");
+    return buffer;
+}
+
+void CSCBufferPool::release(const SP<CSCBuffer>& buffer, bool discard) {
+    if (!buffer)
+        return;
+
+    buffer->m_inUse   = false;
+    buffer->m_lastUse = std::chrono::steady_clock::now();
+
+    if (discard)
+        std::erase(m_buffers, buffer);
+
+    logOccupancy(discard ? "discard" : "release");
+
+    scheduleTrim();
+}
+
+void CSCBufferPool::scheduleTrim() {
+    if (m_trimTimer || !g_pHyprlock)
+        return;
+
+    m_trimTimer = g_pHyprlock->addTimer(
+        SCBUFFERIDLETIMEOUT,
+        [](auto, auto) {
+            if (!g_pSCBufferPool)
+                return;
+
+            g_pSCBufferPool->m_trimTimer.reset();
+            g_pSCBufferPool->trim();
+        },
+        nullptr);
+}
+
+void CSCBufferPool::trim() {
+    const auto NOW     = std::chrono::steady_clock::now();
+    const auto REMOVED = std::erase_if(m_buffers, [&](const auto& b) { return !b->m_inUse && NOW - b->m_lastUse >= SCBUFFERIDLETIMEOUT; });
+
+    if (REMOVED > 0)
+        logOccupancy("trim");
+
+    // Check again later for buffers that were released in the meantime.
+    if (std::ranges::any_of(m_buffers, [](const auto& b) { return !b->m_inUse; }))
+        scheduleTrim();
+}
+
+void CSCBufferPool::logOccupancy(const char* reason) {
+    size_t inUse = 0, idle = 0, inUseBytes = 0, idleBytes = 0;
+    for (const auto& b : m_buffers) {
+        if (b->m_inUse) {
+            inUse++;
+            inUseBytes += b->bytes();
+        } else {
+            idle++;
+            idleBytes += b->bytes();
+        }
+    }
+
+    Log::logger->log(Log::TRACE, "[sc] [pool] {}: {} in use ({:.1f} MiB), {} idle ({:.1f} MiB), {} created, {} reused", reason, inUse, inUseBytes / (1024.F * 1024.F), idle,
+                     idleBytes / (1024.F * 1024.F), m_created, m_reused);
+}
+
+SP<CSCBuffer> CSCBufferPool::createDMA(uint32_t fmt, uint32_t w, uint32_t h) {
+    if (!g_pHyprlock->dma.linuxDmabuf || !g_pHyprlock->dma.gbmDevice)
+        return nullptr;
+
+    if (!eglQueryDmaBufModifiersEXT)
+        eglQueryDmaBufModifiersEXT = (PFNEGLQUERYDMABUFMODIFIERSEXTPROC)eglGetProcAddress("eglQueryDmaBufModifiersEXT");
+
+    auto     buffer = makeShared<CSCBuffer>();
+    buffer->m_type  = SC_BUFFER_DMA;
+    buffer->m_fmt   = fmt;
+    buffer->m_w     = w;
+    buffer->m_h     = h;
+
+    uint32_t flags = GBM_BO_USE_RENDERING;
+
+    if (!eglQueryDmaBufModifiersEXT) {
+        Log::logger->log(Log::WARN, "Querying modifiers without eglQueryDmaBufModifiersEXT support");
+        buffer->m_bo = gbm_bo_create(g_pHyprlock->dma.gbmDevice, w, h, fmt, flags);
+    } else {
+        std::array<uint64_t, 64>   mods;
+        std::array<EGLBoolean, 64> externalOnly;
+        int                        num = 0;
+        if (!eglQueryDmaBufModifiersEXT(g_pEGL->eglDisplay, fmt, 64, mods.data(), externalOnly.data(), &num) || num == 0) {
+            Log::logger->log(Log::WARN, "eglQueryDmaBufModifiersEXT failed, falling back to regular bo");
+            buffer->m_bo = gbm_bo_create(g_pHyprlock->dma.gbmDevice, w, h, fmt, flags);
+        } else {
+            Log::logger->log(Log::INFO, "eglQueryDmaBufModifiersEXT found {} mods", num);
+            std::vector<uint64_t> goodMods;
+            for (int i = 0; i < num; ++i) {
+                if (externalOnly[i]) {
+                    Log::logger->log(Log::TRACE, "Modifier {:x} failed test", mods[i]);
+                    continue;
+                }
+
+                Log::logger->log(Log::TRACE, "Modifier {:x} passed test", mods[i]);
+                goodMods.emplace_back(mods[i]);
+            }
+
+            buffer->m_bo = gbm_bo_create_with_modifiers2(g_pHyprlock->dma.gbmDevice, w, h, fmt, goodMods.data(), goodMods.size(), flags);
+        }
+    }
+
+    if (!buffer->m_bo) {
+        Log::logger->log(Log::ERR, "[bo] Couldn't create a drm buffer");
+        return nullptr;
+    }
+
+    buffer->m_planes = gbm_bo_get_plane_count(buffer->m_bo);
+    Log::logger->log(Log::INFO, "[bo] has {} plane(s)", buffer->m_planes);
+
+    buffer->m_mod = gbm_bo_get_modifier(buffer->m_bo);
+    Log::logger->log(Log::INFO, "[bo] chose modifier {:x}", buffer->m_mod);
+
+    auto params = makeShared<CCZwpLinuxBufferParamsV1>(g_pHyprlock->dma.linuxDmabuf->sendCreateParams());
+    if (!params) {
+        Log::logger->log(Log::ERR, "zwp_linux_dmabuf_v1_create_params failed");
+        return nullptr;
+    }
+
+    // Partially set up buffers are cleaned up by the destructor.
+    for (size_t plane = 0; plane < (size_t)buffer->m_planes; plane++) {
+        buffer->m_stride[plane] = gbm_bo_get_stride_for_plane(buffer->m_bo, plane);
+        buffer->m_offset[plane] = gbm_bo_get_offset(buffer->m_bo, plane);
+        buffer->m_fd[plane]     = gbm_bo_get_fd_for_plane(buffer->m_bo, plane);
+
+        if (buffer->m_fd[plane] < 0) {
+            Log::logger->log(Log::ERR, "gbm_m_bo_get_fd_for_plane failed");
+            return nullptr;
+        }
+
+        params->sendAdd(buffer->m_fd[plane], plane, buffer->m_offset[plane], buffer->m_stride[plane], buffer->m_mod >> 32, buffer->m_mod & 0xffffffff);
+    }
+
+    buffer->m_wlBuffer = makeShared<CCWlBuffer>(params->sendCreateImmed(w, h, fmt, (zwpLinuxBufferParamsV1Flags)0));
+    params.reset();
+
+    if (!buffer->m_wlBuffer) {
+        Log::logger->log(Log::ERR, "[pw] zwp_linux_buffer_params_v1_create_immed failed");
+        return nullptr;
+    }
+
+    return buffer;
+}
+
+SP<CSCBuffer> CSCBufferPool::createSHM(uint32_t fmt, uint32_t w, uint32_t h, uint32_t stride) {
+    if (!g_pHyprlock->getShm()) {
+        Log::logger->log(Log::ERR, "[sc] [shm] Failed to get WLShm global");
+        return nullptr;
+    }
+
+    auto buffer         = makeShared<CSCBuffer>();
+    buffer->m_type      = SC_BUFFER_SHM;
+    buffer->m_fmt       = fmt;
+    buffer->m_w         = w;
+    buffer->m_h         = h;
+    buffer->m_shmStride = stride;
+
+    const size_t SIZE = (size_t)stride * h;
+
+    // Create a shm pool with format and size
+    std::string shmPoolFile;
+    const auto  FD = createPoolFile(SIZE, shmPoolFile);
+
+    if (FD < 0) {
+        Log::logger->log(Log::ERR, "[sc] [shm] failed to create a pool file");
+        return nullptr;
+    }
+
+    void* data = mmap(nullptr, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, FD, 0);
+    if (data == MAP_FAILED) {
+        Log::logger->log(Log::ERR, "[sc] [shm] failed to mmap the pool file ({})", strerror(errno));
+        close(FD);
+        return nullptr;
+    }
+
+    buffer->m_shmData = data;
+    buffer->m_shmSize = SIZE;
+
+    auto pShmPool      = makeShared<CCWlShmPool>(g_pHyprlock->getShm()->sendCreatePool(FD, SIZE));
+    buffer->m_wlBuffer = makeShared<CCWlBuffer>(pShmPool->sendCreateBuffer(0, w, h, stride, fmt));
+
+    pShmPool.reset();
+
+    close(FD);
+
+    return buffer;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "../core/Timer.hpp"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <chrono>
+#include <cstdint>
+#include <gbm.h>
+#include <vector>
+#include "wayland.hpp"
+
+enum eSCBufferType : uint8_t {
+    SC_BUFFER_DMA = 0,
+    SC_BUFFER_SHM,
+};
+
+// A wl_buffer a screencopy frame can be copied into, together with the memory backing it.
+class CSCBuffer {
+  public:
+    CSCBuffer() = default;
+    ~CSCBuffer();
+
+    size_t                                bytes() const;
+
+    eSCBufferType                         m_type = SC_BUFFER_DMA;
+    uint32_t                              m_fmt  = 0; // drm fourcc for dma, wl_shm format for shm
+    uint32_t                              m_w = 0, m_h = 0;
+    uint64_t                              m_mod = 0;
+
+    SP<CCWlBuffer>                        m_wlBuffer;
+
+    // dma
+    gbm_bo*                               m_bo        = nullptr;
+    int                                   m_planes    = 0;
+    int                                   m_fd[4]     = {-1, -1, -1, -1};
+    uint32_t                              m_stride[4] = {}, m_offset[4] = {};
+    // Created on the first import and reused for every capture into this buffer.
+    EGLImage                              m_image = EGL_NO_IMAGE;
+
+    // shm
+    void*                                 m_shmData    = nullptr;
+    size_t                                m_shmSize    = 0;
+    uint32_t                              m_shmStride  = 0;
+    void*                                 m_convBuffer = nullptr; // for 24 bit formats
+
+    bool                                  m_inUse = false;
+    std::chrono::steady_clock::time_point m_lastUse;
+};
+
+// Buffers for screencopy frames, keyed by type, format, size and modifier (dma) or stride (shm).
+// Frames acquire a buffer when the compositor announced the frame parameters and release it once the frame was imported into a texture.
+// Released buffers are reused by later captures of the same parameters. Buffers that stay unused for a few seconds are destroyed.
+class CSCBufferPool {
+  public:
+    CSCBufferPool() = default;
+    ~CSCBufferPool();
+
+    // Returns nullptr if no buffer could be created.
+    SP<CSCBuffer> acquireDMA(uint32_t fmt, uint32_t w, uint32_t h);
+    SP<CSCBuffer> acquireSHM(uint32_t fmt, uint32_t w, uint32_t h, uint32_t stride);
+    // Hands the buffer back to the pool. If discard is set, it is destroyed instead of kept for reuse.
+    void          release(const SP<CSCBuffer>& buffer, bool discard = false);
+
+    void          logOccupancy(const char* reason);
+
+  private:
+    SP<CSCBuffer>              findIdle(eSCBufferType type, uint32_t fmt, uint32_t w, uint32_t h, uint32_t stride);
+    SP<CSCBuffer>              createDMA(uint32_t fmt, uint32_t w, uint32_t h);
+    SP<CSCBuffer>              createSHM(uint32_t fmt, uint32_t w, uint32_t h, uint32_t stride);
+    // Destroys buffers that were not used for a while.
+    void                       trim();
+    void                       scheduleTrim();
+
+    std::vector<SP<CSCBuffer>> m_buffers;
+    ASP<CTimer>                m_trimTimer;
+
+    size_t                     m_created = 0;
+    size_t                     m_reused  = 0;
+};
+
+inline UP<CSCBufferPool> g_pSCBufferPool;
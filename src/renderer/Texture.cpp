@@ -14,6 +14,11 @@ void CTexture::destroyTexture() {
         m_iTexID = 0;
     }
     m_bAllocated = false;
+
+    if (m_renderTargetBytes) {
+        g_renderTargetStats.remove(m_renderTargetBytes);
+        m_renderTargetBytes = 0;
+    }
 }
 
 void CTexture::allocate() {
@@ -21,3 +26,17 @@ void CTexture::allocate() {
         glGenTextures(1, &m_iTexID);
     m_bAllocated = true;
 }
+
+void SRenderTargetStats::add(size_t b) {
+    count++;
+    const size_t NOW  = bytes += b;
+    size_t       peak = peakBytes.load();
+    while (NOW > peak && !peakBytes.compare_exchange_weak(peak, NOW)) {
+        ;
+    }
+}
+
+void SRenderTargetStats::remove(size_t b) {
+    count--;
+    bytes -= b;
+}
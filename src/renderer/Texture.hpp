@@ -1,6 +1,8 @@
 #pragma once
 
 #include <GLES3/gl32.h>
+#include <atomic>
+#include <cstddef>
 #include "../helpers/Math.hpp"
 
 enum TEXTURETYPE {
@@ -23,4 +25,20 @@ class CTexture {
     bool        m_bAllocated = false;
     GLuint      m_iTexID     = 0;
     Vector2D    m_vSize;
-};
\ No newline at end of file
+
+    // Set for framebuffer textures, see g_renderTargetStats. Subtracted again when the texture is destroyed.
+    size_t      m_renderTargetBytes = 0;
+};
+
+// Memory of framebuffers and of the textures released from them (blurred backgrounds, shadows, shapes).
+// Updated from the gl worker as well.
+struct SRenderTargetStats {
+    std::atomic<size_t> bytes     = 0;
+    std::atomic<size_t> count     = 0;
+    std::atomic<size_t> peakBytes = 0;
+
+    void                add(size_t b);
+    void                remove(size_t b);
+};
+
+inline SRenderTargetStats g_renderTargetStats;
\ No newline at end of file
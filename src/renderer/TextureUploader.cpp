@@ -0,0 +1,226 @@
+#include "TextureUploader.hpp"
+
+#include "../helpers/Log.hpp"
+#include "GLWorker.hpp"
+
+#include <cairo/cairo.h>
+#include <cstring>
+
+using namespace Hyprgraphics;
+
+// Below this size the copy into the pixel buffer costs more than it saves. This is the case for most labels.
+static const size_t STAGINGMINBYTES = 256 * 1024;
+
+static float        msBetween(const std::chrono::steady_clock::time_point& a, const std::chrono::steady_clock::time_point& b) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(b - a).count() / 1000.F;
+}
+
+// Allocates the texture for a resource and leaves it bound.
+static ASP<CTexture> createTexture(ResourceID id, const ASP<IAsyncResource>& resource, GLint& glIFormat, GLint& glFormat, GLint& glType) {
+    const auto           texture = makeAtomicShared<CTexture>();
+
+    const cairo_status_t SURFACESTATUS = (cairo_status_t)resource->m_asset.cairoSurface->status();
+    const auto           CAIROFORMAT   = cairo_image_surface_get_format(resource->m_asset.cairoSurface->cairo());
+    glIFormat                          = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_RGB32F : GL_RGBA;
+    glFormat                           = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_RGB : GL_RGBA;
+    glType                             = CAIROFORMAT == CAIRO_FORMAT_RGB96F ? GL_FLOAT : GL_UNSIGNED_BYTE;
+
+    if (SURFACESTATUS != CAIRO_STATUS_SUCCESS) {
+        Log::logger->log(Log::ERR, "resourceID: {} invalid ({})", id, cairo_status_to_string(SURFACESTATUS));
+        texture->m_iType = TEXTURE_INVALID;
+    }
+
+    texture->m_vSize = resource->m_asset.pixelSize;
+    texture->allocate();
+
+    glBindTexture(GL_TEXTURE_2D, texture->m_iTexID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    if (CAIROFORMAT != CAIRO_FORMAT_RGB96F) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+    }
+
+    return texture;
+}
+
+CTextureUploader::CTextureUploader(std::function<void(ResourceID)> onStaged) : m_onStaged(std::move(onStaged)) {
+    m_thread = std::thread([this]() { copyThread(); });
+}
+
+CTextureUploader::~CTextureUploader() {
+    {
+        std::lock_guard<std::mutex> lg(m_jobsMutex);
+        m_exit = true;
+    }
+    m_jobsCV.notify_all();
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    for (auto& [id, upload] : m_inFlight) {
+        glDeleteSync(upload.fence);
+    }
+}
+
+void CTextureUploader::copyThread() {
+    while (true) {
+        std::unique_lock<std::mutex> lk(m_jobsMutex);
+        m_jobsCV.wait(lk, [this] { return m_exit || !m_jobs.empty(); });
+
+        if (m_exit)
+            return;
+
+        const auto JOBS = std::move(m_jobs);
+        m_jobs.clear();
+        lk.unlock();
+
+        for (const auto& job : JOBS) {
+            std::memcpy(job.dst, job.src, job.bytes);
+            m_onStaged(job.id);
+        }
+    }
+}
+
+bool CTextureUploader::stage(ResourceID id, const ASP<IAsyncResource>& resource) {
+    const auto& SURFACE = resource->m_asset.cairoSurface;
+    if (SURFACE->status() != CAIRO_STATUS_SUCCESS || m_staging.contains(id))
+        return false;
+
+    const size_t BYTES = (size_t)cairo_image_surface_get_stride(SURFACE->cairo()) * cairo_image_surface_get_height(SURFACE->cairo());
+
+    if (BYTES < STAGINGMINBYTES)
+        return false;
+
+    if (g_pGLWorker && g_pGLWorker->isAvailable()) {
+        // The worker context can upload straight from the cairo surface.
+        m_staging.emplace(id, SStagedUpload{.resource = resource, .bytes = BYTES, .start = std::chrono::steady_clock::now()});
+
+        g_pGLWorker->submit(
+            [id, resource](const auto&) {
+                GLint      glIFormat = 0, glFormat = 0, glType = 0;
+                const auto texture = createTexture(id, resource, glIFormat, glFormat, glType);
+
+                glTexImage2D(GL_TEXTURE_2D, 0, glIFormat, texture->m_vSize.x, texture->m_vSize.y, 0, glFormat, glType, resource->m_asset.cairoSurface->data());
+                glBindTexture(GL_TEXTURE_2D, 0);
+
+                return texture;
+            },
+            [this, id](ASP<CTexture> texture) {
+                if (!m_staging.contains(id))
+                    return;
+
+                m_staging[id].texture = texture;
+                m_onStaged(id);
+            });
+
+        return true;
+    }
+
+    SStagedUpload upload{.resource = resource, .bytes = BYTES, .start = std::chrono::steady_clock::now()};
+
+    glGenBuffers(1, &upload.pbo);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload.pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, BYTES, nullptr, GL_STREAM_DRAW);
+    upload.mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, BYTES, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (!upload.mapped) {
+        Log::logger->log(Log::WARN, "Failed to map a {} byte pixel buffer for resourceID: {}, uploading directly", BYTES, id);
+        glDeleteBuffers(1, &upload.pbo);
+        return false;
+    }
+
+    m_staging.emplace(id, upload);
+
+    {
+        std::lock_guard<std::mutex> lg(m_jobsMutex);
+        m_jobs.emplace_back(SCopyJob{.id = id, .dst = upload.mapped, .src = (const uint8_t*)SURFACE->data(), .bytes = BYTES});
+    }
+    m_jobsCV.notify_one();
+
+    return true;
+}
+
+bool CTextureUploader::isStaging(ResourceID id) {
+    return m_staging.contains(id);
+}
+
+ASP<CTexture> CTextureUploader::finish(ResourceID id) {
+    if (!m_staging.contains(id)) {
+        Log::logger->log(Log::ERR, "No staged upload for resourceID: {}! This is a bug.", id);
+        return nullptr;
+    }
+
+    pollFences();
+
+    auto upload = m_staging[id];
+    m_staging.erase(id);
+
+    if (upload.texture) {
+        Log::logger->log(Log::TRACE, "[upload] resourceID: {} {} KiB via gl worker, total {:.2f}ms", id, upload.bytes / 1024,
+                         msBetween(upload.start, std::chrono::steady_clock::now()));
+        return upload.texture;
+    }
+
+    GLint      glIFormat = 0, glFormat = 0, glType = 0;
+    const auto texture = createTexture(id, upload.resource, glIFormat, glFormat, glType);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload.pbo);
+    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE)
+        Log::logger->log(Log::WARN, "Pixel buffer for resourceID: {} got corrupted while mapped", id);
+
+    // Sources from the bound pixel buffer, so this returns without touching the pixels.
+    glTexImage2D(GL_TEXTURE_2D, 0, glIFormat, texture->m_vSize.x, texture->m_vSize.y, 0, glFormat, glType, nullptr);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    // GL keeps the storage alive until the upload sourcing from it is done.
+    glDeleteBuffers(1, &upload.pbo);
+
+    upload.submitted = std::chrono::steady_clock::now();
+    upload.resource.reset();
+
+    // The fence is only there to trace the gpu time.
+    if (Log::logger->verbose()) {
+        upload.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_inFlight.emplace_back(id, upload);
+    }
+
+    return texture;
+}
+
+ASP<CTexture> CTextureUploader::uploadSync(ResourceID id, const ASP<IAsyncResource>& resource) {
+    pollFences();
+
+    const auto START = std::chrono::steady_clock::now();
+
+    GLint      glIFormat = 0, glFormat = 0, glType = 0;
+    const auto texture = createTexture(id, resource, glIFormat, glFormat, glType);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, glIFormat, texture->m_vSize.x, texture->m_vSize.y, 0, glFormat, glType, resource->m_asset.cairoSurface->data());
+
+    Log::logger->log(Log::TRACE, "[upload] resourceID: {} {}x{} direct, {:.2f}ms", id, texture->m_vSize.x, texture->m_vSize.y,
+                     msBetween(START, std::chrono::steady_clock::now()));
+
+    return texture;
+}
+
+void CTextureUploader::pollFences() {
+    if (m_inFlight.empty())
+        return;
+
+    const auto NOW = std::chrono::steady_clock::now();
+
+    std::erase_if(m_inFlight, [&NOW](auto& pair) {
+        auto& [id, upload] = pair;
+
+        if (glClientWaitSync(upload.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED)
+            return false;
+
+        // Checked on the next upload, so the gpu time is an upper bound.
+        Log::logger->log(Log::TRACE, "[upload] resourceID: {} {} KiB via pixel buffer, staged {:.2f}ms, gpu <= {:.2f}ms", id, upload.bytes / 1024,
+                         msBetween(upload.start, upload.submitted), msBetween(upload.submitted, NOW));
+
+        glDeleteSync(upload.fence);
+        return true;
+    });
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../defines.hpp"
+#include "Texture.hpp"
+#include <hyprgraphics/resource/resources/AsyncResource.hpp>
+#include <GLES3/gl32.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Creates GL textures from finished async resources.
+// Small surfaces (text) are uploaded directly, handing them to another thread costs more than the upload.
+// Large surfaces are uploaded by the GL worker if it is available.
+// Otherwise they are streamed through a pixel buffer object: the main thread maps the buffer,
+// a copy thread fills the mapping and the main thread then only issues glTexImage2D from the buffer.
+class CTextureUploader {
+  public:
+    // onStaged is called from any thread when the upload for id can be finished.
+    // The owner is expected to call finish(id) on the main thread afterwards.
+    CTextureUploader(std::function<void(ResourceID)> onStaged);
+    ~CTextureUploader();
+
+    // Returns false if the resource should be uploaded via uploadSync instead.
+    bool          stage(ResourceID id, const ASP<Hyprgraphics::IAsyncResource>& resource);
+    ASP<CTexture> finish(ResourceID id);
+    ASP<CTexture> uploadSync(ResourceID id, const ASP<Hyprgraphics::IAsyncResource>& resource);
+
+    bool          isStaging(ResourceID id);
+
+  private:
+    struct SStagedUpload {
+        ASP<Hyprgraphics::IAsyncResource>     resource;
+        ASP<CTexture>                         texture; // set if uploaded by the gl worker
+        GLuint                                pbo    = 0;
+        void*                                 mapped = nullptr;
+        size_t                                bytes  = 0;
+        GLsync                                fence  = nullptr;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point submitted;
+    };
+
+    struct SCopyJob {
+        ResourceID     id    = 0;
+        void*          dst   = nullptr;
+        const uint8_t* src   = nullptr;
+        size_t         bytes = 0;
+    };
+
+    void                                          pollFences();
+    void                                          copyThread();
+
+    std::function<void(ResourceID)>               m_onStaged;
+
+    // not shared between threads
+    std::unordered_map<ResourceID, SStagedUpload> m_staging;
+    std::vector<std::pair<ResourceID, SStagedUpload>> m_inFlight; // submitted with a fence for the trace log, checked on the next upload
+
+    // shared between threads
+    std::mutex                                    m_jobsMutex;
+    std::condition_variable                       m_jobsCV;
+    std::vector<SCopyJob>                         m_jobs;
+    bool                                          m_exit = false;
+
+    std::thread                                   m_thread;
+};
@@ -0,0 +1,90 @@
+#include "ScaledImageResource.hpp"
+
+#include "../../helpers/Log.hpp"
+#include "../ImageCache.hpp"
+#include <hyprgraphics/image/Image.hpp>
+#include <cairo/cairo.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace Hyprgraphics;
+
+CScaledImageResource::CScaledImageResource(const std::string& path, const Hyprutils::Math::Vector2D& targetSize, eImageFit fit) :
+    m_path(path), m_targetSize(targetSize), m_fit(fit) {
+    ;
+}
+
+void CScaledImageResource::render() {
+    const auto CACHEKEY = g_pImageCache ? g_pImageCache->keyFor(m_path, m_targetSize, m_fit) : std::string{};
+
+    if (!CACHEKEY.empty()) {
+        if (const auto CACHED = g_pImageCache->load(CACHEKEY); CACHED) {
+            m_asset.cairoSurface = CACHED;
+            m_asset.pixelSize    = CACHED->size();
+            return;
+        }
+    }
+
+    if (decode() && !CACHEKEY.empty())
+        g_pImageCache->store(CACHEKEY, m_asset.cairoSurface->cairo());
+}
+
+bool CScaledImageResource::decode() {
+    CImage     image(m_path);
+
+    const auto SURFACE = image.cairoSurface();
+
+    m_asset.cairoSurface = SURFACE;
+    m_asset.pixelSize    = SURFACE && SURFACE->cairo() ? SURFACE->size() : Hyprutils::Math::Vector2D{};
+
+    if (!image.success()) {
+        Log::logger->log(Log::ERR, "Failed to load image {}: {}", m_path, image.getError());
+        return false;
+    }
+
+    if (!SURFACE || SURFACE->status() != CAIRO_STATUS_SUCCESS)
+        return false;
+
+    if (m_targetSize.x <= 0 || m_targetSize.y <= 0)
+        return true;
+
+    // Only 8-bit surfaces are downscaled. Float surfaces (e.g. HDR) are uploaded as is.
+    const auto FORMAT = cairo_image_surface_get_format(SURFACE->cairo());
+    if (FORMAT != CAIRO_FORMAT_ARGB32 && FORMAT != CAIRO_FORMAT_RGB24)
+        return true;
+
+    const auto   SIZE   = m_asset.pixelSize;
+    const double SCALEX = m_targetSize.x / SIZE.x;
+    const double SCALEY = m_targetSize.y / SIZE.y;
+    const double SCALE  = m_fit == IMAGE_FIT_COVER ? std::max(SCALEX, SCALEY) : std::min(SCALEX, SCALEY);
+
+    if (SCALE >= 1.0)
+        return true;
+
+    const int W = std::max(1, (int)std::round(SIZE.x * SCALE));
+    const int H = std::max(1, (int)std::round(SIZE.y * SCALE));
+
+    auto*     scaled = cairo_image_surface_create(FORMAT, W, H);
+    if (cairo_surface_status(scaled) != CAIRO_STATUS_SUCCESS) {
+        Log::logger->log(Log::ERR, "Failed to allocate a {}x{} surface for {}, keeping native size", W, H, m_path);
+        cairo_surface_destroy(scaled);
+        return true;
+    }
+
+    auto* cr = cairo_create(scaled);
+    cairo_scale(cr, W / SIZE.x, H / SIZE.y);
+    cairo_set_source_surface(cr, SURFACE->cairo(), 0, 0);
+    // CAIRO_FILTER_GOOD does a proper box filtered downscale instead of bilinear point sampling.
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+    cairo_surface_flush(scaled);
+
+    Log::logger->log(Log::TRACE, "Downscaled {} from {} to {}x{}", m_path, SIZE, W, H);
+
+    m_asset.cairoSurface = makeShared<CCairoSurface>(scaled);
+    m_asset.pixelSize    = {W, H};
+
+    return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <hyprgraphics/resource/resources/AsyncResource.hpp>
+#include <hyprutils/math/Vector2D.hpp>
+#include <cstdint>
+#include <string>
+
+enum eImageFit : uint8_t {
+    IMAGE_FIT_COVER   = 0, // both sides >= target (what background and image widgets render)
+    IMAGE_FIT_CONTAIN = 1, // both sides <= target
+};
+
+// Decodes an image and downscales it to the size it will be displayed at.
+// Images are never upscaled. An empty target size decodes at native resolution.
+// Results are kept in the on disk image cache (see CImageCache), a cache hit skips decoding.
+class CScaledImageResource : public Hyprgraphics::IAsyncResource {
+  public:
+    CScaledImageResource(const std::string& path, const Hyprutils::Math::Vector2D& targetSize, eImageFit fit);
+    virtual ~CScaledImageResource() = default;
+
+    virtual void render();
+
+  private:
+    // Returns false if the image could not be decoded.
+    bool                      decode();
+
+    std::string               m_path;
+    Hyprutils::Math::Vector2D m_targetSize;
+    eImageFit                 m_fit = IMAGE_FIT_COVER;
+};
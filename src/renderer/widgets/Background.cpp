@@ -2,20 +2,20 @@
 #include "../Renderer.hpp"
 #include "../AsyncResourceManager.hpp"
 #include "../Framebuffer.hpp"
+#include "../GLWorker.hpp"
 #include "../../core/hyprlock.hpp"
 #include "../../helpers/Log.hpp"
 #include "../../helpers/MiscFunctions.hpp"
 #include "../../core/AnimationManager.hpp"
 #include "../../config/ConfigManager.hpp"
 #include <chrono>
+#include <cmath>
 #include <hyprlang.hpp>
 #include <filesystem>
 #include <GLES3/gl32.h>
 
 CBackground::CBackground() {
-    blurredFB        = makeUnique<CFramebuffer>();
-    pendingBlurredFB = makeUnique<CFramebuffer>();
-    transformedScFB  = makeUnique<CFramebuffer>();
+    ;
 }
 
 CBackground::~CBackground() {
@@ -40,31 +40,29 @@ static std::string runAndGetPath(const std::string& reloadCommand) {
     return path;
 }
 
-void CBackground::configure(const std::unordered_map<std::string, std::any>& props, const SP<COutput>& pOutput) {
+void CBackground::configure(const SWidgetConfig& config, const SP<COutput>& pOutput) {
     reset();
 
-    try {
-        color             = std::any_cast<Hyprlang::INT>(props.at("color"));
-        blurPasses        = std::any_cast<Hyprlang::INT>(props.at("blur_passes"));
-        blurSize          = std::any_cast<Hyprlang::INT>(props.at("blur_size"));
-        vibrancy          = std::any_cast<Hyprlang::FLOAT>(props.at("vibrancy"));
-        vibrancy_darkness = std::any_cast<Hyprlang::FLOAT>(props.at("vibrancy_darkness"));
-        noise             = std::any_cast<Hyprlang::FLOAT>(props.at("noise"));
-        brightness        = std::any_cast<Hyprlang::FLOAT>(props.at("brightness"));
-        contrast          = std::any_cast<Hyprlang::FLOAT>(props.at("contrast"));
-        path              = std::any_cast<Hyprlang::STRING>(props.at("path"));
-        reloadCommand     = std::any_cast<Hyprlang::STRING>(props.at("reload_cmd"));
-        reloadTime        = std::any_cast<Hyprlang::INT>(props.at("reload_time"));
-
-    } catch (const std::bad_any_cast& e) {
-        RASSERT(false, "Failed to construct CBackground: {}", e.what()); //
-    } catch (const std::out_of_range& e) {
-        RASSERT(false, "Missing propperty for CBackground: {}", e.what()); //
-    }
+    const auto& CONFIG = std::get<SBackgroundConfig>(config.values);
+
+    color             = CONFIG.color;
+    blurPasses        = CONFIG.blurPasses;
+    blurSize          = CONFIG.blurSize;
+    vibrancy          = CONFIG.vibrancy;
+    vibrancy_darkness = CONFIG.vibrancyDarkness;
+    noise             = CONFIG.noise;
+    brightness        = CONFIG.brightness;
+    contrast          = CONFIG.contrast;
+    path              = CONFIG.path;
+    reloadCommand     = CONFIG.reloadCommand;
+    reloadTime        = CONFIG.reloadTime;
 
     isScreenshot = path == "screenshot";
 
+    // Images are requested at the mode size, like enqueueStaticAssets did before the lock surface existed.
+    // Under fractional scaling the surface can be a pixel off.
     viewport     = pOutput->getViewport();
+    imageSize    = pOutput->size;
     outputPort   = pOutput->stringPort;
     transform    = wlTransformToHyprutils(invertTransform(pOutput->transform));
     scResourceID = CAsyncResourceManager::resourceIDForScreencopy(pOutput->stringPort);
@@ -86,8 +84,10 @@ void CBackground::configure(const std::unordered_map<std::string, std::any>& pro
             Log::logger->log(Log::ERR, "No screencopy support! path=screenshot won't work. Falling back to background color.");
             resourceID = 0;
         }
-    } else if (!path.empty())
-        resourceID = g_asyncResourceManager->requestImage(path, m_imageRevision, nullptr);
+    } else if (!path.empty()) {
+        resourceHandle = g_asyncResourceManager->requestImage(path, m_imageRevision, nullptr, imageSize, IMAGE_FIT_COVER, RESOURCE_PRIORITY_BACKGROUND);
+        resourceID     = resourceHandle.id();
+    }
 
     if (!reloadCommand.empty() && reloadTime > -1) {
         try {
@@ -105,8 +105,28 @@ void CBackground::reset() {
         reloadTimer.reset();
     }
 
-    blurredFB->destroyBuffer();
-    pendingBlurredFB->destroyBuffer();
+    // Preprocessing for the previous configuration is dropped when it finishes.
+    m_configRevision++;
+
+    blurredTex.reset();
+    pendingBlurredTex.reset();
+    transformedScTex.reset();
+
+    if (g_pHyprlock->isTerminating())
+        return;
+
+    asset        = nullptr;
+    scAsset      = nullptr;
+    pendingAsset = nullptr;
+
+    resourceHandle.reset();
+    requestedHandle.reset();
+    pendingHandle.reset();
+
+    resourceID           = 0;
+    primaryPreprocessing = false;
+    scPreprocessing      = false;
+    pendingResource      = false;
 }
 
 void CBackground::updatePrimaryAsset() {
@@ -114,50 +134,85 @@ void CBackground::updatePrimaryAsset() {
         return;
 
     asset = g_asyncResourceManager->getAssetByID(resourceID);
-    if (!asset)
+    if (!asset || asset->m_iType == TEXTURE_INVALID)
         return;
 
-    const bool NEEDFB = (isScreenshot || blurPasses > 0 || asset->m_vSize != viewport || transform != HYPRUTILS_TRANSFORM_NORMAL) && (!blurredFB->isAllocated() || firstRender);
-    if (NEEDFB)
-        renderToFB(*asset, *blurredFB, blurPasses, isScreenshot);
-}
-
-void CBackground::updatePendingAsset() {
-    // For crossfading a new asset
-    if (!pendingAsset || blurPasses == 0 || pendingBlurredFB->isAllocated())
+    // Images are decoded at the mode size, a pixel off is drawn as is.
+    const bool SIZEMATCHES    = std::abs(asset->m_vSize.x - viewport.x) <= 1 && std::abs(asset->m_vSize.y - viewport.y) <= 1;
+    const bool NEEDPREPROCESS = isScreenshot || blurPasses > 0 || !SIZEMATCHES || transform != HYPRUTILS_TRANSFORM_NORMAL;
+    if (!NEEDPREPROCESS)
         return;
 
-    renderToFB(*pendingAsset, *pendingBlurredFB, blurPasses);
+    primaryPreprocessing = true;
+    preprocess(asset, blurPasses, isScreenshot, {}, [REF = m_self, REVISION = m_configRevision](ASP<CTexture> tex) {
+        if (const auto PSELF = REF.lock(); PSELF && PSELF->m_configRevision == REVISION) {
+            PSELF->blurredTex           = tex;
+            PSELF->primaryPreprocessing = false;
+        }
+    });
 }
 
 void CBackground::updateScAsset() {
-    if (scAsset || scResourceID == 0)
+    if (scResourceID == 0)
         return;
 
-    // path=screenshot -> scAsset = asset
-    scAsset = (asset && isScreenshot) ? asset : g_asyncResourceManager->getAssetByID(scResourceID);
-    if (!scAsset)
-        return;
+    Vector2D transformedSize;
+    if (!scAsset) {
+        // path=screenshot -> scAsset = asset
+        scAsset = (asset && isScreenshot) ? asset : g_asyncResourceManager->getAssetByID(scResourceID);
+        if (!scAsset)
+            return;
+    } else {
+        // Once the fade-in finished, the manager replaces the capture with a smaller copy for the fade-out.
+        // The full resolution capture is let go of after everything derived from it is done.
+        if (scPreprocessing || primaryPreprocessing)
+            return;
+
+        const auto SCALED = g_asyncResourceManager->getAssetByID(scResourceID);
+        if (!SCALED || SCALED.get() == scAsset.get())
+            return;
+
+        if (asset.get() == scAsset.get())
+            asset = SCALED; // only its blurred version is shown
+
+        scAsset = SCALED;
+
+        // The viewport size would undo the scaling.
+        transformedSize = transform % 2 == 1 ? Vector2D{scAsset->m_vSize.y, scAsset->m_vSize.x} : scAsset->m_vSize;
+    }
 
     const bool NEEDSCTRANSFORM = transform != HYPRUTILS_TRANSFORM_NORMAL;
-    if (NEEDSCTRANSFORM)
-        renderToFB(*scAsset, *transformedScFB, 0, true);
+    if (!NEEDSCTRANSFORM)
+        return;
+
+    // The previous transformedScTex is used until this is done.
+    scPreprocessing = true;
+    preprocess(scAsset, 0, true, transformedSize, [REF = m_self, REVISION = m_configRevision](ASP<CTexture> tex) {
+        if (const auto PSELF = REF.lock(); PSELF && PSELF->m_configRevision == REVISION) {
+            PSELF->transformedScTex = tex;
+            PSELF->scPreprocessing  = false;
+        }
+    });
 }
 
 const CTexture& CBackground::getPrimaryAssetTex() const {
     // This case is only for background:path=screenshot with blurPasses=0
-    if (isScreenshot && blurPasses == 0 && transformedScFB->isAllocated())
-        return transformedScFB->m_cTex;
+    if (isScreenshot && blurPasses == 0 && transformedScTex)
+        return *transformedScTex;
 
-    return (blurredFB->isAllocated()) ? blurredFB->m_cTex : *asset;
+    return blurredTex ? *blurredTex : *asset;
 }
 
 const CTexture& CBackground::getPendingAssetTex() const {
-    return (pendingBlurredFB->isAllocated()) ? pendingBlurredFB->m_cTex : *pendingAsset;
+    return pendingBlurredTex ? *pendingBlurredTex : *pendingAsset;
 }
 
 const CTexture& CBackground::getScAssetTex() const {
-    return (transformedScFB->isAllocated()) ? transformedScFB->m_cTex : *scAsset;
+    return transformedScTex ? *transformedScTex : *scAsset;
+}
+
+bool CBackground::scAssetReady() const {
+    return scAsset && (!scPreprocessing || transformedScTex);
 }
 
 void CBackground::renderRect(CHyprColor color) {
@@ -190,55 +245,80 @@ static CBox getScaledBoxForTextureSize(const Vector2D& size, const Vector2D& vie
     return texbox;
 }
 
-void CBackground::renderToFB(const CTexture& tex, CFramebuffer& fb, int passes, bool applyTransform) {
-    if (firstRender)
-        firstRender = false;
-
+// Renders tex to a new viewport sized texture. Runs on whichever thread has a context current.
+static ASP<CTexture> renderPreprocessed(const CRenderer::SShaders& shaders, const CTexture& tex, const Vector2D& viewport, eTransform transform, bool blur,
+                                        const CRenderer::SBlurParams& blurParams) {
     // make it brah
     Vector2D size = tex.m_vSize;
-    if (applyTransform && transform % 2 == 1) {
+    if (transform % 2 == 1) {
         size.x = tex.m_vSize.y;
         size.y = tex.m_vSize.x;
     }
 
-    const auto TEXBOX = getScaledBoxForTextureSize(size, viewport);
-
-    if (!fb.isAllocated())
-        fb.alloc(viewport.x, viewport.y); // TODO 10 bit
+    const auto   TEXBOX     = getScaledBoxForTextureSize(size, viewport);
+    const auto   PROJECTION = Mat3x3::outputProjection(viewport, HYPRUTILS_TRANSFORM_NORMAL);
 
+    CFramebuffer fb;
+    fb.alloc(viewport.x, viewport.y); // TODO 10 bit
     fb.bind();
 
-    g_pRenderer->renderTexture(TEXBOX, tex, 1.0, 0, applyTransform ? transform : HYPRUTILS_TRANSFORM_NORMAL);
-
-    if (blurPasses > 0)
-        g_pRenderer->blurFB(fb,
-                            CRenderer::SBlurParams{
-                                .size              = blurSize,
-                                .passes            = passes,
-                                .noise             = noise,
-                                .contrast          = contrast,
-                                .brightness        = brightness,
-                                .vibrancy          = vibrancy,
-                                .vibrancy_darkness = vibrancy_darkness,
-                            });
+    CRenderer::renderTextureWith(shaders, PROJECTION, TEXBOX, tex, 1.0, 0, transform);
+
+    if (blur)
+        CRenderer::blurFBWith(shaders, PROJECTION, fb, blurParams);
+
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+    return fb.releaseTexture();
+}
+
+void CBackground::preprocess(const ASP<CTexture>& tex, int passes, bool applyTransform, const Vector2D& size, std::function<void(ASP<CTexture>)> done) {
+    CRenderer::SBlurParams params{
+        .size              = blurSize,
+        .passes            = passes,
+        .noise             = noise,
+        .contrast          = contrast,
+        .brightness        = brightness,
+        .vibrancy          = vibrancy,
+        .vibrancy_darkness = vibrancy_darkness,
+    };
+
+    const auto VIEWPORT  = size.x > 0 && size.y > 0 ? size : viewport;
+    const auto TRANSFORM = applyTransform ? transform : HYPRUTILS_TRANSFORM_NORMAL;
+    // The color adjustments of the blur also apply to the transformed screenshot.
+    const bool BLUR = blurPasses > 0;
+
+    auto job = [tex, VIEWPORT, TRANSFORM, BLUR, params](const CRenderer::SShaders& shaders) {
+        return renderPreprocessed(shaders, *tex, VIEWPORT, TRANSFORM, BLUR, params);
+    };
+
+    if (g_pGLWorker && g_pGLWorker->isAvailable()) {
+        const auto PORT = outputPort;
+        g_pGLWorker->submit(std::move(job), [done = std::move(done), PORT](ASP<CTexture> result) {
+            done(result);
+            g_pHyprlock->renderOutput(PORT);
+        });
+        return;
+    }
+
+    done(job(g_pRenderer->getShaders()));
 }
 
 bool CBackground::draw(const SRenderData& data) {
     updatePrimaryAsset();
-    updatePendingAsset();
     updateScAsset();
 
     if (asset && asset->m_iType == TEXTURE_INVALID) {
-        g_asyncResourceManager->unload(asset);
+        resourceHandle.reset();
+        asset      = nullptr;
         resourceID = 0;
         renderRect(color);
         return false;
     }
 
-    if (!asset || resourceID == 0) {
+    if (!asset || resourceID == 0 || primaryPreprocessing) {
         // fade in/out with a solid color
-        if (data.opacity < 1.0 && scAsset) {
+        if (data.opacity < 1.0 && scAssetReady()) {
             const auto& SCTEX    = getScAssetTex();
             const auto  SCTEXBOX = getScaledBoxForTextureSize(SCTEX.m_vSize, viewport);
             g_pRenderer->renderTexture(SCTEXBOX, SCTEX, 1, 0, HYPRUTILS_TRANSFORM_FLIPPED_180);
@@ -249,12 +329,12 @@ bool CBackground::draw(const SRenderData& data) {
         }
 
         renderRect(color);
-        return !asset && resourceID > 0; // resource not ready
+        return (!asset || primaryPreprocessing) && resourceID > 0; // resource not ready
     }
 
     const auto& TEX    = getPrimaryAssetTex();
     const auto  TEXBOX = getScaledBoxForTextureSize(TEX.m_vSize, viewport);
-    if (data.opacity < 1.0 && scAsset) {
+    if (data.opacity < 1.0 && scAssetReady()) {
         const auto& SCTEX = getScAssetTex();
         g_pRenderer->renderTextureMix(TEXBOX, SCTEX, TEX, 1.0, data.opacity, 0);
     } else if (crossFadeProgress->isBeingAnimated()) {
@@ -267,41 +347,63 @@ bool CBackground::draw(const SRenderData& data) {
 }
 
 void CBackground::onAssetUpdate(ResourceID id, ASP<CTexture> newAsset) {
+    // Requested before the background was configured again.
+    if (id != requestedHandle.id())
+        return;
+
     pendingResource = false;
 
-    if (!newAsset)
+    if (!newAsset) {
+        requestedHandle.reset();
         Log::logger->log(Log::ERR, "Background asset update failed, resourceID: {} not available on update!", id);
-    else if (newAsset->m_iType == TEXTURE_INVALID) {
-        g_asyncResourceManager->unload(newAsset);
+    } else if (newAsset->m_iType == TEXTURE_INVALID) {
+        requestedHandle.reset();
         Log::logger->log(Log::ERR, "New background asset has an invalid texture!");
     } else {
-        pendingAsset = newAsset;
-        crossFadeProgress->setValueAndWarp(0);
-        *crossFadeProgress = 1.0;
-
-        crossFadeProgress->setCallbackOnEnd(
-            [REF = m_self, id](auto) {
-                if (const auto PSELF = REF.lock()) {
-                    if (PSELF->asset)
-                        g_asyncResourceManager->unload(PSELF->asset);
-                    PSELF->asset        = PSELF->pendingAsset;
-                    PSELF->pendingAsset = nullptr;
-                    PSELF->resourceID   = id;
-
-                    PSELF->blurredFB->destroyBuffer();
-                    PSELF->blurredFB = std::move(PSELF->pendingBlurredFB);
-                }
-            },
-            true);
+        pendingAsset  = newAsset;
+        pendingHandle = std::move(requestedHandle);
+        pendingBlurredTex.reset();
+
+        if (blurPasses == 0) {
+            startCrossFade(id);
+            return;
+        }
+
+        // Only start fading once the blurred version is ready
+        preprocess(pendingAsset, blurPasses, false, {}, [REF = m_self, REVISION = m_configRevision, id](ASP<CTexture> tex) {
+            if (const auto PSELF = REF.lock(); PSELF && PSELF->m_configRevision == REVISION) {
+                PSELF->pendingBlurredTex = tex;
+                PSELF->startCrossFade(id);
+            }
+        });
     }
 }
 
+void CBackground::startCrossFade(ResourceID id) {
+    crossFadeProgress->setValueAndWarp(0);
+    *crossFadeProgress = 1.0;
+
+    crossFadeProgress->setCallbackOnEnd(
+        [REF = m_self, REVISION = m_configRevision, id](auto) {
+            if (const auto PSELF = REF.lock(); PSELF && PSELF->m_configRevision == REVISION) {
+                PSELF->resourceHandle = std::move(PSELF->pendingHandle);
+                PSELF->asset          = PSELF->pendingAsset;
+                PSELF->pendingAsset   = nullptr;
+                PSELF->resourceID     = id;
+
+                PSELF->blurredTex = PSELF->pendingBlurredTex;
+                PSELF->pendingBlurredTex.reset();
+            }
+        },
+        true);
+}
+
 void CBackground::plantReloadTimer() {
 
     if (reloadTime == 0)
-        reloadTimer = g_pHyprlock->addTimer(std::chrono::hours(1), [REF = m_self](auto, auto) { onReloadTimer(REF); }, nullptr, true);
+        reloadTimer = g_pHyprlock->addTimer(std::chrono::hours(1), [REF = m_self](auto, auto) { onReloadTimer(REF); }, nullptr, true, TIMER_OWNER_BACKGROUND);
     else if (reloadTime > 0)
-        reloadTimer = g_pHyprlock->addTimer(std::chrono::seconds(reloadTime), [REF = m_self](auto, auto) { onReloadTimer(REF); }, nullptr, true);
+        reloadTimer = g_pHyprlock->addTimer(std::chrono::seconds(reloadTime), [REF = m_self](auto, auto) { onReloadTimer(REF); }, nullptr, true, TIMER_OWNER_BACKGROUND);
 }
 
 void CBackground::onReloadTimerUpdate() {
@@ -339,5 +441,5 @@ void CBackground::onReloadTimerUpdate() {
 
     // Issue the next request
     AWP<IWidget> widget(m_self);
-    g_asyncResourceManager->requestImage(path, m_imageRevision, widget);
+    requestedHandle = g_asyncResourceManager->requestImage(path, m_imageRevision, widget, imageSize, IMAGE_FIT_COVER, RESOURCE_PRIORITY_RELOAD);
 }
@@ -6,11 +6,11 @@
 #include "../../helpers/Color.hpp"
 #include "../../core/Timer.hpp"
 #include "../Framebuffer.hpp"
+#include "../ResourceHandle.hpp"
 #include <hyprutils/math/Misc.hpp>
 #include <string>
-#include <unordered_map>
-#include <any>
 #include <filesystem>
+#include <functional>
 
 struct SPreloadedAsset;
 class COutput;
@@ -22,34 +22,38 @@ class CBackground : public IWidget {
 
     void            registerSelf(const ASP<CBackground>& self);
 
-    virtual void    configure(const std::unordered_map<std::string, std::any>& props, const SP<COutput>& pOutput);
+    virtual void    configure(const SWidgetConfig& config, const SP<COutput>& pOutput);
     virtual bool    draw(const SRenderData& data);
     virtual void    onAssetUpdate(ResourceID id, ASP<CTexture> newAsset);
 
     void            reset(); // Unload assets, remove timers, etc.
 
     void            updatePrimaryAsset();
-    void            updatePendingAsset();
     void            updateScAsset();
 
     const CTexture& getPrimaryAssetTex() const;
     const CTexture& getPendingAssetTex() const;
     const CTexture& getScAssetTex() const;
+    bool            scAssetReady() const;
 
     void            renderRect(CHyprColor color);
-    void            renderToFB(const CTexture& text, CFramebuffer& fb, int passes, bool applyTransform = false);
+    // Scales tex to cover the viewport, optionally transforms and blurs it. Done on the gl worker if possible.
+    // The result is size large if set, otherwise viewport large.
+    void            preprocess(const ASP<CTexture>& tex, int passes, bool applyTransform, const Vector2D& size, std::function<void(ASP<CTexture>)> done);
 
     void            onReloadTimerUpdate();
     void            plantReloadTimer();
-    void            startCrossFade();
+    void            startCrossFade(ResourceID id);
 
   private:
     AWP<CBackground> m_self;
 
     // if needed
-    UP<CFramebuffer>                blurredFB;
-    UP<CFramebuffer>                pendingBlurredFB;
-    UP<CFramebuffer>                transformedScFB;
+    ASP<CTexture>                   blurredTex;
+    ASP<CTexture>                   pendingBlurredTex;
+    ASP<CTexture>                   transformedScTex;
+    bool                            primaryPreprocessing = false;
+    bool                            scPreprocessing      = false;
 
     int                             blurSize          = 10;
     int                             blurPasses        = 3;
@@ -59,6 +63,7 @@ class CBackground : public IWidget {
     float                           vibrancy          = 0.1696;
     float                           vibrancy_darkness = 0.0;
     Vector2D                        viewport;
+    Vector2D                        imageSize; // the output mode size, see configure()
     std::string                     path = "";
 
     std::string                     outputPort;
@@ -67,6 +72,10 @@ class CBackground : public IWidget {
     ResourceID                      resourceID      = 0;
     ResourceID                      scResourceID    = 0;
     bool                            pendingResource = false;
+    // References for path images. Screenshots are held by the resource manager.
+    CResourceHandle                 resourceHandle;
+    CResourceHandle                 requestedHandle; // waiting for onAssetUpdate
+    CResourceHandle                 pendingHandle;   // belongs to pendingAsset
 
     PHLANIMVAR<float>               crossFadeProgress;
 
@@ -75,11 +84,11 @@ class CBackground : public IWidget {
     ASP<CTexture>                   scAsset      = nullptr;
     ASP<CTexture>                   pendingAsset = nullptr;
     bool                            isScreenshot = false;
-    bool                            firstRender  = true;
 
     int                             reloadTime = -1;
     std::string                     reloadCommand;
     ASP<CTimer>                     reloadTimer;
     std::filesystem::file_time_type modificationTime;
-    size_t                          m_imageRevision = 0;
+    size_t                          m_imageRevision  = 0;
+    size_t                          m_configRevision = 0; // see reset()
 };
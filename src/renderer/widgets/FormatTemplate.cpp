@@ -0,0 +1,330 @@
+#include "FormatTemplate.hpp"
+#include "../../helpers/Log.hpp"
+#include "../../helpers/VariableProviders.hpp"
+#include "../../core/hyprlock.hpp"
+#include "../../auth/Auth.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <format>
+#include <iterator>
+#include <unistd.h>
+#include <pwd.h>
+#include <sys/stat.h>
+#include <hyprutils/string/VarList.hpp>
+
+using namespace Hyprutils::String;
+
+#if defined(_LIBCPP_VERSION)
+#pragma comment(lib, "date-tz")
+#include <date/tz.h>
+namespace std {
+    namespace chrono {
+        using date::current_zone;
+        using date::locate_zone;
+        using date::time_zone;
+    }
+}
+#endif
+
+// Looking up the zone goes through the tz database. Only do that again when TZ or /etc/localtime changed.
+static const std::chrono::time_zone* getTimezone() {
+    static bool                          resolved = false;
+    static std::string                   lastTZ;
+    static timespec                      lastLocaltime = {};
+    static const std::chrono::time_zone* pCachedTz     = nullptr;
+
+    const auto                           ENVTZ = std::getenv("TZ");
+    const std::string                    TZ    = ENVTZ ? ENVTZ : "";
+
+    struct stat                          localtime = {};
+    lstat("/etc/localtime", &localtime);
+
+    if (resolved && TZ == lastTZ && localtime.st_mtim.tv_sec == lastLocaltime.tv_sec && localtime.st_mtim.tv_nsec == lastLocaltime.tv_nsec)
+        return pCachedTz;
+
+    resolved      = true;
+    lastTZ        = TZ;
+    lastLocaltime = localtime.st_mtim;
+    pCachedTz     = nullptr;
+
+    try {
+        if (ENVTZ)
+            pCachedTz = std::chrono::locate_zone(TZ);
+    } catch (std::runtime_error&) { Log::logger->log(Log::WARN, "Invalid TZ value. Falling back to current timezone!"); }
+
+    try {
+        if (!pCachedTz)
+            pCachedTz = std::chrono::current_zone();
+    } catch (std::runtime_error&) { pCachedTz = nullptr; }
+
+    Log::logger->log(Log::TRACE, "Timezone: {}", pCachedTz ? pCachedTz->name() : "unknown");
+
+    return pCachedTz;
+}
+
+static bool                                                       logMissingTzOnce = true;
+static std::chrono::hh_mm_ss<std::chrono::system_clock::duration> getTime() {
+    const std::chrono::time_zone* pCurrentTz = getTimezone();
+
+    const auto                    TPNOW = std::chrono::system_clock::now();
+
+    //
+    std::chrono::hh_mm_ss<std::chrono::system_clock::duration> hhmmss;
+    if (!pCurrentTz) {
+        if (logMissingTzOnce) {
+            Log::logger->log(Log::WARN, "Current timezone unknown. Falling back to UTC!");
+            logMissingTzOnce = false;
+        }
+        hhmmss = std::chrono::hh_mm_ss{TPNOW - std::chrono::floor<std::chrono::days>(TPNOW)};
+    } else
+        hhmmss = std::chrono::hh_mm_ss{pCurrentTz->to_local(TPNOW) - std::chrono::floor<std::chrono::days>(pCurrentTz->to_local(TPNOW))};
+
+    return hhmmss;
+}
+
+static void appendTime24h(std::string& out) {
+    const auto HHMMSS = getTime();
+    std::format_to(std::back_inserter(out), "{:02}:{:02}", HHMMSS.hours().count(), HHMMSS.minutes().count());
+}
+
+static void appendTime12h(std::string& out) {
+    const auto HHMMSS = getTime();
+    const auto HRS    = HHMMSS.hours().count();
+    std::format_to(std::back_inserter(out), "{:02}:{:02} {}", HRS % 12 == 0 ? 12 : HRS % 12, HHMMSS.minutes().count(), HRS < 12 ? "AM" : "PM");
+}
+
+static void updateEvery(IWidget::SFormatResult& result, float ms) {
+    if (ms > 0 && (result.updateEveryMs == 0 || ms < result.updateEveryMs))
+        result.updateEveryMs = ms;
+}
+
+CFormatTemplate::CFormatTemplate(const std::string& in) {
+    if (!in.starts_with("cmd[") || !in.contains(']')) {
+        compile(in);
+        return;
+    }
+
+    // this is a command
+    const auto OPTIONSEND = in.find_first_of(']');
+    compile(std::string_view{in}.substr(OPTIONSEND + 1));
+
+    CVarList vars(in.substr(4, OPTIONSEND - 4), 0, ',', true);
+
+    for (const auto& v : vars) {
+        if (v.starts_with("update:")) {
+            try {
+                if (v.substr(7).contains(':')) {
+                    auto str                  = v.substr(v.substr(7).find_first_of(':') + 8);
+                    m_result.allowForceUpdate = str == "true" || std::stoull(str) == 1;
+                }
+
+                m_result.updateEveryMs = std::stoull(v.substr(7));
+            } catch (std::exception& e) { Log::logger->log(Log::ERR, "Error parsing {} in cmd[]", v); }
+        } else if (v == "stream") {
+            m_result.cmdStream = true;
+        } else if (v.starts_with("timeout:")) {
+            try {
+                m_result.cmdTimeoutMs = std::stoull(v.substr(8));
+            } catch (std::exception& e) { Log::logger->log(Log::ERR, "Error parsing {} in cmd[]", v); }
+        } else {
+            Log::logger->log(Log::ERR, "Unknown prop in string format {}", v);
+        }
+    }
+
+    m_result.alwaysUpdate = true;
+    m_result.cmd          = true;
+}
+
+void CFormatTemplate::compile(std::string_view in) {
+    // $TIME12 before $TIME
+    static const std::array<std::pair<std::string_view, eTokenType>, 11> VARIABLES = {{
+        {"TIME12", TOKEN_TIME12},
+        {"TIME", TOKEN_TIME},
+        {"ATTEMPTS", TOKEN_ATTEMPTS},
+        {"LAYOUT", TOKEN_LAYOUT},
+        {"FAIL", TOKEN_FAIL},
+        {"PAMFAIL", TOKEN_PAMFAIL},
+        {"PAMPROMPT", TOKEN_PAMPROMPT},
+        {"FPRINTFAIL", TOKEN_FPRINTFAIL},
+        {"FPRINTPROMPT", TOKEN_FPRINTPROMPT},
+        // resolved right away
+        {"USER", TOKEN_LITERAL},
+        {"DESC", TOKEN_LITERAL},
+    }};
+
+    auto  uidPassword = getpwuid(getuid());
+    char* username    = uidPassword ? uidPassword->pw_name : nullptr;
+    char* user_gecos  = uidPassword ? uidPassword->pw_gecos : nullptr;
+
+    if (!username)
+        Log::logger->log(Log::ERR, "Error in formatString, username null. Errno: ", errno);
+
+    if (!user_gecos)
+        Log::logger->log(Log::WARN, "Error in formatString, user_gecos null. Errno: ", errno);
+
+    size_t pos = 0;
+    while (pos < in.size()) {
+        if (in.substr(pos).starts_with("<br/>")) {
+            appendLiteral("\n");
+            pos += 5;
+            continue;
+        }
+
+        if (in[pos] != '$') {
+            appendLiteral(in.substr(pos, 1));
+            pos++;
+            continue;
+        }
+
+        // The longest name wins, a provider could be called $TIMER.
+        const auto   NAME    = in.substr(pos + 1);
+        const auto   VAR     = std::ranges::find_if(VARIABLES, [&NAME](const auto& v) { return NAME.starts_with(v.first); });
+        const auto   PROV    = g_pVariableProviders->match(NAME);
+        const size_t VARLEN  = VAR != VARIABLES.end() ? VAR->first.length() : 0;
+        const size_t PROVLEN = PROV ? PROV->name().length() : 0;
+
+        if (VARLEN == 0 && PROVLEN == 0) {
+            appendLiteral("$");
+            pos++;
+            continue;
+        }
+
+        if (PROVLEN > VARLEN) {
+            pos += 1 + PROVLEN;
+
+            std::string arg;
+            if (pos < in.size() && in[pos] == '{' && in.find('}', pos) != std::string_view::npos) {
+                const auto END = in.find('}', pos);
+                arg            = in.substr(pos + 1, END - pos - 1);
+                pos            = END + 1;
+            }
+
+            // Never changes, like $HOSTNAME.
+            if (PROV->interval(arg).count() == 0)
+                appendLiteral(PROV->value(arg));
+            else
+                appendVariable(SToken{.type = TOKEN_PROVIDER, .trigger = FORMAT_TRIGGER_INTERVAL, .text = arg, .provider = PROV});
+
+            continue;
+        }
+
+        pos += 1 + VARLEN;
+
+        if (VAR->first == "USER") {
+            appendLiteral(username ? username : "");
+            continue;
+        } else if (VAR->first == "DESC") {
+            appendLiteral(user_gecos ? user_gecos : "");
+            continue;
+        }
+
+        SToken token{.type = VAR->second, .trigger = FORMAT_TRIGGER_EVENT};
+        switch (token.type) {
+            case TOKEN_TIME:
+            case TOKEN_TIME12: token.trigger = FORMAT_TRIGGER_CLOCK; break;
+            case TOKEN_ATTEMPTS: token.event = STATE_EVENT_ATTEMPTS; break;
+            case TOKEN_LAYOUT: token.event = STATE_EVENT_LAYOUT; break;
+            case TOKEN_PAMPROMPT: token.event = STATE_EVENT_PAM_PROMPT; break;
+            case TOKEN_FPRINTPROMPT: token.event = STATE_EVENT_FPRINT_PROMPT; break;
+            default: token.event = STATE_EVENT_FAIL; break;
+        }
+
+        if ((token.type == TOKEN_ATTEMPTS || token.type == TOKEN_LAYOUT) && pos < in.size() && in[pos] == '[' && in.find(']', pos) != std::string_view::npos) {
+            const auto END = in.find(']', pos);
+            token.hasArg   = true;
+            token.text     = in.substr(pos + 1, END - pos - 1);
+            pos            = END + 1;
+
+            if (token.type == TOKEN_LAYOUT) {
+                const CVarList LANGS(token.text);
+                for (const auto& lang : LANGS) {
+                    token.layouts.emplace_back(lang);
+                }
+            }
+        }
+
+        appendVariable(std::move(token));
+    }
+}
+
+void CFormatTemplate::appendLiteral(std::string_view text) {
+    if (m_tokens.empty() || m_tokens.back().type != TOKEN_LITERAL)
+        m_tokens.emplace_back();
+
+    m_tokens.back().text += text;
+}
+
+void CFormatTemplate::appendVariable(SToken&& token) {
+    switch (token.trigger) {
+        // The time only shows minutes. Updates happen on the minute, see alignUpdates.
+        case FORMAT_TRIGGER_CLOCK:
+            updateEvery(m_result, 60000);
+            m_result.alignUpdates = true;
+            break;
+        case FORMAT_TRIGGER_INTERVAL:
+            updateEvery(m_result, token.provider->interval(token.text).count());
+            m_result.alignUpdates = m_result.alignUpdates || token.provider->alignToClock();
+            break;
+        case FORMAT_TRIGGER_EVENT: m_events |= 1 << token.event; break;
+        default: break;
+    }
+
+    m_tokens.emplace_back(std::move(token));
+}
+
+const IWidget::SFormatResult& CFormatTemplate::format() {
+    auto& out = m_result.formatted;
+    out.clear();
+
+    for (const auto& token : m_tokens) {
+        switch (token.type) {
+            case TOKEN_LITERAL: out += token.text; break;
+            case TOKEN_TIME: appendTime24h(out); break;
+            case TOKEN_TIME12: appendTime12h(out); break;
+            case TOKEN_PROVIDER: out += token.provider->value(token.text); break;
+            case TOKEN_ATTEMPTS: {
+                const auto ATTEMPTS = g_pAuth->getFailedAttempts();
+                if (token.hasArg && ATTEMPTS == 0)
+                    out += token.text;
+                else
+                    out += std::to_string(ATTEMPTS);
+                break;
+            }
+            case TOKEN_LAYOUT: {
+                const auto LAYOUTIDX = g_pHyprlock->m_uiActiveLayout;
+                const auto PNAME     = g_pSeatManager->m_pXKBKeymap ? xkb_keymap_layout_get_name(g_pSeatManager->m_pXKBKeymap, LAYOUTIDX) : nullptr;
+                const auto NAME      = PNAME ? PNAME : "error";
+
+                if (!token.hasArg)
+                    out += NAME;
+                else if (LAYOUTIDX >= token.layouts.size())
+                    Log::logger->log(Log::ERR, "Layout index {} out of bounds. Max is {}.", LAYOUTIDX, token.layouts.size() - 1);
+                else if (token.layouts[LAYOUTIDX].empty())
+                    out += NAME;
+                else if (token.layouts[LAYOUTIDX] != "!")
+                    out += token.layouts[LAYOUTIDX];
+                break;
+            }
+            case TOKEN_FAIL: out += g_pAuth->getCurrentFailText(); break;
+            case TOKEN_PAMFAIL: out += g_pAuth->getFailText(AUTH_IMPL_PAM).value_or(""); break;
+            case TOKEN_PAMPROMPT: out += g_pAuth->getPrompt(AUTH_IMPL_PAM).value_or(""); break;
+            case TOKEN_FPRINTFAIL: out += g_pAuth->getFailText(AUTH_IMPL_FINGERPRINT).value_or(""); break;
+            case TOKEN_FPRINTPROMPT: out += g_pAuth->getPrompt(AUTH_IMPL_FINGERPRINT).value_or(""); break;
+        }
+    }
+
+    return m_result;
+}
+
+const IWidget::SFormatResult& CFormatTemplate::result() const {
+    return m_result;
+}
+
+bool CFormatTemplate::dependsOn(eFormatTrigger trigger) const {
+    return std::ranges::any_of(m_tokens, [trigger](const auto& token) { return token.trigger == trigger; });
+}
+
+uint32_t CFormatTemplate::events() const {
+    return m_events;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "IWidget.hpp"
+#include "../../core/StateEvents.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+class IVariableProvider;
+
+// What changes the value of a variable in a label text.
+enum eFormatTrigger : uint8_t {
+    FORMAT_TRIGGER_NONE = 0, // never, resolved when compiling
+    FORMAT_TRIGGER_CLOCK,    // $TIME, $TIME12
+    FORMAT_TRIGGER_INTERVAL, // variable providers, polled at their interval
+    FORMAT_TRIGGER_EVENT,    // auth and seat state, see eStateEvent
+};
+
+// A label text, compiled once into literals and variables.
+// Formatting it again only looks up the variables and appends everything to a reused buffer.
+class CFormatTemplate {
+  public:
+    CFormatTemplate() = default;
+    explicit CFormatTemplate(const std::string& in);
+
+    // The returned formatted text is overwritten by the next call.
+    const IWidget::SFormatResult& format();
+    // Everything but the formatted text is known after compiling.
+    const IWidget::SFormatResult& result() const;
+    bool                          dependsOn(eFormatTrigger trigger) const;
+    // The state events the text depends on, a mask of 1 << eStateEvent.
+    uint32_t                      events() const;
+
+  private:
+    enum eTokenType : uint8_t {
+        TOKEN_LITERAL = 0,
+        TOKEN_TIME,
+        TOKEN_TIME12,
+        TOKEN_PROVIDER,
+        TOKEN_ATTEMPTS,
+        TOKEN_LAYOUT,
+        TOKEN_FAIL,
+        TOKEN_PAMFAIL,
+        TOKEN_PAMPROMPT,
+        TOKEN_FPRINTFAIL,
+        TOKEN_FPRINTPROMPT,
+    };
+
+    struct SToken {
+        eTokenType               type    = TOKEN_LITERAL;
+        eFormatTrigger           trigger = FORMAT_TRIGGER_NONE;
+        std::string              text;           // the literal, the provider argument or what $ATTEMPTS[...] shows for zero attempts
+        bool                     hasArg = false; // $ATTEMPTS[...] or $LAYOUT[...]
+        std::vector<std::string> layouts;
+        IVariableProvider*       provider = nullptr;
+        eStateEvent              event    = STATE_EVENT_ATTEMPTS; // FORMAT_TRIGGER_EVENT
+    };
+
+    void                   compile(std::string_view in);
+    void                   appendLiteral(std::string_view text);
+    void                   appendVariable(SToken&& token);
+
+    std::vector<SToken>    m_tokens;
+    IWidget::SFormatResult m_result;
+    uint32_t               m_events = 0;
+};
@@ -4,11 +4,10 @@
 #include "../../helpers/Math.hpp"
 #include "../../core/Seat.hpp"
 #include "../Texture.hpp"
+#include "../../config/WidgetConfig.hpp"
 
 #include <hyprgraphics/resource/resources/TextResource.hpp>
 #include <string>
-#include <unordered_map>
-#include <any>
 
 class COutput;
 
@@ -20,18 +19,16 @@ class IWidget {
 
     virtual ~IWidget() = default;
 
-    virtual void configure(const std::unordered_map<std::string, std::any>& prop, const SP<COutput>& pOutput) = 0;
-    virtual bool draw(const SRenderData& data)                                                                = 0;
+    virtual void configure(const SWidgetConfig& config, const SP<COutput>& pOutput) = 0;
+    virtual bool draw(const SRenderData& data)                                      = 0;
     // Never render within onAssetUpdate!
     virtual void    onAssetUpdate(ResourceID id, ASP<CTexture> newAsset) = 0;
 
-    static Vector2D posFromHVAlign(const Vector2D& viewport, const Vector2D& size, const Vector2D& offset, const std::string& halign, const std::string& valign,
-                                   const double& ang = 0);
+    static Vector2D posFromHVAlign(const Vector2D& viewport, const Vector2D& size, const Vector2D& offset, eHAlign halign, eVAlign valign, const double& ang = 0);
     static int      roundingForBox(const CBox& box, int roundingConfig);
     static int      roundingForBorderBox(const CBox& borderBox, int roundingConfig, int thickness);
-    static Hyprgraphics::CTextResource::eTextAlignmentMode parseTextAlignment(const std::string& alignment);
 
-    virtual CBox                                           getBoundingBoxWl() const {
+    virtual CBox    getBoundingBoxWl() const {
         return CBox();
     };
     virtual void onClick(uint32_t button, bool down, const Vector2D& pos) {}
@@ -44,8 +41,12 @@ class IWidget {
         bool        alwaysUpdate     = false;
         bool        cmd              = false;
         bool        allowForceUpdate = false;
+        uint64_t    cmdTimeoutMs     = 0; // 0 means general:cmd_timeout
+        bool        cmdStream        = false; // every line the command prints is the new text
+        bool        alignUpdates     = false; // update when the wall clock reaches a multiple of updateEveryMs
     };
 
+    // For text formatted over and over, compile a CFormatTemplate once instead.
     static SFormatResult formatString(std::string in);
 
     void                 setHover(bool hover);
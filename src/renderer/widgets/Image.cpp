@@ -64,47 +64,43 @@ void CImage::onTimerUpdate() {
     m_pendingResource = true;
 
     AWP<IWidget> widget(m_self);
-    g_asyncResourceManager->requestImage(path, m_imageRevision, widget);
+    requestedHandle = g_asyncResourceManager->requestImage(path, m_imageRevision, widget, Vector2D{size, size}, IMAGE_FIT_COVER, RESOURCE_PRIORITY_RELOAD);
 }
 
 void CImage::plantTimer() {
 
     if (reloadTime == 0) {
-        imageTimer = g_pHyprlock->addTimer(std::chrono::hours(1), [REF = m_self](auto, auto) { onTimer(REF); }, nullptr, true);
+        imageTimer = g_pHyprlock->addTimer(std::chrono::hours(1), [REF = m_self](auto, auto) { onTimer(REF); }, nullptr, true, TIMER_OWNER_IMAGE);
     } else if (reloadTime > 0)
-        imageTimer = g_pHyprlock->addTimer(std::chrono::seconds(reloadTime), [REF = m_self](auto, auto) { onTimer(REF); }, nullptr, false);
+        imageTimer = g_pHyprlock->addTimer(std::chrono::seconds(reloadTime), [REF = m_self](auto, auto) { onTimer(REF); }, nullptr, false, TIMER_OWNER_IMAGE);
 }
 
-void CImage::configure(const std::unordered_map<std::string, std::any>& props, const SP<COutput>& pOutput) {
+void CImage::configure(const SWidgetConfig& config, const SP<COutput>& pOutput) {
     reset();
 
     viewport   = pOutput->getViewport();
     stringPort = pOutput->stringPort;
 
-    shadow.configure(m_self, props, viewport);
+    const auto& CONFIG = std::get<SImageConfig>(config.values);
 
-    try {
-        size      = std::any_cast<Hyprlang::INT>(props.at("size"));
-        rounding  = std::any_cast<Hyprlang::INT>(props.at("rounding"));
-        border    = std::any_cast<Hyprlang::INT>(props.at("border_size"));
-        color     = *CGradientValueData::fromAnyPv(props.at("border_color"));
-        configPos = CLayoutValueData::fromAnyPv(props.at("position"))->getAbsolute(viewport);
-        halign    = std::any_cast<Hyprlang::STRING>(props.at("halign"));
-        valign    = std::any_cast<Hyprlang::STRING>(props.at("valign"));
-        angle     = std::any_cast<Hyprlang::FLOAT>(props.at("rotate"));
-
-        path           = std::any_cast<Hyprlang::STRING>(props.at("path"));
-        reloadTime     = std::any_cast<Hyprlang::INT>(props.at("reload_time"));
-        reloadCommand  = std::any_cast<Hyprlang::STRING>(props.at("reload_cmd"));
-        onclickCommand = std::any_cast<Hyprlang::STRING>(props.at("onclick"));
-    } catch (const std::bad_any_cast& e) {
-        RASSERT(false, "Failed to construct CImage: {}", e.what()); //
-    } catch (const std::out_of_range& e) {
-        RASSERT(false, "Missing propperty for CImage: {}", e.what()); //
-    }
+    shadow.configure(m_self, CONFIG.shadow, viewport);
+
+    size      = CONFIG.size;
+    rounding  = CONFIG.rounding;
+    border    = CONFIG.border;
+    color     = CONFIG.borderColor;
+    configPos = CONFIG.position.getAbsolute(viewport);
+    halign    = CONFIG.halign;
+    valign    = CONFIG.valign;
+    angle     = CONFIG.rotate;
 
-    resourceID = g_asyncResourceManager->requestImage(path, m_imageRevision, nullptr);
-    angle      = angle * M_PI / 180.0;
+    path           = CONFIG.path;
+    reloadTime     = CONFIG.reloadTime;
+    reloadCommand  = CONFIG.reloadCommand;
+    onclickCommand = CONFIG.onclick;
+
+    resourceHandle = g_asyncResourceManager->requestImage(path, m_imageRevision, nullptr, Vector2D{size, size}, IMAGE_FIT_COVER);
+    angle          = angle * M_PI / 180.0;
 
     if (reloadTime > -1) {
         try {
@@ -126,28 +122,28 @@ void CImage::reset() {
 
     imageFB.destroyBuffer();
 
-    if (asset && reloadTime > -1) // Don't unload asset if it's a static image
-        g_asyncResourceManager->unload(asset);
+    resourceHandle.reset();
+    requestedHandle.reset();
 
     asset             = nullptr;
     m_pendingResource = false;
-    resourceID        = 0;
+    firstRender       = true;
 }
 
 bool CImage::draw(const SRenderData& data) {
 
-    if (resourceID == 0)
+    if (!resourceHandle)
         return false;
 
     if (!asset)
-        asset = g_asyncResourceManager->getAssetByID(resourceID);
+        asset = g_asyncResourceManager->getAssetByID(resourceHandle.id());
 
     if (!asset)
         return true;
 
     if (asset->m_iType == TEXTURE_INVALID) {
-        g_asyncResourceManager->unload(asset);
-        resourceID = 0;
+        resourceHandle.reset();
+        asset = nullptr;
         return false;
     }
 
@@ -210,20 +206,24 @@ bool CImage::draw(const SRenderData& data) {
 }
 
 void CImage::onAssetUpdate(ResourceID id, ASP<CTexture> newAsset) {
+    // Requested before the image was configured again.
+    if (id != requestedHandle.id())
+        return;
+
     m_pendingResource = false;
 
-    if (!newAsset)
+    if (!newAsset) {
+        requestedHandle.reset();
         Log::logger->log(Log::ERR, "asset update failed, resourceID: {} not available on update!", id);
-    else if (newAsset->m_iType == TEXTURE_INVALID) {
-        g_asyncResourceManager->unload(newAsset);
+    } else if (newAsset->m_iType == TEXTURE_INVALID) {
+        requestedHandle.reset();
         Log::logger->log(Log::ERR, "New image asset has an invalid texture!");
     } else {
-        g_asyncResourceManager->unload(asset);
         imageFB.destroyBuffer();
 
-        asset       = newAsset;
-        resourceID  = id;
-        firstRender = true;
+        resourceHandle = std::move(requestedHandle);
+        asset          = newAsset;
+        firstRender    = true;
     }
 }
 
@@ -6,11 +6,10 @@
 #include "../../helpers/Math.hpp"
 #include "../../config/ConfigDataValues.hpp"
 #include "../../core/Timer.hpp"
+#include "../ResourceHandle.hpp"
 #include "Shadowable.hpp"
 #include <string>
 #include <filesystem>
-#include <unordered_map>
-#include <any>
 
 struct SPreloadedAsset;
 class COutput;
@@ -22,7 +21,7 @@ class CImage : public IWidget {
 
     void         registerSelf(const ASP<CImage>& self);
 
-    virtual void configure(const std::unordered_map<std::string, std::any>& props, const SP<COutput>& pOutput);
+    virtual void configure(const SWidgetConfig& config, const SP<COutput>& pOutput);
     virtual bool draw(const SRenderData& data);
     virtual void onAssetUpdate(ResourceID id, ASP<CTexture> newAsset);
 
@@ -49,7 +48,9 @@ class CImage : public IWidget {
     Vector2D                        pos;
     Vector2D                        configPos;
 
-    std::string                     halign, valign, path;
+    eHAlign                         halign = HALIGN_CENTER;
+    eVAlign                         valign = VALIGN_CENTER;
+    std::string                     path;
 
     bool                            firstRender = true;
 
@@ -65,7 +66,9 @@ class CImage : public IWidget {
     Vector2D                        viewport;
     std::string                     stringPort;
 
-    ResourceID                      resourceID        = 0;
+    CResourceHandle                 resourceHandle;
+    // The request issued by onTimerUpdate, becomes resourceHandle once the texture arrives.
+    CResourceHandle                 requestedHandle;
     bool                            m_pendingResource = false;
 
     ASP<CTexture>                   asset = nullptr;
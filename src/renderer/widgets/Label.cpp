@@ -5,6 +5,8 @@
 #include "../../core/hyprlock.hpp"
 #include "../../helpers/Color.hpp"
 #include "../../helpers/MiscFunctions.hpp"
+#include "../../helpers/CommandStreams.hpp"
+#include "../../core/StateEvents.hpp"
 #include "../../config/ConfigDataValues.hpp"
 #include "src/defines.hpp"
 #include <hyprlang.hpp>
@@ -33,79 +35,118 @@ void CLabel::onTimerUpdate() {
         return;
     }
 
-    std::string oldFormatted = label.formatted;
+    const auto& FORMATTED = label.format();
 
-    label = formatString(labelPreFormat);
-
-    if (label.formatted == oldFormatted && !label.alwaysUpdate)
+    if (FORMATTED.formatted == request.text && !FORMATTED.alwaysUpdate)
         return;
 
     // request new
-    request.text      = label.formatted;
+    request.text      = FORMATTED.formatted;
     m_pendingResource = true;
 
     AWP<IWidget> widget(m_self);
-    if (label.cmd) {
+    if (FORMATTED.cmd) {
         // Don't increment by one to avoid clashes with multiple widget using the same label command.
-        m_dynamicRevision += (label.updateEveryMs == 0) ? 1 : label.updateEveryMs;
-        g_asyncResourceManager->requestTextCmd(request, m_dynamicRevision, widget.lock());
+        m_dynamicRevision += (FORMATTED.updateEveryMs == 0) ? 1 : FORMATTED.updateEveryMs;
+        requestedHandle =
+            g_asyncResourceManager->requestTextCmd(request, m_dynamicRevision, widget.lock(), RESOURCE_PRIORITY_RELOAD, std::chrono::milliseconds(FORMATTED.cmdTimeoutMs));
     } else
-        g_asyncResourceManager->requestText(request, widget.lock());
+        requestedHandle = g_asyncResourceManager->requestText(request, widget.lock(), RESOURCE_PRIORITY_RELOAD);
 }
 
-void CLabel::plantTimer() {
+void CLabel::onStreamLine(const std::string& line) {
+    if (line == request.text)
+        return;
+
+    request.text      = line;
+    m_pendingResource = true;
+
+    // Replaces a request that is still pending, its callback is ignored in onAssetUpdate.
+    AWP<IWidget> widget(m_self);
+    requestedHandle = g_asyncResourceManager->requestText(request, widget.lock(), RESOURCE_PRIORITY_RELOAD);
+}
+
+// Only re-formats, the update timer keeps its schedule.
+void CLabel::onStateEvent() {
+    // onTimerUpdate skips while a request is pending, onAssetUpdate formats again once it resolved.
+    if (m_pendingResource) {
+        m_stateChanged = true;
+        return;
+    }
+
+    onTimerUpdate();
+}
 
-    if (label.updateEveryMs != 0)
-        labelTimer = g_pHyprlock->addTimer(std::chrono::milliseconds((int)label.updateEveryMs), [REF = m_self](auto, auto) { onTimer(REF); }, this, label.allowForceUpdate);
-    else if (label.updateEveryMs == 0 && label.allowForceUpdate)
-        labelTimer = g_pHyprlock->addTimer(std::chrono::hours(1), [REF = m_self](auto, auto) { onTimer(REF); }, this, true);
+// Time until the wall clock reaches the next multiple of period. Minute and second boundaries are the same in every timezone.
+static std::chrono::system_clock::duration untilBoundary(std::chrono::milliseconds period) {
+    const auto NOW = std::chrono::system_clock::now().time_since_epoch();
+    return period - NOW % period;
 }
 
-void CLabel::configure(const std::unordered_map<std::string, std::any>& props, const SP<COutput>& pOutput) {
+void CLabel::plantTimer() {
+    const auto& LABEL = label.result();
+
+    if (LABEL.updateEveryMs != 0 && LABEL.alignUpdates)
+        labelTimer = g_pHyprlock->addTimer(untilBoundary(std::chrono::milliseconds((int)LABEL.updateEveryMs)), [REF = m_self](auto, auto) { onTimer(REF); }, this,
+                                           LABEL.allowForceUpdate, TIMER_OWNER_LABEL);
+    else if (LABEL.updateEveryMs != 0)
+        labelTimer = g_pHyprlock->addTimer(std::chrono::milliseconds((int)LABEL.updateEveryMs), [REF = m_self](auto, auto) { onTimer(REF); }, this, LABEL.allowForceUpdate,
+                                           TIMER_OWNER_LABEL);
+    else if (LABEL.updateEveryMs == 0 && LABEL.allowForceUpdate)
+        labelTimer = g_pHyprlock->addTimer(std::chrono::hours(1), [REF = m_self](auto, auto) { onTimer(REF); }, this, true, TIMER_OWNER_LABEL);
+}
+
+void CLabel::configure(const SWidgetConfig& config, const SP<COutput>& pOutput) {
     reset();
 
     outputStringPort = pOutput->stringPort;
     viewport         = pOutput->getViewport();
 
-    shadow.configure(m_self, props, viewport);
-
-    try {
-        configPos      = CLayoutValueData::fromAnyPv(props.at("position"))->getAbsolute(viewport);
-        labelPreFormat = std::any_cast<Hyprlang::STRING>(props.at("text"));
-        halign         = std::any_cast<Hyprlang::STRING>(props.at("halign"));
-        valign         = std::any_cast<Hyprlang::STRING>(props.at("valign"));
-        m_angle        = std::any_cast<Hyprlang::FLOAT>(props.at("rotate"));
-        m_angle        = m_angle * M_PI / 180.0;
-        onclickCommand = std::any_cast<Hyprlang::STRING>(props.at("onclick"));
-
-        std::string textAlign  = std::any_cast<Hyprlang::STRING>(props.at("text_align"));
-        std::string fontFamily = std::any_cast<Hyprlang::STRING>(props.at("font_family"));
-        CHyprColor  labelColor = std::any_cast<Hyprlang::INT>(props.at("color"));
-        int         fontSize   = std::any_cast<Hyprlang::INT>(props.at("font_size"));
-
-        label = formatString(labelPreFormat);
-
-        request.text     = label.formatted;
-        request.font     = fontFamily;
-        request.fontSize = fontSize;
-        request.color    = labelColor.asRGB();
-        m_alpha          = labelColor.a;
-
-        if (!textAlign.empty())
-            request.align = parseTextAlignment(textAlign);
-
-    } catch (const std::bad_any_cast& e) {
-        RASSERT(false, "Failed to construct CLabel: {}", e.what()); //
-    } catch (const std::out_of_range& e) {
-        RASSERT(false, "Missing property for CLabel: {}", e.what()); //
-    }
+    const auto& CONFIG = std::get<SLabelConfig>(config.values);
+
+    shadow.configure(m_self, CONFIG.shadow, viewport);
+
+    configPos      = CONFIG.position.getAbsolute(viewport);
+    label          = CFormatTemplate{CONFIG.text};
+    halign         = CONFIG.halign;
+    valign         = CONFIG.valign;
+    m_angle        = CONFIG.rotate * M_PI / 180.0;
+    onclickCommand = CONFIG.onclick;
+
+    request.text     = label.format().formatted;
+    request.font     = CONFIG.fontFamily;
+    request.fontSize = CONFIG.fontSize;
+    request.color    = CONFIG.color.asRGB();
+    m_alpha          = CONFIG.color.a;
+
+    if (CONFIG.textAlign)
+        request.align = *CONFIG.textAlign;
 
     pos = configPos; // Label size not known yet
 
-    if (label.cmd) {
-        resourceID = g_asyncResourceManager->requestTextCmd(request, m_dynamicRevision, nullptr);
+    const auto& LABEL = label.result();
+
+    if (LABEL.cmd && LABEL.cmdStream) {
+        // Nothing to show until the command prints its first line.
+        request.text  = "";
+        m_streamToken = g_pCommandStreams->subscribe(LABEL.formatted, [REF = m_self](const std::string& line) {
+            if (auto PLABEL = REF.lock(); PLABEL)
+                PLABEL->onStreamLine(line);
+        });
+        return;
+    }
+
+    if (label.events() != 0) {
+        m_eventToken = g_pStateEvents->subscribe(label.events(), [REF = m_self]() {
+            if (auto PLABEL = REF.lock(); PLABEL)
+                PLABEL->onStateEvent();
+        });
+    }
+
+    if (LABEL.cmd) {
+        resourceHandle = g_asyncResourceManager->requestTextCmd(request, m_dynamicRevision, nullptr, RESOURCE_PRIORITY_VISIBLE, std::chrono::milliseconds(LABEL.cmdTimeoutMs));
     } else
-        resourceID = g_asyncResourceManager->requestText(request, nullptr);
+        resourceHandle = g_asyncResourceManager->requestText(request, nullptr);
 
     plantTimer();
 }
@@ -116,20 +157,29 @@ void CLabel::reset() {
         labelTimer.reset();
     }
 
+    if (m_streamToken != 0 && g_pCommandStreams)
+        g_pCommandStreams->unsubscribe(m_streamToken);
+    m_streamToken = 0;
+
+    if (m_eventToken != 0 && g_pStateEvents)
+        g_pStateEvents->unsubscribe(m_eventToken);
+    m_eventToken = 0;
+
     if (g_pHyprlock->isTerminating())
         return;
 
-    if (asset)
-        g_asyncResourceManager->unload(asset);
+    resourceHandle.reset();
+    requestedHandle.reset();
 
     asset             = nullptr;
     m_pendingResource = false;
-    resourceID        = 0;
+    m_stateChanged    = false;
+    updateShadow      = true;
 }
 
 bool CLabel::draw(const SRenderData& data) {
     if (!asset) {
-        asset = g_asyncResourceManager->getAssetByID(resourceID);
+        asset = g_asyncResourceManager->getAssetByID(resourceHandle.id());
 
         if (!asset)
             return true;
@@ -154,19 +204,32 @@ bool CLabel::draw(const SRenderData& data) {
 
 void CLabel::onAssetUpdate(ResourceID id, ASP<CTexture> newAsset) {
     Log::logger->log(Log::TRACE, "Label update for resourceID {}", id);
+
+    // Superseded by a newer request.
+    if (id != requestedHandle.id())
+        return;
+
     m_pendingResource = false;
 
-    if (!newAsset)
+    if (!newAsset) {
+        requestedHandle.reset();
         Log::logger->log(Log::ERR, "asset update failed, resourceID: {} not available on update!", id);
-    else if (newAsset->m_iType == TEXTURE_INVALID) {
-        g_asyncResourceManager->unload(newAsset);
+    } else if (newAsset->m_iType == TEXTURE_INVALID) {
+        requestedHandle.reset();
         Log::logger->log(Log::ERR, "New image asset has an invalid texture!");
     } else {
         // new asset is ready :D
-        g_asyncResourceManager->unload(asset);
-        asset        = newAsset;
-        resourceID   = id;
-        updateShadow = true;
+        resourceHandle = std::move(requestedHandle);
+        // Unchanged command output comes back with the texture we already show.
+        if (asset != newAsset) {
+            asset        = newAsset;
+            updateShadow = true;
+        }
+    }
+
+    if (m_stateChanged) {
+        m_stateChanged = false;
+        onTimerUpdate();
     }
 }
 
@@ -2,13 +2,13 @@
 
 #include "../../defines.hpp"
 #include "IWidget.hpp"
+#include "FormatTemplate.hpp"
 #include "Shadowable.hpp"
 #include "../../core/Timer.hpp"
+#include "../ResourceHandle.hpp"
 #include <hyprgraphics/resource/resources/AsyncResource.hpp>
 #include <hyprgraphics/resource/resources/TextResource.hpp>
 #include <string>
-#include <unordered_map>
-#include <any>
 
 struct SPreloadedAsset;
 class CSessionLockSurface;
@@ -20,7 +20,7 @@ class CLabel : public IWidget {
 
     void         registerSelf(const ASP<CLabel>& self);
 
-    virtual void configure(const std::unordered_map<std::string, std::any>& prop, const SP<COutput>& pOutput);
+    virtual void configure(const SWidgetConfig& config, const SP<COutput>& pOutput);
     virtual bool draw(const SRenderData& data);
     virtual void onAssetUpdate(ResourceID id, ASP<CTexture> newAsset);
 
@@ -33,14 +33,16 @@ class CLabel : public IWidget {
     void         renderUpdate();
     void         onTimerUpdate();
     void         plantTimer();
+    void         onStreamLine(const std::string& line);
+    void         onStateEvent();
 
   private:
     AWP<CLabel>                                    m_self;
 
-    std::string                                    labelPreFormat;
-    IWidget::SFormatResult                         label;
+    CFormatTemplate                                label;
 
-    std::string                                    halign, valign;
+    eHAlign                                        halign = HALIGN_CENTER;
+    eVAlign                                        valign = VALIGN_CENTER;
     std::string                                    onclickCommand;
 
     Vector2D                                       viewport;
@@ -49,8 +51,11 @@ class CLabel : public IWidget {
     double                                         m_angle = 0;
     double                                         m_alpha = 0;
 
-    ResourceID                                     resourceID        = 0;
+    CResourceHandle                                resourceHandle;
+    // The request issued by onTimerUpdate, becomes resourceHandle once the texture arrives.
+    CResourceHandle                                requestedHandle;
     bool                                           m_pendingResource = false;
+    bool                                           m_stateChanged    = false; // a state event arrived while m_pendingResource was set
 
     size_t                                         m_dynamicRevision = 0;
 
@@ -61,6 +66,10 @@ class CLabel : public IWidget {
     Hyprgraphics::CTextResource::STextResourceData request;
 
     ASP<CTimer>                                    labelTimer = nullptr;
+    // Subscription to the command of a cmd[stream] label
+    uint64_t                                       m_streamToken = 0;
+    // Subscription to the auth and seat state the text shows
+    uint64_t                                       m_eventToken = 0;
 
     CShadowable                                    shadow;
     bool                                           updateShadow = true;
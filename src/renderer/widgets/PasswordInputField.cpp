@@ -25,49 +25,46 @@ void CPasswordInputField::registerSelf(const ASP<CPasswordInputField>& self) {
     m_self = self;
 }
 
-void CPasswordInputField::configure(const std::unordered_map<std::string, std::any>& props, const SP<COutput>& pOutput) {
+void CPasswordInputField::configure(const SWidgetConfig& config, const SP<COutput>& pOutput) {
     reset();
 
     outputStringPort = pOutput->stringPort;
     viewport         = pOutput->getViewport();
-
-    shadow.configure(m_self, props, viewport);
-
-    try {
-        pos                      = CLayoutValueData::fromAnyPv(props.at("position"))->getAbsolute(viewport);
-        configSize               = CLayoutValueData::fromAnyPv(props.at("size"))->getAbsolute(viewport);
-        halign                   = std::any_cast<Hyprlang::STRING>(props.at("halign"));
-        valign                   = std::any_cast<Hyprlang::STRING>(props.at("valign"));
-        outThick                 = std::any_cast<Hyprlang::INT>(props.at("outline_thickness"));
-        dots.size                = std::any_cast<Hyprlang::FLOAT>(props.at("dots_size"));
-        dots.spacing             = std::any_cast<Hyprlang::FLOAT>(props.at("dots_spacing"));
-        dots.center              = std::any_cast<Hyprlang::INT>(props.at("dots_center"));
-        dots.rounding            = std::any_cast<Hyprlang::INT>(props.at("dots_rounding"));
-        dots.textFormat          = std::any_cast<Hyprlang::STRING>(props.at("dots_text_format"));
-        fadeOnEmpty              = std::any_cast<Hyprlang::INT>(props.at("fade_on_empty"));
-        fadeTimeoutMs            = std::any_cast<Hyprlang::INT>(props.at("fade_timeout"));
-        hiddenInputState.enabled = std::any_cast<Hyprlang::INT>(props.at("hide_input"));
-        rounding                 = std::any_cast<Hyprlang::INT>(props.at("rounding"));
-        configPlaceholderText    = std::any_cast<Hyprlang::STRING>(props.at("placeholder_text"));
-        configFailText           = std::any_cast<Hyprlang::STRING>(props.at("fail_text"));
-        configCheckText          = std::any_cast<Hyprlang::STRING>(props.at("check_text"));
-        fontFamily               = std::any_cast<Hyprlang::STRING>(props.at("font_family"));
-        colorConfig.outer        = CGradientValueData::fromAnyPv(props.at("outer_color"));
-        colorConfig.inner        = std::any_cast<Hyprlang::INT>(props.at("inner_color"));
-        colorConfig.font         = std::any_cast<Hyprlang::INT>(props.at("font_color"));
-        colorConfig.fail         = CGradientValueData::fromAnyPv(props.at("fail_color"));
-        colorConfig.check        = CGradientValueData::fromAnyPv(props.at("check_color"));
-        colorConfig.both         = CGradientValueData::fromAnyPv(props.at("bothlock_color"));
-        colorConfig.caps         = CGradientValueData::fromAnyPv(props.at("capslock_color"));
-        colorConfig.num          = CGradientValueData::fromAnyPv(props.at("numlock_color"));
-        colorConfig.invertNum    = std::any_cast<Hyprlang::INT>(props.at("invert_numlock"));
-        colorConfig.swapFont     = std::any_cast<Hyprlang::INT>(props.at("swap_font_color"));
-        colorConfig.hiddenBase   = std::any_cast<Hyprlang::INT>(props.at("hide_input_base_color"));
-    } catch (const std::bad_any_cast& e) {
-        RASSERT(false, "Failed to construct CPasswordInputField: {}", e.what()); //
-    } catch (const std::out_of_range& e) {
-        RASSERT(false, "Missing property for CPasswordInputField: {}", e.what()); //
-    }
+    firstRender      = true;
+
+    const auto& CONFIG = std::get<SInputFieldConfig>(config.values);
+
+    shadow.configure(m_self, CONFIG.shadow, viewport);
+
+    pos                      = CONFIG.position.getAbsolute(viewport);
+    configSize               = CONFIG.size.getAbsolute(viewport);
+    halign                   = CONFIG.halign;
+    valign                   = CONFIG.valign;
+    outThick                 = CONFIG.outlineThickness;
+    dots.size                = CONFIG.dotsSize;
+    dots.spacing             = CONFIG.dotsSpacing;
+    dots.center              = CONFIG.dotsCenter;
+    dots.rounding            = CONFIG.dotsRounding;
+    dots.textFormat          = CONFIG.dotsTextFormat;
+    fadeOnEmpty              = CONFIG.fadeOnEmpty;
+    fadeTimeoutMs            = CONFIG.fadeTimeout;
+    hiddenInputState.enabled = CONFIG.hideInput;
+    rounding                 = CONFIG.rounding;
+    configPlaceholderText    = CONFIG.placeholderText;
+    configFailText           = CONFIG.failText;
+    configCheckText          = CONFIG.checkText;
+    fontFamily               = CONFIG.fontFamily;
+    colorConfig.outer        = CONFIG.outerColor;
+    colorConfig.inner        = CONFIG.innerColor;
+    colorConfig.font         = CONFIG.fontColor;
+    colorConfig.fail         = CONFIG.failColor;
+    colorConfig.check        = CONFIG.checkColor;
+    colorConfig.both         = CONFIG.bothlockColor;
+    colorConfig.caps         = CONFIG.capslockColor;
+    colorConfig.num          = CONFIG.numlockColor;
+    colorConfig.invertNum    = CONFIG.invertNumlock;
+    colorConfig.swapFont     = CONFIG.swapFontColor;
+    colorConfig.hiddenBase   = CONFIG.hideInputBaseColor;
 
     configPos       = pos;
     colorState.font = colorConfig.font;
@@ -76,13 +73,14 @@ void CPasswordInputField::configure(const std::unordered_map<std::string, std::a
     dots.size    = std::clamp(dots.size, 0.001f, 0.8f);
     dots.spacing = std::clamp(dots.spacing, -1.f, 1.f);
 
-    colorConfig.caps = colorConfig.caps->m_bIsFallback ? colorConfig.fail : colorConfig.caps;
+    if (colorConfig.caps.m_bIsFallback)
+        colorConfig.caps = colorConfig.fail;
 
     g_pAnimationManager->createAnimation(0.f, fade.a, g_pConfigManager->m_AnimationTree.getConfig("inputFieldFade"));
     g_pAnimationManager->createAnimation(0.f, dots.currentAmount, g_pConfigManager->m_AnimationTree.getConfig("inputFieldDots"));
     g_pAnimationManager->createAnimation(configSize, size, g_pConfigManager->m_AnimationTree.getConfig("inputFieldWidth"));
     g_pAnimationManager->createAnimation(colorConfig.inner, colorState.inner, g_pConfigManager->m_AnimationTree.getConfig("inputFieldColors"));
-    g_pAnimationManager->createAnimation(*colorConfig.outer, colorState.outer, g_pConfigManager->m_AnimationTree.getConfig("inputFieldColors"));
+    g_pAnimationManager->createAnimation(colorConfig.outer, colorState.outer, g_pConfigManager->m_AnimationTree.getConfig("inputFieldColors"));
 
     srand(std::chrono::system_clock::now().time_since_epoch().count());
 
@@ -90,11 +88,11 @@ void CPasswordInputField::configure(const std::unordered_map<std::string, std::a
 
     if (!dots.textFormat.empty()) {
         Hyprgraphics::CTextResource::STextResourceData request;
-        request.text        = dots.textFormat;
-        request.font        = fontFamily;
-        request.color       = colorConfig.font.asRGB();
-        request.fontSize    = (int)(std::nearbyint(configSize.y * dots.size * 0.5f) * 2.f);
-        dots.textResourceID = g_asyncResourceManager->requestText(request, nullptr);
+        request.text     = dots.textFormat;
+        request.font     = fontFamily;
+        request.color    = colorConfig.font.asRGB();
+        request.fontSize = (int)(std::nearbyint(configSize.y * dots.size * 0.5f) * 2.f);
+        dots.textHandle  = g_asyncResourceManager->requestText(request, nullptr);
     }
 
     // request the inital placeholder asset
@@ -110,12 +108,12 @@ void CPasswordInputField::reset() {
     if (g_pHyprlock->isTerminating())
         return;
 
-    if (placeholder.asset)
-        g_asyncResourceManager->unload(placeholder.asset);
-
-    placeholder.asset      = nullptr;
-    placeholder.resourceID = 0;
+    placeholder.handle.reset();
+    placeholder.asset = nullptr;
     placeholder.currentText.clear();
+
+    dots.textHandle.reset();
+    dots.textAsset = nullptr;
 }
 
 static void fadeOutCallback(AWP<CPasswordInputField> ref) {
@@ -241,7 +239,7 @@ bool CPasswordInputField::draw(const SRenderData& data) {
 
         if (!dots.textFormat.empty()) {
             if (!dots.textAsset)
-                dots.textAsset = g_asyncResourceManager->getAssetByID(dots.textResourceID);
+                dots.textAsset = g_asyncResourceManager->getAssetByID(dots.textHandle.id());
 
             if (!dots.textAsset)
                 forceReload = true;
@@ -300,13 +298,13 @@ bool CPasswordInputField::draw(const SRenderData& data) {
         }
     }
 
-    bool placeholderPasswordCondition = (passwordLength == 0 && placeholder.resourceID > 0);
+    bool placeholderPasswordCondition = (passwordLength == 0 && placeholder.handle);
 
     if (placeholderPasswordCondition && (!checkWaiting || (checkWaiting && !configCheckText.empty()))) {
         ASP<CTexture> currAsset = nullptr;
 
         if (!placeholder.asset)
-            placeholder.asset = g_asyncResourceManager->getAssetByID(placeholder.resourceID);
+            placeholder.asset = g_asyncResourceManager->getAssetByID(placeholder.handle.id());
 
         currAsset = placeholder.asset;
 
@@ -331,10 +329,9 @@ void CPasswordInputField::updatePlaceholder() {
 
     if (passwordLength != 0) {
         if (placeholder.asset && /* keep prompt asset cause it is likely to be used again */ displayFail) {
-            g_asyncResourceManager->unload(placeholder.asset);
-            placeholder.asset      = nullptr;
-            placeholder.resourceID = 0;
-            redrawShadow           = true;
+            placeholder.handle.reset();
+            placeholder.asset = nullptr;
+            redrawShadow      = true;
         }
         return;
     }
@@ -370,7 +367,7 @@ void CPasswordInputField::updatePlaceholder() {
     request.fontSize = (int)size->value().y / 4;
 
     AWP<IWidget> widget(m_self);
-    placeholder.resourceID = g_asyncResourceManager->requestText(request, widget);
+    placeholder.handle = g_asyncResourceManager->requestText(request, widget);
 }
 
 void CPasswordInputField::onAssetUpdate(ResourceID id, ASP<CTexture> newAsset) {
@@ -426,31 +423,31 @@ void CPasswordInputField::updateHiddenInputState() {
 }
 
 void CPasswordInputField::updateColors() {
-    const bool          BORDERLESS = outThick == 0;
-    const bool          NUMLOCK    = (colorConfig.invertNum) ? !g_pHyprlock->m_bNumLock : g_pHyprlock->m_bNumLock;
+    const bool                BORDERLESS = outThick == 0;
+    const bool                NUMLOCK    = (colorConfig.invertNum) ? !g_pHyprlock->m_bNumLock : g_pHyprlock->m_bNumLock;
 
-    CGradientValueData* targetGrad = nullptr;
+    const CGradientValueData* targetGrad = nullptr;
 
-    if (g_pHyprlock->m_bCapsLock && NUMLOCK && !colorConfig.both->m_bIsFallback)
-        targetGrad = colorConfig.both;
+    if (g_pHyprlock->m_bCapsLock && NUMLOCK && !colorConfig.both.m_bIsFallback)
+        targetGrad = &colorConfig.both;
     else if (g_pHyprlock->m_bCapsLock)
-        targetGrad = colorConfig.caps;
-    else if (NUMLOCK && !colorConfig.num->m_bIsFallback)
-        targetGrad = colorConfig.num;
+        targetGrad = &colorConfig.caps;
+    else if (NUMLOCK && !colorConfig.num.m_bIsFallback)
+        targetGrad = &colorConfig.num;
 
     if (checkWaiting)
-        targetGrad = colorConfig.check;
+        targetGrad = &colorConfig.check;
     else if (displayFail && passwordLength == 0)
-        targetGrad = colorConfig.fail;
+        targetGrad = &colorConfig.fail;
 
-    CGradientValueData* outerTarget = colorConfig.outer;
-    CHyprColor          innerTarget = colorConfig.inner;
-    CHyprColor          fontTarget  = colorConfig.font;
+    const CGradientValueData* outerTarget = &colorConfig.outer;
+    CHyprColor                innerTarget = colorConfig.inner;
+    CHyprColor                fontTarget  = colorConfig.font;
 
     if (displayFail)
-        fontTarget = colorConfig.fail->m_vColors.front();
+        fontTarget = colorConfig.fail.m_vColors.front();
     else if (checkWaiting)
-        fontTarget = configCheckText.empty() ? colorConfig.font : colorConfig.check->m_vColors.front();
+        fontTarget = configCheckText.empty() ? colorConfig.font : colorConfig.check.m_vColors.front();
 
     if (targetGrad) {
         if (BORDERLESS && colorConfig.swapFont) {
@@ -5,13 +5,12 @@
 #include "../../helpers/Color.hpp"
 #include "../../helpers/Math.hpp"
 #include "../../core/Timer.hpp"
+#include "../ResourceHandle.hpp"
 #include "Shadowable.hpp"
 #include "../../config/ConfigDataValues.hpp"
 #include "../../helpers/AnimatedVariable.hpp"
 #include <hyprutils/math/Vector2D.hpp>
 #include <vector>
-#include <any>
-#include <unordered_map>
 
 struct SPreloadedAsset;
 
@@ -22,7 +21,7 @@ class CPasswordInputField : public IWidget {
 
     void         registerSelf(const ASP<CPasswordInputField>& self);
 
-    virtual void configure(const std::unordered_map<std::string, std::any>& prop, const SP<COutput>& pOutput);
+    virtual void configure(const SWidgetConfig& config, const SP<COutput>& pOutput);
     virtual bool draw(const SRenderData& data);
     virtual void onAssetUpdate(ResourceID id, ASP<CTexture> newAsset);
 
@@ -56,20 +55,22 @@ class CPasswordInputField : public IWidget {
     Vector2D                 configPos;
     Vector2D                 configSize;
 
-    std::string              halign, valign, configFailText, configCheckText, outputStringPort, configPlaceholderText, fontFamily;
+    eHAlign                  halign = HALIGN_CENTER;
+    eVAlign                  valign = VALIGN_CENTER;
+    std::string              configFailText, configCheckText, outputStringPort, configPlaceholderText, fontFamily;
     uint64_t                 configFailTimeoutMs = 2000;
 
     int                      outThick, rounding;
 
     struct {
         PHLANIMVAR<float> currentAmount;
-        bool              center         = false;
-        float             size           = 0;
-        float             spacing        = 0;
-        int               rounding       = 0;
-        size_t            textResourceID = 0;
-        std::string       textFormat     = "";
-        ASP<CTexture>     textAsset      = nullptr;
+        bool              center   = false;
+        float             size     = 0;
+        float             spacing  = 0;
+        int               rounding = 0;
+        CResourceHandle   textHandle;
+        std::string       textFormat = "";
+        ASP<CTexture>     textAsset  = nullptr;
     } dots;
 
     struct {
@@ -80,10 +81,10 @@ class CPasswordInputField : public IWidget {
     } fade;
 
     struct {
-        size_t        resourceID = 0;
-        ASP<CTexture> asset      = nullptr;
+        CResourceHandle handle;
+        ASP<CTexture>   asset = nullptr;
 
-        std::string   currentText    = "";
+        std::string     currentText    = "";
         size_t        failedAttempts = 0;
     } placeholder;
 
@@ -95,20 +96,20 @@ class CPasswordInputField : public IWidget {
     } hiddenInputState;
 
     struct {
-        CGradientValueData* outer = nullptr;
-        CHyprColor          inner;
-        CHyprColor          font;
-        CGradientValueData* fail  = nullptr;
-        CGradientValueData* check = nullptr;
-        CGradientValueData* caps  = nullptr;
-        CGradientValueData* num   = nullptr;
-        CGradientValueData* both  = nullptr;
-
-        CHyprColor          hiddenBase;
-
-        int                 transitionMs = 0;
-        bool                invertNum    = false;
-        bool                swapFont     = false;
+        CGradientValueData outer;
+        CHyprColor         inner;
+        CHyprColor         font;
+        CGradientValueData fail;
+        CGradientValueData check;
+        CGradientValueData caps;
+        CGradientValueData num;
+        CGradientValueData both;
+
+        CHyprColor         hiddenBase;
+
+        int                transitionMs = 0;
+        bool               invertNum    = false;
+        bool               swapFont     = false;
     } colorConfig;
 
     struct {
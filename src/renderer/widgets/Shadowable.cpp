@@ -1,15 +1,18 @@
 #include "Shadowable.hpp"
 #include "../Renderer.hpp"
-#include <hyprlang.hpp>
 
-void CShadowable::configure(AWP<IWidget> widget_, const std::unordered_map<std::string, std::any>& props, const Vector2D& viewport_) {
+void CShadowable::configure(AWP<IWidget> widget_, const SShadowConfig& config, const Vector2D& viewport_) {
+    // Configured again for another output size.
+    if (viewport_ != viewport)
+        shadowFB.destroyBuffer();
+
     m_widget = widget_;
     viewport = viewport_;
 
-    size   = std::any_cast<Hyprlang::INT>(props.at("shadow_size"));
-    passes = std::any_cast<Hyprlang::INT>(props.at("shadow_passes"));
-    color  = std::any_cast<Hyprlang::INT>(props.at("shadow_color"));
-    boostA = std::any_cast<Hyprlang::FLOAT>(props.at("shadow_boost"));
+    size   = config.size;
+    passes = config.passes;
+    color  = config.color;
+    boostA = config.boost;
 }
 
 void CShadowable::markShadowDirty() {
@@ -5,15 +5,11 @@
 #include "../../helpers/Math.hpp"
 #include "IWidget.hpp"
 
-#include <string>
-#include <unordered_map>
-#include <any>
-
 class CShadowable {
   public:
     virtual ~CShadowable() = default;
     CShadowable()          = default;
-    void configure(AWP<IWidget> widget_, const std::unordered_map<std::string, std::any>& props, const Vector2D& viewport_ /* TODO: make this not the entire viewport */);
+    void configure(AWP<IWidget> widget_, const SShadowConfig& config, const Vector2D& viewport_ /* TODO: make this not the entire viewport */);
 
     // instantly re-renders the shadow using the widget's draw() method
     void         markShadowDirty();
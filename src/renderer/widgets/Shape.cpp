@@ -11,28 +11,25 @@ void CShape::registerSelf(const ASP<CShape>& self) {
     m_self = self;
 }
 
-void CShape::configure(const std::unordered_map<std::string, std::any>& props, const SP<COutput>& pOutput) {
-    viewport = pOutput->getViewport();
-
-    shadow.configure(m_self, props, viewport);
-
-    try {
-        size           = CLayoutValueData::fromAnyPv(props.at("size"))->getAbsolute(viewport);
-        rounding       = std::any_cast<Hyprlang::INT>(props.at("rounding"));
-        border         = std::any_cast<Hyprlang::INT>(props.at("border_size"));
-        color          = std::any_cast<Hyprlang::INT>(props.at("color"));
-        borderGrad     = *CGradientValueData::fromAnyPv(props.at("border_color"));
-        pos            = CLayoutValueData::fromAnyPv(props.at("position"))->getAbsolute(viewport);
-        halign         = std::any_cast<Hyprlang::STRING>(props.at("halign"));
-        valign         = std::any_cast<Hyprlang::STRING>(props.at("valign"));
-        angle          = std::any_cast<Hyprlang::FLOAT>(props.at("rotate"));
-        xray           = std::any_cast<Hyprlang::INT>(props.at("xray"));
-        onclickCommand = std::any_cast<Hyprlang::STRING>(props.at("onclick"));
-    } catch (const std::bad_any_cast& e) {
-        RASSERT(false, "Failed to construct CShape: {}", e.what()); //
-    } catch (const std::out_of_range& e) {
-        RASSERT(false, "Missing property for CShape: {}", e.what()); //
-    }
+void CShape::configure(const SWidgetConfig& config, const SP<COutput>& pOutput) {
+    viewport    = pOutput->getViewport();
+    firstRender = true;
+
+    const auto& CONFIG = std::get<SShapeConfig>(config.values);
+
+    shadow.configure(m_self, CONFIG.shadow, viewport);
+
+    size           = CONFIG.size.getAbsolute(viewport);
+    rounding       = CONFIG.rounding;
+    border         = CONFIG.border;
+    color          = CONFIG.color;
+    borderGrad     = CONFIG.borderColor;
+    pos            = CONFIG.position.getAbsolute(viewport);
+    halign         = CONFIG.halign;
+    valign         = CONFIG.valign;
+    angle          = CONFIG.rotate;
+    xray           = CONFIG.xray;
+    onclickCommand = CONFIG.onclick;
 
     angle = angle * M_PI / 180.0;
 
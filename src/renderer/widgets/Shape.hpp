@@ -6,8 +6,6 @@
 #include "Shadowable.hpp"
 #include <hyprutils/math/Box.hpp>
 #include <string>
-#include <unordered_map>
-#include <any>
 
 class CShape : public IWidget {
   public:
@@ -16,7 +14,7 @@ class CShape : public IWidget {
 
     void         registerSelf(const ASP<CShape>& self);
 
-    virtual void configure(const std::unordered_map<std::string, std::any>& prop, const SP<COutput>& pOutput);
+    virtual void configure(const SWidgetConfig& config, const SP<COutput>& pOutput);
     virtual bool draw(const SRenderData& data);
     virtual void onAssetUpdate(ResourceID id, ASP<CTexture> newAsset);
 
@@ -40,7 +38,8 @@ class CShape : public IWidget {
     CBox               borderBox;
     bool               xray;
 
-    std::string        halign, valign;
+    eHAlign            halign = HALIGN_CENTER;
+    eVAlign            valign = VALIGN_CENTER;
 
     bool               firstRender = true;
     std::string        onclickCommand;
@@ -0,0 +1,58 @@
+// Times formatting label texts compiled once into a CFormatTemplate against IWidget::formatString,
+// which compiles the text again on every call, like labels did on every update before.
+// Only texts that need no session are timed, $ATTEMPTS, $LAYOUT and $FAIL read the auth and seat state.
+// Usage: formattemplate_bench [iterations]
+
+#include "../src/renderer/widgets/FormatTemplate.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <print>
+#include <string>
+#include <vector>
+
+static const int CALLS = 10000;
+
+// Keeps the compiler from dropping the formatted text.
+static volatile size_t sink = 0;
+
+// Median of the runs in µs per call.
+static float bench(int iterations, const std::function<void()>& fn) {
+    std::vector<float> times;
+    for (int i = 0; i < iterations; ++i) {
+        const auto START = std::chrono::steady_clock::now();
+        for (int c = 0; c < CALLS; ++c) {
+            fn();
+        }
+        times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - START).count() / 1000.F / CALLS);
+    }
+
+    std::ranges::sort(times);
+    return times[times.size() / 2];
+}
+
+int main(int argc, char** argv) {
+    const int                      ITERATIONS = argc > 1 ? std::max(1, std::stoi(argv[1])) : 20;
+
+    const std::vector<std::string> TEXTS = {
+        "$TIME",
+        "<span font_weight=\"bold\">$TIME12</span>",
+        "Hi there, $USER",
+        "$DATE{%A, %d %B %Y}<br/>$HOSTNAME",
+        "cmd[update:1000] echo \"<b>$(date +%H:%M:%S)</b>\"",
+    };
+
+    std::println("{} calls per run, median of {} runs", CALLS, ITERATIONS);
+
+    for (const auto& text : TEXTS) {
+        CFormatTemplate formatTemplate{text};
+
+        const float     COMPILED = bench(ITERATIONS, [&]() { sink = formatTemplate.format().formatted.size(); });
+        const float     STRING   = bench(ITERATIONS, [&]() { sink = IWidget::formatString(text).formatted.size(); });
+
+        std::println("format {:7.3f}µs  formatString {:7.3f}µs  {:5.1f}x  {}", COMPILED, STRING, STRING / COMPILED, text);
+    }
+
+    return 0;
+}
@@ -0,0 +1,218 @@
+// Compares every pixel conversion kernel the cpu supports with the plain per pixel loops
+// hyprlock used before they were vectorized.
+// Source rows end right before an inaccessible page, so a kernel that reads past a row crashes.
+
+#include "../src/helpers/PixelConvert.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstring>
+#include <print>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char* impl, const char* what, size_t width, size_t height, size_t stride) {
+    if (ok)
+        return;
+
+    failures++;
+    std::println(stderr, "FAIL [{}] {} width {} height {} stride {}", impl, what, width, height, stride);
+}
+
+// A buffer of size bytes that ends right before a PROT_NONE page.
+class CGuardedBuffer {
+  public:
+    CGuardedBuffer(size_t size) : m_size(size) {
+        const size_t PAGE = sysconf(_SC_PAGESIZE);
+        m_mapped          = ((size + PAGE - 1) / PAGE + 1) * PAGE;
+        m_base            = (uint8_t*)mmap(nullptr, m_mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        mprotect(m_base + m_mapped - PAGE, PAGE, PROT_NONE);
+    }
+
+    ~CGuardedBuffer() {
+        munmap(m_base, m_mapped);
+    }
+
+    uint8_t* data() {
+        return m_base + m_mapped - sysconf(_SC_PAGESIZE) - m_size;
+    }
+
+  private:
+    uint8_t* m_base   = nullptr;
+    size_t   m_mapped = 0;
+    size_t   m_size   = 0;
+};
+
+static void swapRBReference(uint8_t* data, size_t pixels) {
+    for (size_t i = 0; i < pixels; ++i) {
+        std::swap(data[i * 4], data[i * 4 + 2]);
+    }
+}
+
+static void pack2101010Reference(uint8_t* data, size_t pixels, bool flip) {
+    for (size_t i = 0; i < pixels; ++i) {
+        uint32_t* px = (uint32_t*)(data + i * 4);
+
+        uint8_t   R = (uint8_t)std::round((255.0 * (((*px) & 0x3FF) >> 0) / 1023.0));
+        uint8_t   G = (uint8_t)std::round((255.0 * (((*px) & 0xFFC00) >> 10) / 1023.0));
+        uint8_t   B = (uint8_t)std::round((255.0 * (((*px) & 0x3FF00000) >> 20) / 1023.0));
+        uint8_t   A = (uint8_t)std::round((255.0 * (((*px) & 0xC0000000) >> 30) / 3.0));
+
+        *px = ((flip ? B : R) << 0) + (G << 8) + ((flip ? R : B) << 16) + (A << 24);
+    }
+}
+
+static void expand24Reference(const uint8_t* src, size_t srcStride, uint8_t* dst, uint32_t width, uint32_t height) {
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            const uint8_t* srcPx = src + y * srcStride + x * 3;
+            uint8_t*       dstPx = dst + (y * width + x) * 4;
+            dstPx[0]             = srcPx[0];
+            dstPx[1]             = srcPx[1];
+            dstPx[2]             = srcPx[2];
+            dstPx[3]             = 0xFF;
+        }
+    }
+}
+
+static std::vector<uint8_t> randomBytes(size_t size, std::mt19937& rng) {
+    std::vector<uint8_t> bytes(size);
+    for (auto& b : bytes) {
+        b = rng();
+    }
+    return bytes;
+}
+
+// Odd sizes around every vector width and loop bound, plus sizes large enough to be split across threads.
+static std::vector<size_t> testSizes() {
+    std::vector<size_t> sizes;
+    for (size_t i = 0; i <= 70; ++i) {
+        sizes.push_back(i);
+    }
+    for (size_t i : {127, 128, 129, 1023, 1920, 3839}) {
+        sizes.push_back(i);
+    }
+    return sizes;
+}
+
+static void testSwapRB(const char* impl, std::mt19937& rng) {
+    std::vector<size_t> sizes = testSizes();
+    sizes.push_back(1920 * 1080 + 13);
+
+    for (size_t pixels : sizes) {
+        CGuardedBuffer buffer(pixels * 4);
+        const auto     INPUT = randomBytes(pixels * 4, rng);
+        auto           want  = INPUT;
+
+        std::memcpy(buffer.data(), INPUT.data(), INPUT.size());
+        swapRBReference(want.data(), pixels);
+        PixelConvert::swapRB(buffer.data(), pixels);
+
+        check(std::memcmp(buffer.data(), want.data(), want.size()) == 0, impl, "swapRB", pixels, 1, pixels * 4);
+    }
+}
+
+static void testPack2101010(const char* impl, std::mt19937& rng) {
+    // Every 10 bit value in every channel, with every alpha, at every offset into a vector.
+    std::vector<uint32_t> all;
+    for (uint32_t v = 0; v < 1024; ++v) {
+        for (uint32_t a = 0; a < 4; ++a) {
+            all.push_back(v | ((1023 - v) << 10) | (((v * 7) & 0x3FF) << 20) | (a << 30));
+            all.push_back(((v * 5) & 0x3FF) | (v << 10) | ((1023 - v) << 20) | (a << 30));
+            all.push_back((1023 - v) | (((v * 3) & 0x3FF) << 10) | (v << 20) | (a << 30));
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> inputs;
+    for (size_t offset = 0; offset < 16; ++offset) {
+        inputs.emplace_back(all.begin() + offset, all.end());
+    }
+    for (size_t pixels : testSizes()) {
+        const auto BYTES = randomBytes(pixels * 4, rng);
+        inputs.emplace_back(pixels);
+        std::memcpy(inputs.back().data(), BYTES.data(), BYTES.size());
+    }
+    inputs.emplace_back(1920 * 1080 + 13);
+    for (auto& px : inputs.back()) {
+        px = rng();
+    }
+
+    for (const auto& input : inputs) {
+        for (bool flip : {false, true}) {
+            const size_t         BYTES = input.size() * 4;
+            CGuardedBuffer       buffer(BYTES);
+            std::vector<uint8_t> want(BYTES);
+
+            std::memcpy(buffer.data(), input.data(), BYTES);
+            std::memcpy(want.data(), input.data(), BYTES);
+            pack2101010Reference(want.data(), input.size(), flip);
+            PixelConvert::pack2101010(buffer.data(), input.size(), flip);
+
+            check(std::memcmp(buffer.data(), want.data(), BYTES) == 0, impl, flip ? "pack2101010 flipped" : "pack2101010", input.size(), 1, BYTES);
+        }
+    }
+}
+
+static void testExpand24(const char* impl, std::mt19937& rng) {
+    struct SCase {
+        uint32_t width, height;
+    };
+
+    std::vector<SCase> cases;
+    for (size_t width : testSizes()) {
+        if (width > 0)
+            cases.push_back({(uint32_t)width, 3});
+    }
+    cases.push_back({1920, 1080});
+    cases.push_back({1921, 1081});
+
+    for (const auto& [width, height] : cases) {
+        for (size_t padding : {0, 1, 2, 5, 16}) {
+            const size_t STRIDE = width * 3 + padding;
+            // The last row ends at the guard page, its padding is not there.
+            const size_t         SRCBYTES = STRIDE * (height - 1) + width * 3;
+            const size_t         DSTBYTES = (size_t)width * height * 4;
+
+            CGuardedBuffer       src(SRCBYTES);
+            CGuardedBuffer       dst(DSTBYTES);
+            const auto           INPUT = randomBytes(SRCBYTES, rng);
+            std::vector<uint8_t> want(DSTBYTES);
+
+            std::memcpy(src.data(), INPUT.data(), SRCBYTES);
+            expand24Reference(INPUT.data(), STRIDE, want.data(), width, height);
+            PixelConvert::expand24(src.data(), STRIDE, dst.data(), width, height);
+
+            check(std::memcmp(dst.data(), want.data(), DSTBYTES) == 0, impl, "expand24", width, height, STRIDE);
+        }
+    }
+}
+
+int main() {
+    std::mt19937 rng(1234);
+    int          tested = 0;
+
+    for (const char* impl : {"scalar", "sse4.1", "avx2", "neon"}) {
+        if (!PixelConvert::setImpl(impl)) {
+            std::println("[{}] not supported, skipped", impl);
+            continue;
+        }
+
+        testSwapRB(impl, rng);
+        testPack2101010(impl, rng);
+        testExpand24(impl, rng);
+
+        tested++;
+        std::println("[{}] tested", impl);
+    }
+
+    if (failures > 0) {
+        std::println(stderr, "{} checks failed", failures);
+        return 1;
+    }
+
+    return tested > 0 ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+// Times every pixel conversion kernel the cpu supports on a 4K frame.
+// Usage: pixelconvert_bench [iterations]
+
+#include "../src/helpers/PixelConvert.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+static const uint32_t WIDTH  = 3840;
+static const uint32_t HEIGHT = 2160;
+
+// Median of the runs in ms. The input is restored before every run.
+static float bench(int iterations, std::vector<uint8_t>& data, const std::vector<uint8_t>& input, const std::function<void()>& fn) {
+    std::vector<float> times;
+    for (int i = 0; i < iterations; ++i) {
+        std::copy(input.begin(), input.end(), data.begin());
+
+        const auto START = std::chrono::steady_clock::now();
+        fn();
+        times.push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - START).count() / 1000.F);
+    }
+
+    std::ranges::sort(times);
+    return times[times.size() / 2];
+}
+
+int main(int argc, char** argv) {
+    const int            ITERATIONS = argc > 1 ? std::max(1, std::stoi(argv[1])) : 20;
+    const size_t         PIXELS     = (size_t)WIDTH * HEIGHT;
+
+    std::mt19937         rng(1234);
+    std::vector<uint8_t> input(PIXELS * 4);
+    for (auto& b : input) {
+        b = rng();
+    }
+
+    std::vector<uint8_t> data(input.size());
+    std::vector<uint8_t> dst(input.size());
+
+    std::println("{}x{}, median of {} runs", WIDTH, HEIGHT, ITERATIONS);
+
+    for (const char* impl : {"scalar", "sse4.1", "avx2", "neon"}) {
+        if (!PixelConvert::setImpl(impl))
+            continue;
+
+        const float SWAP   = bench(ITERATIONS, data, input, [&]() { PixelConvert::swapRB(data.data(), PIXELS); });
+        const float PACK   = bench(ITERATIONS, data, input, [&]() { PixelConvert::pack2101010(data.data(), PIXELS, true); });
+        const float EXPAND = bench(ITERATIONS, data, input, [&]() { PixelConvert::expand24(data.data(), (size_t)WIDTH * 3, dst.data(), WIDTH, HEIGHT); });
+
+        std::println("[{:>6}] swapRB {:7.2f}ms  pack2101010 {:7.2f}ms  expand24 {:7.2f}ms", impl, SWAP, PACK, EXPAND);
+    }
+
+    return 0;
+}